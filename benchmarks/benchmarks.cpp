@@ -0,0 +1,111 @@
+/**
+ * Measures the time taken to build the schedule and the routing indexes for a GTFS feed, and the latency and
+ * throughput of journey searches between random stops.
+ *
+ * Usage: pt_benchmarks <feed directory> <date> [number of queries] [seed]
+ * The date is given in the YYYY-MM-DD format. Queries depart on that date, and the same seed always gives the same
+ * queries for a feed.
+ */
+#include <iomanip>
+#include <iostream>
+
+#include "command_line.h"
+#include "queries.h"
+#include "raptor/raptor.h"
+#include "schedule/gtfs.h"
+#include "transfers/kd_tree.h"
+#include "transfers/linear_walk_calculator.h"
+
+using namespace raptor;
+
+/**
+ * Runs the given function and prints the time it took.
+ * @return Value returned by the function.
+ */
+template <typename F>
+auto measure(const std::string& name, F&& function) {
+    const auto start = std::chrono::steady_clock::now();
+    auto result = function();
+    const auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+    std::cout << std::left << std::setw(20) << name << std::right << std::fixed << std::setprecision(1)
+            << std::setw(12) << elapsed.count() << " ms\n";
+    return result;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3 || argc > 5) {
+        std::cerr << "Usage: " << argv[0] << " <feed directory> <date> [number of queries] [seed]\n";
+        return 1;
+    }
+    try {
+        const auto date = parse_date(argv[2]);
+        const auto n_queries = argc > 3 ? std::stoul(argv[3]) : 1000UL;
+        const auto seed = argc > 4 ? std::stoull(argv[4]) : 1ULL;
+
+        // Journeys departing late in the evening can arrive on the following day
+        const auto last_date = std::chrono::year_month_day{std::chrono::sys_days{date} + std::chrono::days{1}};
+        const auto schedule = measure("schedule build", [&] {
+            return raptor::gtfs::from_gtfs(std::vector<raptor::gtfs::FeedSource>{{argv[1], ""}}, date, last_date);
+        });
+        measure("KD tree build", [&] {
+            const auto kd_tree = StopKDTree(schedule.get_stops());
+            return kd_tree.kdtree_get_point_count();
+        });
+        auto transfer_manager = measure("transfer build", [&] {
+            return TransferManager(schedule, StopKDTree::create_factory(),
+                                   std::make_unique<LinearWalkTimeCalculator>(5.0));
+        });
+        auto router = measure("router build", [&] {
+            return Raptor(schedule, std::move(transfer_manager));
+        });
+
+        const auto queries = benchmark::generate_queries(schedule, date, n_queries, seed);
+        const auto run = [&](const benchmark::Query& query, QueryStats* stats = nullptr) {
+            return router.route(query.origin, query.destination, query.departure_time, stats);
+        };
+        // Warm up the caches and the allocator with a part of the queries
+        for (std::size_t i = 0; i < std::min<std::size_t>(queries.size(), 100); ++i) {
+            run(queries[i]);
+        }
+
+        auto latencies = std::vector<std::chrono::nanoseconds>{};
+        latencies.reserve(queries.size());
+        auto n_journeys = std::size_t{0};
+        // Statistics are only collected when the library is built with them
+        auto stats = QueryStats{};
+        auto total_work = RoundStats{};
+        auto n_rounds = std::size_t{0};
+        const auto start = std::chrono::steady_clock::now();
+        for (const auto& query : queries) {
+            const auto query_start = std::chrono::steady_clock::now();
+            const auto journey = run(query, QueryStats::enabled ? &stats : nullptr);
+            latencies.push_back(std::chrono::steady_clock::now() - query_start);
+            n_journeys += !journey.empty();
+            total_work += stats.total();
+            n_rounds += stats.rounds_executed();
+        }
+        const auto total = std::chrono::steady_clock::now() - start;
+
+        const auto summary = benchmark::summarize(latencies, total);
+        std::cout << queries.size() << " queries, " << n_journeys << " journeys found\n"
+                << std::setprecision(1)
+                << "p50 " << summary.p50.count() << " us, p95 " << summary.p95.count() << " us, p99 "
+                << summary.p99.count() << " us, max " << summary.max.count() << " us\n"
+                << summary.queries_per_second << " queries per second\n";
+        if (QueryStats::enabled && !queries.empty()) {
+            const auto per_query = [&queries](const std::size_t total) {
+                return static_cast<double>(total) / static_cast<double>(queries.size());
+            };
+            std::cout << "Per query: " << per_query(n_rounds) << " rounds, "
+                    << per_query(total_work.routes_scanned) << " routes scanned, "
+                    << per_query(total_work.stop_events_visited) << " stop events, "
+                    << per_query(total_work.trips_searched) << " trip searches, "
+                    << per_query(total_work.labels_improved) << " labels improved, "
+                    << per_query(total_work.transfers_relaxed) << " transfers relaxed\n";
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+    return 0;
+}
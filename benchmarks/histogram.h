@@ -0,0 +1,95 @@
+#ifndef PT_ROUTING_BENCHMARK_HISTOGRAM_H
+#define PT_ROUTING_BENCHMARK_HISTOGRAM_H
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace raptor::benchmark {
+    /**
+     * Histogram of latencies with a fixed relative precision, in the style of HdrHistogram.
+     *
+     * Values are stored exactly up to 127ns. Larger values are grouped into buckets whose width is at most 1/64 of
+     * their value, so any latency can be recorded in constant time and memory, and histograms of different threads
+     * can be merged.
+     */
+    class LatencyHistogram {
+        static constexpr auto precision_bits = 7;
+        static constexpr auto sub_buckets = std::uint64_t{1} << precision_bits;
+        static constexpr auto half_sub_buckets = sub_buckets / 2;
+
+        std::vector<std::uint64_t> counts =
+                std::vector<std::uint64_t>(sub_buckets + (64 - precision_bits) * half_sub_buckets);
+        std::uint64_t n_values = 0;
+        std::uint64_t max_value = 0;
+
+        static std::size_t bucket(const std::uint64_t value) noexcept {
+            if (value < sub_buckets) {
+                return value;
+            }
+            const auto shift = static_cast<std::uint64_t>(std::bit_width(value)) - precision_bits;
+            return sub_buckets + (shift - 1) * half_sub_buckets + ((value >> shift) - half_sub_buckets);
+        }
+
+        /**
+         * Largest value stored in the given bucket.
+         */
+        static std::uint64_t highest_value(const std::size_t bucket) noexcept {
+            if (bucket < sub_buckets) {
+                return bucket;
+            }
+            const auto shift = (bucket - sub_buckets) / half_sub_buckets + 1;
+            const auto mantissa = (bucket - sub_buckets) % half_sub_buckets + half_sub_buckets;
+            return ((mantissa + 1) << shift) - 1;
+        }
+
+    public:
+        void record(const std::chrono::nanoseconds latency) noexcept {
+            const auto value = static_cast<std::uint64_t>(std::max<std::chrono::nanoseconds::rep>(0, latency.count()));
+            ++counts[bucket(value)];
+            ++n_values;
+            max_value = std::max(max_value, value);
+        }
+
+        void merge(const LatencyHistogram& other) noexcept {
+            for (std::size_t i = 0; i < counts.size(); ++i) {
+                counts[i] += other.counts[i];
+            }
+            n_values += other.n_values;
+            max_value = std::max(max_value, other.max_value);
+        }
+
+        [[nodiscard]] std::uint64_t count() const noexcept {
+            return n_values;
+        }
+
+        [[nodiscard]] std::chrono::nanoseconds max() const noexcept {
+            return std::chrono::nanoseconds{max_value};
+        }
+
+        /**
+         * @param p Fraction of the values, between 0 and 1.
+         * @return Latency which at least the given fraction of the values do not exceed, within the precision of the
+         * histogram.
+         */
+        [[nodiscard]] std::chrono::nanoseconds percentile(const double p) const noexcept {
+            if (n_values == 0) {
+                return std::chrono::nanoseconds::zero();
+            }
+            const auto rank = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(
+                                                              std::ceil(p * static_cast<double>(n_values))));
+            auto seen = std::uint64_t{0};
+            for (std::size_t i = 0; i < counts.size(); ++i) {
+                seen += counts[i];
+                if (seen >= rank) {
+                    return std::chrono::nanoseconds{std::min(highest_value(i), max_value)};
+                }
+            }
+            return max();
+        }
+    };
+}
+
+#endif //PT_ROUTING_BENCHMARK_HISTOGRAM_H
@@ -0,0 +1,53 @@
+/**
+ * Measures the time and memory taken by each phase of the GTFS import, for synthetic networks of increasing size and
+ * for the given feeds.
+ *
+ * Usage: pt_import_benchmark [<feed directory> <from date> <to date> ...]
+ * Dates are given in the YYYY-MM-DD format. Synthetic feeds are generated in memory, so their reports do not include
+ * parsing, while the reports of the given feeds also include reading them from disk.
+ */
+#include <iostream>
+
+#include "command_line.h"
+#include "schedule/gtfs.h"
+#include "schedule/synthetic.h"
+
+using namespace raptor;
+
+/**
+ * Prints the report of an import, preceded by a header with its name.
+ */
+void print_report(const std::string& name, const ImportStats& stats) {
+    std::cout << "== " << name << " ==\n" << stats << '\n';
+}
+
+int main(int argc, char* argv[]) {
+    if ((argc - 1) % 3 != 0) {
+        std::cerr << "Usage: " << argv[0] << " [<feed directory> <from date> <to date> ...]\n";
+        return 1;
+    }
+    try {
+        // Each size has four times as many routes as the previous one, so that growth can be compared with size
+        for (const auto n_routes : {10U, 40U, 160U}) {
+            auto parameters = synthetic::NetworkParameters{.n_routes = n_routes, .stops_per_route = 20,
+                                                           .service_days = 7};
+            const auto feed = synthetic::generate_feed(parameters);
+            const auto last_date = std::chrono::year_month_day{
+                    std::chrono::sys_days{parameters.start_date} + std::chrono::days{parameters.service_days - 1}};
+            auto stats = ImportStats{};
+            raptor::gtfs::from_gtfs(feed, parameters.start_date, last_date, &stats);
+            print_report("synthetic grid, " + std::to_string(n_routes) + " routes", stats);
+        }
+
+        for (auto i = 1; i + 2 < argc; i += 3) {
+            auto stats = ImportStats{};
+            raptor::gtfs::from_gtfs(std::vector<raptor::gtfs::FeedSource>{{argv[i], ""}}, parse_date(argv[i + 1]),
+                                    parse_date(argv[i + 2]), &stats);
+            print_report(argv[i], stats);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+    return 0;
+}
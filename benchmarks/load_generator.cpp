@@ -0,0 +1,201 @@
+/**
+ * Runs journey searches from several threads at once and reports how throughput and latency change with the number
+ * of threads.
+ *
+ * Usage: pt_load_generator <feed directory> <date> [parameter=value ...]
+ * Parameters:
+ *  - queries: File with the queries. If it does not exist, random queries are generated and written to it, so that
+ *    later runs replay the same queries.
+ *  - n_queries, seed: Number of random queries and their seed, used when no query file is read. Default 10000 and 1.
+ *  - threads: Comma-separated thread counts to run, for example 1,2,4,8. Default 1.
+ *  - instances: shared to use one router from all threads, or per_thread to give each thread its own router and
+ *    transfers. Default shared.
+ *  - rate: Target queries per second over all threads. Each query is started at its scheduled time and its latency
+ *    includes any time spent waiting behind earlier queries. If 0, threads run queries back to back. Default 0.
+ */
+#include <atomic>
+#include <deque>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#include "command_line.h"
+#include "histogram.h"
+#include "queries.h"
+#include "raptor/raptor.h"
+#include "schedule/gtfs.h"
+#include "transfers/kd_tree.h"
+#include "transfers/linear_walk_calculator.h"
+
+using namespace raptor;
+
+struct LoadParameters {
+    std::string queries_path;
+    std::size_t n_queries = 10000;
+    std::uint64_t seed = 1;
+    std::vector<std::size_t> thread_counts{1};
+    bool shared_router = true;
+    double rate = 0;
+};
+
+/**
+ * Sets the parameter in an argument of the form parameter=value.
+ * @throw std::invalid_argument If the argument is not a known parameter or has an invalid value.
+ */
+void set_parameter(LoadParameters& parameters, const std::string& argument) {
+    const auto separator = argument.find('=');
+    if (separator == std::string::npos) {
+        throw std::invalid_argument("Expected parameter=value, got " + argument);
+    }
+    const auto name = argument.substr(0, separator);
+    const auto value = argument.substr(separator + 1);
+    if (name == "queries") {
+        parameters.queries_path = value;
+    } else if (name == "n_queries") {
+        parameters.n_queries = std::stoul(value);
+    } else if (name == "seed") {
+        parameters.seed = std::stoull(value);
+    } else if (name == "threads") {
+        parameters.thread_counts.clear();
+        auto stream = std::istringstream(value);
+        for (auto count = std::string{}; std::getline(stream, count, ',');) {
+            parameters.thread_counts.push_back(std::stoul(count));
+            if (parameters.thread_counts.back() == 0) {
+                throw std::invalid_argument("Thread counts must be positive");
+            }
+        }
+        if (parameters.thread_counts.empty()) {
+            throw std::invalid_argument("No thread counts given");
+        }
+    } else if (name == "instances") {
+        if (value != "shared" && value != "per_thread") {
+            throw std::invalid_argument("Unknown instances " + value);
+        }
+        parameters.shared_router = value == "shared";
+    } else if (name == "rate") {
+        parameters.rate = std::stod(value);
+    } else {
+        throw std::invalid_argument("Unknown parameter " + name);
+    }
+}
+
+Raptor create_router(const Schedule& schedule) {
+    return Raptor(schedule, TransferManager(schedule, StopKDTree::create_factory(),
+                                            std::make_unique<LinearWalkTimeCalculator>(5.0)));
+}
+
+/**
+ * Runs all the queries with the given routers, one thread for each router.
+ * @return Latencies of all queries and the wall time taken.
+ */
+std::pair<benchmark::LatencyHistogram, std::chrono::nanoseconds> run(
+        const std::vector<Raptor*>& routers, const std::vector<benchmark::Query>& queries, const double rate) {
+    // Threads take the next query from a shared counter, so that they finish at the same time
+    auto next_query = std::atomic<std::size_t>{0};
+    auto histograms = std::vector<benchmark::LatencyHistogram>(routers.size());
+    const auto interval = rate > 0
+                              ? std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                      std::chrono::duration<double>(1.0 / rate))
+                              : std::chrono::nanoseconds::zero();
+
+    const auto start = std::chrono::steady_clock::now();
+    auto threads = std::vector<std::jthread>{};
+    for (std::size_t t = 0; t < routers.size(); ++t) {
+        threads.emplace_back([&, t] {
+            auto& router = *routers[t];
+            auto& histogram = histograms[t];
+            for (auto i = next_query++; i < queries.size(); i = next_query++) {
+                const auto& query = queries[i];
+                // With a target rate, latency is measured from the time the query should have started
+                auto query_start = std::chrono::steady_clock::now();
+                if (rate > 0) {
+                    query_start = start + static_cast<std::int64_t>(i) * interval;
+                    std::this_thread::sleep_until(query_start);
+                }
+                router.route(query.origin, query.destination, query.departure_time);
+                histogram.record(std::chrono::steady_clock::now() - query_start);
+            }
+        });
+    }
+    threads.clear();
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    auto histogram = benchmark::LatencyHistogram{};
+    for (const auto& thread_histogram : histograms) {
+        histogram.merge(thread_histogram);
+    }
+    return {histogram, elapsed};
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <feed directory> <date> [parameter=value ...]\n";
+        return 1;
+    }
+    try {
+        const auto date = parse_date(argv[2]);
+        auto parameters = LoadParameters{};
+        for (auto i = 3; i < argc; ++i) {
+            set_parameter(parameters, argv[i]);
+        }
+
+        const auto last_date = std::chrono::year_month_day{std::chrono::sys_days{date} + std::chrono::days{1}};
+        const auto schedule = raptor::gtfs::from_gtfs(std::vector<raptor::gtfs::FeedSource>{{argv[1], ""}}, date,
+                                                      last_date);
+        auto queries = std::vector<benchmark::Query>{};
+        if (!parameters.queries_path.empty() && std::filesystem::exists(parameters.queries_path)) {
+            queries = benchmark::read_queries(parameters.queries_path, schedule);
+        } else {
+            queries = benchmark::generate_queries(schedule, date, parameters.n_queries, parameters.seed);
+            if (!parameters.queries_path.empty()) {
+                benchmark::write_queries(parameters.queries_path, schedule, queries);
+            }
+        }
+
+        // Routers are built before any measurement. Per-thread routers each have their own transfers.
+        const auto max_threads = std::ranges::max(parameters.thread_counts);
+        auto routers = std::deque<Raptor>{};
+        for (std::size_t i = 0; i < (parameters.shared_router ? 1 : max_threads); ++i) {
+            routers.push_back(create_router(schedule));
+        }
+        // Warm up the caches and the allocator
+        run({&routers.front()}, {queries.begin(), queries.begin() + std::min<std::size_t>(queries.size(), 100)}, 0);
+
+        std::cout << queries.size() << " queries, " << (parameters.shared_router ? "shared" : "per-thread")
+                << " routers, " << (parameters.rate > 0 ? std::to_string(parameters.rate) + " queries/s"
+                                                         : std::string{"closed loop"}) << '\n'
+                << std::setw(8) << "threads" << std::setw(12) << "queries/s" << std::setw(10) << "speedup"
+                << std::setw(12) << "p50 us" << std::setw(12) << "p90 us" << std::setw(12) << "p99 us"
+                << std::setw(12) << "p99.9 us" << std::setw(12) << "max us" << '\n';
+        // Speedup is relative to the first thread count
+        auto baseline_throughput = 0.0;
+        for (const auto n_threads : parameters.thread_counts) {
+            auto thread_routers = std::vector<Raptor*>{};
+            for (std::size_t t = 0; t < n_threads; ++t) {
+                thread_routers.push_back(&routers[parameters.shared_router ? 0 : t]);
+            }
+            const auto [histogram, elapsed] = run(thread_routers, queries, parameters.rate);
+            const auto throughput = static_cast<double>(histogram.count()) /
+                                    std::chrono::duration<double>(elapsed).count();
+            if (baseline_throughput == 0) {
+                baseline_throughput = throughput;
+            }
+            const auto microseconds = [](const std::chrono::nanoseconds latency) {
+                return std::chrono::duration<double, std::micro>(latency).count();
+            };
+            std::cout << std::fixed << std::setprecision(1) << std::setw(8) << n_threads << std::setw(12)
+                    << throughput << std::setw(10) << throughput / baseline_throughput
+                    << std::setw(12) << microseconds(histogram.percentile(0.50))
+                    << std::setw(12) << microseconds(histogram.percentile(0.90))
+                    << std::setw(12) << microseconds(histogram.percentile(0.99))
+                    << std::setw(12) << microseconds(histogram.percentile(0.999))
+                    << std::setw(12) << microseconds(histogram.max()) << '\n';
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,148 @@
+#ifndef PT_ROUTING_BENCHMARK_QUERIES_H
+#define PT_ROUTING_BENCHMARK_QUERIES_H
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "schedule/Schedule.h"
+
+namespace raptor::benchmark {
+    /**
+     * A journey search between two stops, identified by their indices.
+     */
+    struct Query {
+        std::uint32_t origin;
+        std::uint32_t destination;
+        Time departure_time;
+    };
+
+    /**
+     * Creates random queries between stops served by at least one route, departing between 06:00 and 22:00 on the
+     * given day in the time zone of the first agency. The same seed always gives the same queries for a schedule.
+     * @throw std::invalid_argument If fewer than two stops are served by routes.
+     */
+    inline std::vector<Query> generate_queries(const Schedule& schedule, const std::chrono::year_month_day& date,
+                                               const std::size_t n_queries, const std::uint64_t seed) {
+        auto served = std::vector<bool>(schedule.get_stops().size());
+        for (const auto& route : schedule.get_routes()) {
+            for (const Stop& stop : route.stop_sequence()) {
+                served[stop.get_index()] = true;
+            }
+        }
+        auto stops = std::vector<std::uint32_t>{};
+        for (std::uint32_t i = 0; i < served.size(); ++i) {
+            if (served[i]) {
+                stops.push_back(i);
+            }
+        }
+        if (stops.size() < 2 || schedule.get_agencies().empty()) {
+            throw std::invalid_argument("The schedule has too few stops served by routes");
+        }
+
+        using namespace std::chrono_literals;
+        const auto* time_zone = schedule.get_agencies().front().get_time_zone();
+        const auto day_start = std::chrono::local_days{date} + 6h;
+        auto generator = std::mt19937_64{seed};
+        auto stop_distribution = std::uniform_int_distribution<std::size_t>{0, stops.size() - 1};
+        auto minute_distribution = std::uniform_int_distribution<int>{0, 16 * 60 - 1};
+        auto queries = std::vector<Query>{};
+        queries.reserve(n_queries);
+        while (queries.size() < n_queries) {
+            const auto origin = stops[stop_distribution(generator)];
+            const auto destination = stops[stop_distribution(generator)];
+            const auto minutes = std::chrono::minutes{minute_distribution(generator)};
+            if (origin != destination) {
+                queries.push_back({origin, destination, Time{time_zone, day_start + minutes}});
+            }
+        }
+        return queries;
+    }
+
+    /**
+     * Writes queries to a text file, one per line, with the indices of the origin and destination and the departure
+     * time in seconds since the epoch. Stop indices depend on the schedule, so the file records the number of stops
+     * and can only be replayed against the same schedule.
+     * @throw std::runtime_error If the file cannot be written.
+     */
+    inline void write_queries(const std::string& path, const Schedule& schedule, const std::vector<Query>& queries) {
+        auto output = std::ofstream(path);
+        output << "# pt_routing queries " << schedule.get_stops().size() << '\n';
+        for (const auto& [origin, destination, departure_time] : queries) {
+            output << origin << ' ' << destination << ' '
+                    << departure_time.get_sys_time().time_since_epoch().count() << '\n';
+        }
+        if (!output) {
+            throw std::runtime_error("Cannot write queries to " + path);
+        }
+    }
+
+    /**
+     * Reads queries written by write_queries. Departure times use the time zone of the first agency.
+     * @throw std::runtime_error If the file cannot be read or was written for a schedule with a different number of
+     * stops.
+     */
+    inline std::vector<Query> read_queries(const std::string& path, const Schedule& schedule) {
+        auto input = std::ifstream(path);
+        auto header = std::string{};
+        if (!std::getline(input, header)) {
+            throw std::runtime_error("Cannot read queries from " + path);
+        }
+        const auto n_stops = schedule.get_stops().size();
+        if (header != "# pt_routing queries " + std::to_string(n_stops)) {
+            throw std::runtime_error("Queries in " + path + " were not created for this schedule");
+        }
+        const auto* time_zone = schedule.get_agencies().front().get_time_zone();
+        auto queries = std::vector<Query>{};
+        auto origin = std::uint32_t{};
+        auto destination = std::uint32_t{};
+        auto seconds = std::int64_t{};
+        while (input >> origin >> destination >> seconds) {
+            if (origin >= n_stops || destination >= n_stops) {
+                throw std::runtime_error("Invalid stop in " + path);
+            }
+            queries.push_back({origin, destination,
+                               Time{time_zone, std::chrono::sys_seconds{std::chrono::seconds{seconds}}}});
+        }
+        if (!input.eof()) {
+            throw std::runtime_error("Invalid query in " + path);
+        }
+        return queries;
+    }
+
+    /**
+     * Latency percentiles and throughput of a set of queries.
+     */
+    struct LatencySummary {
+        std::chrono::duration<double, std::micro> p50;
+        std::chrono::duration<double, std::micro> p95;
+        std::chrono::duration<double, std::micro> p99;
+        std::chrono::duration<double, std::micro> max;
+        double queries_per_second;
+    };
+
+    /**
+     * @param latencies Latency of each query. Reordered by the function.
+     * @param total Wall time taken by all the queries.
+     */
+    inline LatencySummary summarize(std::vector<std::chrono::nanoseconds>& latencies,
+                                    const std::chrono::nanoseconds total) {
+        if (latencies.empty()) {
+            return {};
+        }
+        std::ranges::sort(latencies);
+        // Nearest-rank percentile
+        const auto percentile = [&latencies](const double p) {
+            const auto rank = static_cast<std::size_t>(std::ceil(p * static_cast<double>(latencies.size())));
+            return latencies[std::clamp<std::size_t>(rank, 1, latencies.size()) - 1];
+        };
+        return {percentile(0.50), percentile(0.95), percentile(0.99), latencies.back(),
+                static_cast<double>(latencies.size()) / std::chrono::duration<double>(total).count()};
+    }
+}
+
+#endif //PT_ROUTING_BENCHMARK_QUERIES_H
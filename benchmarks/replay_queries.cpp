@@ -0,0 +1,118 @@
+/**
+ * Replays the queries of a query log written by raptor::QueryLog and compares their latency with the logged one, so
+ * that slow queries seen in production can be investigated and used to check optimisations.
+ *
+ * Usage: pt_replay_queries <query log> <first date> <last date> <repeat> <feed directory>[:<prefix>]...
+ * The feeds must be given with the same prefixes, in the same order, and loaded with the same dates as when the log was
+ * written, which is checked with the fingerprint of the schedule. Transfers are built with a StopKDTree, a
+ * LinearWalkTimeCalculator at 5 km/h and the default TransferManagerParameters, and must give the same footpaths as the
+ * router which wrote the log, which is checked with the fingerprint of the transfers. Each query is run the given
+ * number of times and the fastest run is reported.
+ */
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include "command_line.h"
+#include "raptor/query_log.h"
+#include "schedule/gtfs.h"
+#include "transfers/kd_tree.h"
+#include "transfers/linear_walk_calculator.h"
+
+using namespace raptor;
+
+/**
+ * Formats a time as YYYY-MM-DD HH:MM in its own time zone.
+ */
+std::string format_local_time(const Time& time) {
+    const auto local_time = std::chrono::floor<std::chrono::minutes>(time.get_local_time());
+    const auto day = std::chrono::floor<std::chrono::days>(local_time);
+    const auto date = std::chrono::year_month_day{day};
+    const auto time_of_day = std::chrono::hh_mm_ss{local_time - day};
+    auto stream = std::ostringstream{};
+    stream << std::setfill('0') << static_cast<int>(date.year()) << '-' << std::setw(2)
+            << static_cast<unsigned>(date.month()) << '-' << std::setw(2) << static_cast<unsigned>(date.day()) << ' '
+            << std::setw(2) << time_of_day.hours().count() << ':' << std::setw(2) << time_of_day.minutes().count();
+    return stream.str();
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 6) {
+        std::cerr << "Usage: " << argv[0]
+                << " <query log> <first date> <last date> <repeat> <feed directory>[:<prefix>]...\n";
+        return 1;
+    }
+    try {
+        const auto log = QueryLog::read(argv[1]);
+        const auto first_date = parse_date(argv[2]);
+        const auto last_date = parse_date(argv[3]);
+        const auto repeat = std::stoi(argv[4]);
+        if (repeat <= 0) {
+            throw std::invalid_argument("The number of repetitions must be positive");
+        }
+        auto sources = std::vector<raptor::gtfs::FeedSource>{};
+        for (auto i = 5; i < argc; ++i) {
+            sources.push_back(parse_feed_source(argv[i]));
+        }
+
+        const auto schedule = raptor::gtfs::from_gtfs(sources, first_date, last_date);
+        if (schedule.fingerprint() != log.schedule_fingerprint) {
+            throw std::runtime_error("The query log was written for a different schedule");
+        }
+        auto router = Raptor(schedule, TransferManager(schedule, StopKDTree::create_factory(),
+                                                       std::make_unique<LinearWalkTimeCalculator>(5.0)));
+        if (router.get_transfer_manager().fingerprint() != log.transfers_fingerprint) {
+            throw std::runtime_error("The query log was written with different transfers");
+        }
+        const auto& stops = schedule.get_stops();
+        // Departure times are shown in the time zone of the first agency, like the queries of the benchmarks
+        const auto* time_zone = schedule.get_agencies().front().get_time_zone();
+
+        std::cout << log.queries.size() << " queries\n" << std::left << std::setw(20) << "origin" << std::setw(20)
+                << "destination" << std::setw(22) << "departure" << std::right << std::setw(12) << "logged us"
+                << std::setw(12) << "replay us" << std::setw(8) << "rounds" << std::setw(12) << "routes"
+                << std::setw(14) << "stop events" << '\n';
+        const auto microseconds = [](const std::chrono::nanoseconds latency) {
+            return std::chrono::duration<double, std::micro>(latency).count();
+        };
+        auto total_logged = std::chrono::nanoseconds::zero();
+        auto total_replayed = std::chrono::nanoseconds::zero();
+        for (const auto& query : log.queries) {
+            if (query.origin >= stops.size() || query.destination >= stops.size()) {
+                throw std::runtime_error("Query log refers to a missing stop");
+            }
+            const auto& origin = stops[query.origin];
+            const auto& destination = stops[query.destination];
+            const auto departure_time = Time{time_zone, query.departure_time};
+
+            auto fastest = std::chrono::nanoseconds::max();
+            auto stats = QueryStats{};
+            for (auto i = 0; i < repeat; ++i) {
+                const auto start = std::chrono::steady_clock::now();
+                router.route(origin, destination, departure_time, &stats);
+                fastest = std::min<std::chrono::nanoseconds>(fastest, std::chrono::steady_clock::now() - start);
+            }
+            total_logged += query.latency;
+            total_replayed += fastest;
+
+            // Work is taken from the replay when statistics are enabled, and from the log otherwise
+            const auto rounds = QueryStats::enabled ? stats.rounds_executed() : query.rounds;
+            const auto work = QueryStats::enabled ? stats.total() : query.work;
+            std::cout << std::left << std::setw(20) << origin.get_gtfs_id().view() << std::setw(20)
+                    << destination.get_gtfs_id().view() << std::setw(22)
+                    << format_local_time(departure_time) << std::right << std::fixed
+                    << std::setprecision(1) << std::setw(12) << microseconds(query.latency) << std::setw(12)
+                    << microseconds(fastest) << std::setw(8) << rounds << std::setw(12) << work.routes_scanned
+                    << std::setw(14) << work.stop_events_visited << '\n';
+        }
+        if (!log.queries.empty()) {
+            const auto n_queries = static_cast<std::int64_t>(log.queries.size());
+            std::cout << "mean logged " << microseconds(total_logged / n_queries) << " us, replayed "
+                    << microseconds(total_replayed / n_queries) << " us\n";
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+    return 0;
+}
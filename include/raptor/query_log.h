@@ -0,0 +1,91 @@
+#ifndef PT_ROUTING_QUERY_LOG_H
+#define PT_ROUTING_QUERY_LOG_H
+#include <atomic>
+#include <fstream>
+#include <mutex>
+#include <string>
+
+#include "raptor/raptor.h"
+
+namespace raptor {
+    /**
+     * A query saved in a QueryLog, with the latency and the work done when it was logged.
+     */
+    struct LoggedQuery {
+        std::uint32_t origin;
+        std::uint32_t destination;
+        std::chrono::sys_seconds departure_time;
+        std::chrono::nanoseconds latency;
+        /**
+         * Statistics of the query. Empty unless the library was built with PT_ROUTING_QUERY_STATS.
+         */
+        std::uint32_t rounds = 0;
+        RoundStats work;
+    };
+
+    struct QueryLogParameters {
+        /**
+         * Queries taking at least this long are always logged.
+         */
+        std::chrono::nanoseconds latency_threshold = std::chrono::milliseconds{100};
+        /**
+         * Fraction of the faster queries which are logged, chosen at random.
+         */
+        double sample_fraction = 0.0;
+        std::uint64_t seed = 1;
+    };
+
+    /**
+     * Runs queries and saves the slow and sampled ones to a compact binary file, so that they can be replayed later.
+     *
+     * The file starts with the fingerprints of the schedule and of the transfers of the router, since stops are saved
+     * by their indices and queries can only be replayed against the same schedule and footpaths.
+     */
+    class QueryLog {
+        std::mutex mutex;
+        std::ofstream output;
+        QueryLogParameters parameters;
+        std::uint64_t sample_threshold;
+        std::atomic<std::uint64_t> n_queries{0};
+
+        /**
+         * Decides randomly whether a query under the latency threshold is logged, without synchronising threads.
+         */
+        [[nodiscard]] bool sampled(std::uint64_t query_number) const noexcept;
+
+    public:
+        /**
+         * Creates the log, replacing any existing file.
+         * @throw std::runtime_error If the file cannot be written.
+         */
+        QueryLog(const std::string& path, const Raptor& router, QueryLogParameters parameters = {});
+
+        /**
+         * Runs the query with the given router, and logs it if it is slow or sampled. The router should be the one
+         * given when creating the log, or one with the same schedule and transfers. Can be called from multiple
+         * threads at once.
+         */
+        std::vector<Movement> route(Raptor& router, const Stop& origin, const Stop& destination,
+                                    const Time& departure_time);
+
+        /**
+         * Writes a query to the log. Every query is written immediately, so that it is kept if the process stops.
+         * Can be called from multiple threads at once.
+         */
+        void write(const LoggedQuery& query);
+
+        struct Contents {
+            std::uint64_t schedule_fingerprint;
+            std::uint64_t transfers_fingerprint;
+            std::vector<LoggedQuery> queries;
+        };
+
+        /**
+         * Reads all queries of a log.
+         * @throw std::runtime_error If the file cannot be read or is not a query log.
+         */
+        static Contents read(const std::string& path);
+    };
+}
+
+#endif //PT_ROUTING_QUERY_LOG_H
@@ -0,0 +1,217 @@
+#ifndef PT_ROUTING_QUERY_STATS_H
+#define PT_ROUTING_QUERY_STATS_H
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+#include "raptor/query_trace.h"
+
+namespace raptor {
+    /**
+     * Work done by the router in a single round of a query.
+     */
+    struct RoundStats {
+        /**
+         * Stops improved in the previous round, from which the routes of this round are collected.
+         */
+        std::size_t stops_marked = 0;
+        std::size_t routes_scanned = 0;
+        /**
+         * Stop times of the followed trips examined while scanning the routes.
+         */
+        std::size_t stop_events_visited = 0;
+        /**
+         * Searches for the earliest trip of a route which can be boarded from a stop.
+         */
+        std::size_t trips_searched = 0;
+        std::size_t labels_improved = 0;
+        std::size_t transfers_relaxed = 0;
+
+        RoundStats& operator+=(const RoundStats& other) noexcept {
+            stops_marked += other.stops_marked;
+            routes_scanned += other.routes_scanned;
+            stop_events_visited += other.stop_events_visited;
+            trips_searched += other.trips_searched;
+            labels_improved += other.labels_improved;
+            transfers_relaxed += other.transfers_relaxed;
+            return *this;
+        }
+    };
+
+    /**
+     * Counters and phase timings of a single query, filled by Raptor::route.
+     *
+     * Statistics are only collected when the library is built with the PT_ROUTING_QUERY_STATS option. Otherwise, the
+     * code collecting them is compiled out and the statistics are left empty.
+     */
+    struct QueryStats {
+#ifdef PT_ROUTING_QUERY_STATS
+        static constexpr bool enabled = true;
+#else
+        static constexpr bool enabled = false;
+#endif
+
+        /**
+         * Work done in each round. The first element contains the transfers from the origin, made before the first
+         * round.
+         */
+        std::vector<RoundStats> rounds;
+        std::chrono::nanoseconds route_collection{};
+        std::chrono::nanoseconds route_scanning{};
+        std::chrono::nanoseconds transfers{};
+        std::chrono::nanoseconds reconstruction{};
+
+        /**
+         * Number of rounds executed, not counting the transfers from the origin.
+         */
+        [[nodiscard]] std::size_t rounds_executed() const noexcept {
+            return rounds.empty() ? 0 : rounds.size() - 1;
+        }
+
+        /**
+         * Sum of the counters of all rounds.
+         */
+        [[nodiscard]] RoundStats total() const noexcept {
+            auto total = RoundStats{};
+            for (const auto& round : rounds) {
+                total += round;
+            }
+            return total;
+        }
+    };
+
+    /**
+     * Records statistics into a QueryStats object and a trace into a QueryTrace object, if they are given. All its
+     * functions do nothing when statistics are disabled at compile time, so that they can be called from the query code
+     * without any cost.
+     */
+    class QueryStatsRecorder {
+        QueryStats* stats;
+        QueryTrace* trace;
+
+    public:
+        explicit QueryStatsRecorder(QueryStats* stats, QueryTrace* trace = nullptr) noexcept :
+            stats(QueryStats::enabled ? stats : nullptr), trace(QueryStats::enabled ? trace : nullptr) {
+            if constexpr (QueryStats::enabled) {
+                if (stats != nullptr) {
+                    *stats = QueryStats{};
+                }
+                if (trace != nullptr) {
+                    *trace = QueryTrace{};
+                }
+            }
+        }
+
+        [[nodiscard]] bool recording() const noexcept {
+            if constexpr (QueryStats::enabled) {
+                return stats != nullptr;
+            }
+            return false;
+        }
+
+        [[nodiscard]] bool tracing() const noexcept {
+            if constexpr (QueryStats::enabled) {
+                return trace != nullptr;
+            }
+            return false;
+        }
+
+        /**
+         * Starts counting the work of a new round.
+         */
+        void new_round() const {
+            if (recording()) {
+                stats->rounds.emplace_back();
+            }
+            if (tracing()) {
+                trace->rounds.emplace_back();
+            }
+        }
+
+        /**
+         * Adds the given value to a counter of the current round.
+         * @param counter Pointer to the counter, for example &RoundStats::routes_scanned.
+         */
+        void add(std::size_t RoundStats::* counter, const std::size_t value = 1) const noexcept {
+            if (recording()) {
+                stats->rounds.back().*counter += value;
+            }
+        }
+
+        /**
+         * Sets the query being traced.
+         */
+        void trace_query(const std::size_t origin, const std::size_t destination,
+                         const std::chrono::sys_seconds departure_time) const noexcept {
+            if (tracing()) {
+                trace->origin = static_cast<std::uint32_t>(origin);
+                trace->destination = static_cast<std::uint32_t>(destination);
+                trace->departure_time = departure_time;
+            }
+        }
+
+        /**
+         * Adds the stops marked for the current round to the trace.
+         * @param stops Range of references to the stops.
+         */
+        template <typename R>
+        void trace_marked_stops(const R& stops) const {
+            if (tracing()) {
+                auto& marked_stops = trace->rounds.back().marked_stops;
+                for (const auto& stop : stops) {
+                    marked_stops.push_back(static_cast<std::uint32_t>(stop.get().get_index()));
+                }
+                std::ranges::sort(marked_stops);
+            }
+        }
+
+        /**
+         * Adds a route scanned in the current round to the trace.
+         */
+        void trace_route(const std::size_t route, const std::size_t hop_on_stop_index) const {
+            if (tracing()) {
+                trace->rounds.back().routes.push_back({static_cast<std::uint32_t>(route),
+                                                       static_cast<std::uint32_t>(hop_on_stop_index)});
+            }
+        }
+
+        /**
+         * Adds a label improved in the current round to the trace.
+         * @param route Index of the route of the trip, or TracedLabel::no_route for transfers.
+         */
+        void trace_label(const std::size_t stop, const std::size_t from_stop,
+                         const std::chrono::sys_seconds arrival_time, const LabelReason reason,
+                         const std::size_t route = TracedLabel::no_route) const {
+            if (tracing()) {
+                trace->rounds.back().labels.push_back({static_cast<std::uint32_t>(stop),
+                                                       static_cast<std::uint32_t>(from_stop), arrival_time, reason,
+                                                       static_cast<std::uint32_t>(route)});
+            }
+        }
+
+        /**
+         * Runs the given function and adds the time it took to a phase of the query.
+         * @param phase Pointer to the duration of the phase, for example &QueryStats::transfers.
+         * @return Value returned by the function.
+         */
+        template <typename F>
+        decltype(auto) time(std::chrono::nanoseconds QueryStats::* phase, F&& function) const {
+            if (!recording()) {
+                return function();
+            }
+            const auto start = std::chrono::steady_clock::now();
+            struct AddElapsed {
+                std::chrono::nanoseconds& duration;
+                std::chrono::steady_clock::time_point start;
+
+                ~AddElapsed() {
+                    duration += std::chrono::steady_clock::now() - start;
+                }
+            } add_elapsed{stats->*phase, start};
+            return function();
+        }
+    };
+}
+
+#endif //PT_ROUTING_QUERY_STATS_H
@@ -0,0 +1,111 @@
+#ifndef PT_ROUTING_QUERY_TRACE_H
+#define PT_ROUTING_QUERY_TRACE_H
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace raptor {
+    class Schedule;
+
+    /**
+     * A route scanned in a round, with the index in its stop sequence of the first stop where it could be boarded.
+     */
+    struct TracedRoute {
+        std::uint32_t route;
+        std::uint32_t hop_on_stop_index;
+    };
+
+    /**
+     * How a stop was reached when its label was improved.
+     */
+    enum class LabelReason : std::uint8_t {
+        /**
+         * Riding a trip of a route, boarded at the previous stop of the label.
+         */
+        Trip,
+        /**
+         * Walking from the previous stop of the label.
+         */
+        Transfer,
+    };
+
+    /**
+     * An improvement of the arrival time at a stop.
+     */
+    struct TracedLabel {
+        static constexpr auto no_route = std::numeric_limits<std::uint32_t>::max();
+
+        std::uint32_t stop;
+        /**
+         * Stop where the trip was boarded or the walk started.
+         */
+        std::uint32_t from_stop;
+        std::chrono::sys_seconds arrival_time;
+        LabelReason reason;
+        /**
+         * Route of the trip, or no_route for transfers.
+         */
+        std::uint32_t route = no_route;
+    };
+
+    /**
+     * What the router did in a single round of a query.
+     */
+    struct TracedRound {
+        /**
+         * Stops improved in the previous round, from which the routes of this round are collected, sorted by index.
+         */
+        std::vector<std::uint32_t> marked_stops;
+        std::vector<TracedRoute> routes;
+        /**
+         * Labels improved in the round, in the order they were improved.
+         */
+        std::vector<TracedLabel> labels;
+    };
+
+    /**
+     * Round-by-round trace of a query, filled by Raptor::route, which shows how the search spread through the network.
+     *
+     * Traces are recorded by the same code as QueryStats, so they are only filled when the library is built with the
+     * PT_ROUTING_QUERY_STATS option. Stops and routes are stored by their indices in the schedule.
+     */
+    struct QueryTrace {
+        std::uint32_t origin = 0;
+        std::uint32_t destination = 0;
+        std::chrono::sys_seconds departure_time{};
+        /**
+         * Rounds of the query. Like in QueryStats, the first element contains the transfers from the origin, made
+         * before the first round.
+         */
+        std::vector<TracedRound> rounds;
+
+        /**
+         * Writes the trace to a compact binary file, together with the fingerprint of the schedule.
+         * @throw std::runtime_error If the file cannot be written.
+         */
+        void write(const std::string& path, const Schedule& schedule) const;
+
+        /**
+         * Reads a trace written by write.
+         * @param schedule Schedule used by the query. Must be the same schedule the trace was written with.
+         * @throw std::runtime_error If the file is not a trace, or it was written for a different schedule.
+         */
+        static QueryTrace read(const std::string& path, const Schedule& schedule);
+
+        /**
+         * Writes the trace as a GeoJSON feature collection. Every feature has a round and a kind property:
+         *  - origin and destination: Points at the stops of the query.
+         *  - marked_stop: Points at the stops marked for the round.
+         *  - scanned_route: LineStrings along each scanned route, from its hop-on stop to its last stop.
+         *  - label: LineStrings from the previous stop of each improved label to its stop, with the reason, the route
+         *    and the arrival time in seconds after the departure.
+         * @param schedule Schedule used by the query.
+         */
+        void write_geojson(std::ostream& output, const Schedule& schedule) const;
+    };
+}
+
+#endif //PT_ROUTING_QUERY_TRACE_H
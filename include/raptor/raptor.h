@@ -1,9 +1,10 @@
 #ifndef RAPTOR_H
 #define RAPTOR_H
 
+#include <limits>
 #include <ranges>
-#include <unordered_map>
 
+#include "raptor/query_stats.h"
 #include "raptor/reconstruction.h"
 #include "schedule/Schedule.h"
 #include "raptor/state.h"
@@ -13,19 +14,40 @@ namespace raptor {
 
     class Raptor {
 
-        // Make the reference wrapper const so it can be used to directly extract pairs from the unordered_map
-        using RouteWithStopIndex = std::pair<const std::reference_wrapper<const Route>, StopIndex>;
+        using RouteWithStopIndex = std::pair<std::reference_wrapper<const Route>, StopIndex>;
 
-        std::unordered_map<std::reference_wrapper<const Stop>, std::vector<RouteWithStopIndex>>
-        routes_serving_stop;
         /**
-         * Calculates which routes serve every stop. Includes only stops which are served by some route.
+         * Routes serving each stop, indexed by the index of the stop.
+         */
+        std::vector<std::vector<RouteWithStopIndex>> routes_serving_stop;
+        /**
+         * Calculates which routes serve every stop. Stops which are not served by any route have no routes.
          */
         void build_routes_serving_stop();
 
         const Schedule& schedule;
         TransferManager transfer_manager;
 
+        /**
+         * Memory used by the queries of a thread. It is kept between queries, so that once it has grown to the size
+         * of the schedule, queries only clear the entries which they used instead of allocating.
+         */
+        struct Workspace {
+            RaptorState state;
+            /**
+             * Earliest marked stop of each route in the current round, indexed by the indices of the routes. Routes
+             * without a marked stop have no_marked_stop.
+             */
+            std::vector<StopIndex> earliest_marked_stop;
+            std::vector<RouteWithStopIndex> routes_to_examine;
+        };
+        static constexpr auto no_marked_stop = std::numeric_limits<StopIndex>::max();
+
+        /**
+         * Workspace of the calling thread, so that routers can be shared between threads.
+         */
+        static Workspace& thread_workspace();
+
         /**
          * Find the earliest trip which departs from the given stop after the given departure time.
          * @param route_trips Range with Trip objects of a specific route, sorted by ascending departure time from the
@@ -56,42 +78,111 @@ namespace raptor {
                                         });
         }
 
+        /**
+         * Find the earliest trip which departs from the given stop after the given departure time, using binary
+         * search.
+         * @param route_trips Range with Trip objects of a FIFO route. Since trips of a FIFO route never overtake each
+         * other, the trips are sorted by departure time at every stop.
+         * @param departure_time Departure time from the given stop.
+         * @param stop_index Index of the stop in the route.
+         * @return Iterator to the route_trips range, pointing to the found trip. If no trip was found, iterator
+         * pointing to route_trips.end().
+         */
+        template <std::ranges::random_access_range R>
+            requires std::is_convertible_v<std::ranges::range_value_t<R>, const Trip&>
+        static std::ranges::borrowed_iterator_t<R> find_earliest_trip_fifo(
+                R&& route_trips,
+                const std::chrono::zoned_seconds& departure_time,
+                const StopIndex stop_index) {
+            return std::ranges::lower_bound(route_trips, departure_time.get_sys_time(), std::ranges::less{},
+                                            [&stop_index](const Trip& trip) {
+                                                return std::ranges::next(trip.get_stop_times().begin(), stop_index)->
+                                                        get_departure_time().get_sys_time();
+                                            });
+        }
+
         std::vector<Movement> build_trip(const Stop& origin,
                                          const Stop& destination,
                                          const LabelManager& stop_labels);
-        void process_transfers(RaptorState& status);
+        void process_transfers(RaptorState& status, const QueryStatsRecorder& stats);
 
-        void process_route(const Route& route, StopIndex hop_on_stop_idx, Time hop_on_time, RaptorState& status);
+        void process_route(const Route& route, StopIndex hop_on_stop_idx, Time hop_on_time, RaptorState& status,
+                           const QueryStatsRecorder& stats);
 
 
+        /**
+         * Finds the routes serving the improved stops, with the earliest improved stop of each route.
+         * @return Routes in the order of their indices. The vector is valid until the next call with the same
+         * workspace.
+         */
         template <std::ranges::input_range R>
             requires std::is_convertible_v<std::ranges::range_value_t<R>, const Stop>
-        std::vector<RouteWithStopIndex>
-        find_routes_to_examine(R&& improved_stops) {
-            auto route_to_earliest_stop = std::unordered_map<
-                std::remove_const_t<RouteWithStopIndex::first_type>, RouteWithStopIndex::second_type>();
+        const std::vector<RouteWithStopIndex>& find_routes_to_examine(R&& improved_stops, Workspace& workspace) {
+            auto& earliest_marked_stop = workspace.earliest_marked_stop;
+            auto& routes_to_examine = workspace.routes_to_examine;
+            routes_to_examine.clear();
             for (const Stop& stop : improved_stops) {
                 // It is possible that a stop is not served by any route but can be accessed only on foot.
-                auto& routes_for_stop = routes_serving_stop[stop];
+                const auto& routes_for_stop = routes_serving_stop[stop.get_index()];
                 for (auto [route, stop_index] : routes_for_stop) {
-                    auto current_stop_index = route_to_earliest_stop.find(route);
-                    auto new_route = current_stop_index == route_to_earliest_stop.end();
-                    auto earlier_stop = !new_route && current_stop_index->second > stop_index;
-                    if (new_route || earlier_stop) {
-                        route_to_earliest_stop.insert_or_assign(route, stop_index);
+                    auto& earliest_stop = earliest_marked_stop[route.get().get_index()];
+                    if (earliest_stop == no_marked_stop) {
+                        routes_to_examine.emplace_back(route, stop_index);
                     }
+                    earliest_stop = std::min(earliest_stop, stop_index);
                 }
             }
-            return {std::make_move_iterator(route_to_earliest_stop.begin()),
-                    std::make_move_iterator(route_to_earliest_stop.end())};
+            // Take the earliest stop of each route, leaving the entries clear for the next round
+            for (auto& [route, stop_index] : routes_to_examine) {
+                auto& earliest_stop = earliest_marked_stop[route.get().get_index()];
+                stop_index = earliest_stop;
+                earliest_stop = no_marked_stop;
+            }
+            // Routes are stored in an order which improves locality, so they are processed in the same order
+            std::ranges::sort(routes_to_examine, std::less{}, [](const RouteWithStopIndex& route_with_index) {
+                return route_with_index.first.get().get_index();
+            });
+            return routes_to_examine;
         }
 
     public:
         explicit Raptor(const Schedule& schedule, TransferManager tm);
 
 
+        /**
+         * Finds the journey arriving earliest at the destination.
+         * @param stats If given, it is filled with the work done by the query. Requires the library to be built with
+         * the PT_ROUTING_QUERY_STATS option, otherwise it is left empty.
+         * @param trace If given, it is filled with a round-by-round trace of the search. Like the statistics, it
+         * requires the PT_ROUTING_QUERY_STATS option.
+         * @return Movements of the journey, or an empty vector if the destination cannot be reached.
+         */
         std::vector<Movement> route(const Stop& origin, const Stop& destination,
-                                    const Time& departure_time);
+                                    const Time& departure_time, QueryStats* stats = nullptr,
+                                    QueryTrace* trace = nullptr);
+
+        /**
+         * Finds the journey arriving earliest at the destination, with the stops given by their indices in the
+         * schedule.
+         * @throw std::out_of_range If a stop index is not an index of a stop of the schedule.
+         * @see Stop::get_index
+         */
+        std::vector<Movement> route(std::size_t origin, std::size_t destination, const Time& departure_time,
+                                    QueryStats* stats = nullptr, QueryTrace* trace = nullptr);
+
+        [[nodiscard]] const Schedule& get_schedule() const noexcept {
+            return schedule;
+        }
+
+        [[nodiscard]] const TransferManager& get_transfer_manager() const noexcept {
+            return transfer_manager;
+        }
+
+        /**
+         * Memory used by the router, including its indexes and transfers. The schedule is not owned by the router
+         * and is not included.
+         */
+        [[nodiscard]] MemoryUsage memory_usage() const;
     };
 }
 
@@ -1,8 +1,7 @@
 #ifndef PT_ROUTING_STATE_H
 #define PT_ROUTING_STATE_H
 #include <ranges>
-#include <unordered_map>
-#include <unordered_set>
+#include <vector>
 
 #include <schedule/Schedule.h>
 
@@ -39,10 +38,22 @@ namespace raptor {
      */
     class LabelManager {
         using LabelType = JourneyInformation;
-        using LabelContainer = std::unordered_map<std::reference_wrapper<const Stop>, LabelType>;
+        /**
+         * Labels indexed by the indices of the stops. Stops which have not been reached have no label.
+         */
+        using LabelContainer = std::vector<std::optional<LabelType>>;
 
         LabelContainer current_round_labels;
         LabelContainer previous_round_labels;
+        /**
+         * Indices of the stops whose label changed since the last call to new_round. A stop appears once for each
+         * change.
+         */
+        std::vector<std::size_t> changed_stops;
+        /**
+         * Indices of the stops which have a label, so that reset clears only those.
+         */
+        std::vector<std::size_t> labelled_stops;
 
         /**
          * Retrieves the label for the given stop from the given container, if it exists.
@@ -52,6 +63,13 @@ namespace raptor {
     public:
         LabelManager() = default;
 
+        /**
+         * Initialises the object without any labels, with room for the labels of the given number of stops.
+         */
+        explicit LabelManager(const std::size_t n_stops) {
+            reset(n_stops);
+        }
+
         /**
          * Initialises the object and adds a label to the current set.
          */
@@ -59,10 +77,17 @@ namespace raptor {
                      const Time& arrival_time,
                      const std::optional<std::reference_wrapper<const Stop>>& boarding_stop,
                      const std::optional<std::pair<std::reference_wrapper<const Route>, TripIndex>>&
-                     route_with_trip_index) {
+                     route_with_trip_index) :
+            LabelManager(stop.get_index() + 1) {
             add_label(stop, arrival_time, boarding_stop, route_with_trip_index);
         }
 
+        /**
+         * Removes all the labels and makes room for the labels of the given number of stops. Only the labels which
+         * were set are cleared, so that reusing the object costs nothing for the stops which were not reached.
+         */
+        void reset(std::size_t n_stops);
+
         /**
          * Copies the labels of the current round to the previous round
          */
@@ -70,7 +95,7 @@ namespace raptor {
 
         /**
          * Adds or changes the value of the label for the latest set.
-         * @param stop
+         * @param stop Stop with an index smaller than the number of stops given to reset.
          * @param arrival_time Arrival time at the stop.
          * @param boarding_stop Stop where the line is boarded to reach the stop.
          * @param route_with_trip_index Route used to travel between the stops along with the index of the trip used.
@@ -80,8 +105,13 @@ namespace raptor {
                        const std::optional<std::reference_wrapper<const Stop>>& boarding_stop,
                        const std::optional<std::pair<std::reference_wrapper<const Route>, TripIndex>>&
                        route_with_trip_index) {
-            current_round_labels.insert_or_assign(
-                    stop, JourneyInformation(arrival_time, boarding_stop, route_with_trip_index));
+            const auto index = stop.get_index();
+            auto& label = current_round_labels[index];
+            if (!label.has_value()) {
+                labelled_stops.push_back(index);
+            }
+            label.emplace(arrival_time, boarding_stop, route_with_trip_index);
+            changed_stops.push_back(index);
         }
 
         std::optional<LabelType> get_latest_label(const Stop& stop) const;
@@ -100,14 +130,14 @@ namespace raptor {
             requires std::is_convertible_v<std::ranges::range_value_t<R>, Stop>
         std::optional<IndexWithTime> find_hop_on_stop(
                 R&& stops) {
-            auto stops_with_journeys = previous_round_labels | std::views::keys;
-            auto hop_on_stop = std::ranges::find_first_of(stops, stops_with_journeys,
-                                                          {}, {}, &LabelContainer::value_type::first);
-            if (hop_on_stop == std::ranges::end(stops)) {
-                return std::nullopt;
+            auto stop_index = StopIndex{0};
+            for (const Stop& stop : stops) {
+                if (const auto& label = previous_round_labels[stop.get_index()]; label.has_value()) {
+                    return std::make_pair(stop_index, label->arrival_time);
+                }
+                ++stop_index;
             }
-            return std::make_pair(std::ranges::distance(std::ranges::begin(stops), hop_on_stop),
-                                  previous_round_labels.at(*hop_on_stop).arrival_time);
+            return std::nullopt;
         }
     };
 
@@ -123,10 +153,26 @@ namespace raptor {
      */
     class RaptorState {
         LabelManager label_manager;
-        std::unordered_map<std::reference_wrapper<const Stop>, Time> earliest_arrival_time;
-        std::unordered_set<std::reference_wrapper<const Stop>> improved_stops;
+        /**
+         * Earliest arrival time at each stop over all rounds, indexed by the indices of the stops.
+         */
+        std::vector<std::optional<Time>> earliest_arrival_time;
+        /**
+         * Indices of the stops with an arrival time, so that reset clears only those.
+         */
+        std::vector<std::size_t> reached_stops;
+        /**
+         * Whether each stop is in improved_stops, indexed by the indices of the stops.
+         */
+        std::vector<bool> is_improved;
+        std::vector<std::reference_wrapper<const Stop>> improved_stops;
+        /**
+         * Stops returned by the last call to get_and_clear_improved_stops. Swapped with improved_stops, so that
+         * neither has to allocate again.
+         */
+        std::vector<std::reference_wrapper<const Stop>> marked_stops;
         int n_round = 0;
-        const Stop& destination;
+        const Stop* destination = nullptr;
 
         /**
          * Examines if the given arrival time can be used to improve the arrival time to the given stop.
@@ -136,7 +182,10 @@ namespace raptor {
         bool can_improve_current_journey_to_stop(const Time& new_arrival_time, const Stop& current_stop) const;
 
     public:
-        RaptorState() = delete;
+        /**
+         * Creates an object without a query, which must be started with reset before it is used.
+         */
+        RaptorState() = default;
 
         // Copying this object is probably an error. Delete to avoid doing it by mistake.
         RaptorState(const RaptorState& other) = delete;
@@ -148,8 +197,18 @@ namespace raptor {
          * @param origin_stop Origin stop, used to initialise the object.
          * @param destination Destination stop, used for target pruning.
          * @param departure_time Departure time from origin stop, used to initialise the object.
+         * @param n_stops Number of stops of the schedule. Every stop given to the object must have a smaller index.
          */
-        RaptorState(const Stop& origin_stop, const Stop& destination, const Time& departure_time);
+        RaptorState(const Stop& origin_stop, const Stop& destination, const Time& departure_time,
+                    std::size_t n_stops);
+
+        /**
+         * Starts a new query, as if the object had been created with the given arguments. Only the stops reached by
+         * the previous query are cleared, so that reusing the object for many queries does not allocate.
+         */
+        void reset(const Stop& origin_stop, const Stop& destination, const Time& departure_time,
+                   std::size_t n_stops);
+
         /**
          * Starts a new round of the algorithm.
          * @return Number of transfers used in this round.
@@ -192,15 +251,16 @@ namespace raptor {
 
         /**
          * Gets the stops which are currently marked as improved and empties the collection.
-         * @return Set of improved stops
+         * @return Improved stops, each once. The vector is valid until the next call.
          */
-        std::unordered_set<std::reference_wrapper<const Stop>> get_and_clear_improved_stops();
+        const std::vector<std::reference_wrapper<const Stop>>& get_and_clear_improved_stops();
 
         /**
          * Get the stops which have been marked as improved.
-         * @return Copy of the set with the stops which have been marked as improved.
+         * @return Improved stops, each once. Stops improved later are appended to the vector, which may invalidate
+         * references to its elements.
          */
-        [[nodiscard]] std::unordered_set<std::reference_wrapper<const Stop>> get_improved_stops() const;
+        [[nodiscard]] const std::vector<std::reference_wrapper<const Stop>>& get_improved_stops() const;
         [[nodiscard]] Time current_arrival_time_to_stop(const Stop& stop) const;
         [[nodiscard]] Time previous_arrival_time_to_stop(const Stop& stop) const;
         // TODO: Remove this, currently used when building journeys.
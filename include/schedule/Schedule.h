@@ -3,12 +3,15 @@
 
 #include <algorithm>
 #include <chrono>
+#include <cstdint>
 #include <deque>
+#include <memory>
 #include <string>
 #include <utility>
 
 #include <schedule/components/route.h>
 #include <schedule/components/stop.h>
+#include <schedule/components/transfer.h>
 
 namespace raptor {
 
@@ -16,9 +19,24 @@ namespace raptor {
     public:
         Schedule() = delete;
 
-        Schedule(std::deque<Agency>&& agencies, StopManager&& stop_manager, std::vector<Route>&& routes) :
-            agencies(std::move(agencies)), stop_manager(std::move(stop_manager)),
-            routes(std::move(routes)) {
+        /**
+         * @param stop_patterns Stop sequences referenced by the routes. Must contain the sequences of all routes.
+         * @param routes Routes of the schedule. They are reordered by the stops they visit, so their order is not
+         * preserved.
+         * @param transfers Transfers between stops of the stop manager, defined by the feed.
+         * @param string_pool Pool storing the IDs and names of the objects, which is kept alive by the schedule. May be
+         * null if the strings are stored in a pool which outlives the schedule, such as StringPool::shared.
+         */
+        Schedule(std::deque<Agency>&& agencies, StopManager&& stop_manager, StopPatternStore&& stop_patterns,
+                 std::vector<Route>&& routes, std::vector<StopTransfer>&& transfers = {},
+                 std::shared_ptr<const StringPool> string_pool = nullptr) :
+            string_pool(std::move(string_pool)), agencies(std::move(agencies)), stop_manager(std::move(stop_manager)),
+            stop_patterns(std::move(stop_patterns)), routes(order_routes(std::move(routes))),
+            transfers(std::move(transfers)) {
+        }
+
+        [[nodiscard]] const std::deque<Agency>& get_agencies() const {
+            return agencies;
         }
 
         [[nodiscard]] const std::vector<Route>& get_routes() const {
@@ -29,10 +47,50 @@ namespace raptor {
             return stop_manager.get_stops();
         }
 
+        /**
+         * Transfers between stops defined by the feed.
+         */
+        [[nodiscard]] const std::vector<StopTransfer>& get_transfers() const {
+            return transfers;
+        }
+
+        /**
+         * Pool storing the IDs and names of the schedule, or null if they are stored in a pool which is not owned by
+         * the schedule. Holding on to the pool keeps handles to its strings valid after the schedule is destroyed.
+         */
+        [[nodiscard]] const std::shared_ptr<const StringPool>& get_string_pool() const noexcept {
+            return string_pool;
+        }
+
+        /**
+         * Memory used by the schedule, including the object itself and its string pool, if it owns one.
+         */
+        [[nodiscard]] MemoryUsage memory_usage() const;
+
+        /**
+         * Hash of the stops, routes and instantiated trips, which is the same whenever the same feeds are loaded for
+         * the same dates. Used to check that data saved for a schedule, such as stop indices, is used with the same
+         * schedule.
+         */
+        [[nodiscard]] std::uint64_t fingerprint() const;
+
     private:
+        /**
+         * Orders routes by the indices of the stops they visit and assigns the indices of the routes and their trips.
+         *
+         * Routes visiting the same stops end up next to each other and, since stops are ordered by location, routes
+         * starting close to each other are also close in memory.
+         */
+        static std::vector<Route> order_routes(std::vector<Route>&& routes);
+
+        // Declared first, so that the strings are freed after every object referring to them
+        std::shared_ptr<const StringPool> string_pool;
         const std::deque<Agency> agencies;
         StopManager stop_manager;
+        // Routes store views to the patterns, so they must be destroyed first.
+        StopPatternStore stop_patterns;
         const std::vector<Route> routes;
+        const std::vector<StopTransfer> transfers;
     };
 }
 
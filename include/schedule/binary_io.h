@@ -0,0 +1,27 @@
+#ifndef PT_ROUTING_BINARY_IO_H
+#define PT_ROUTING_BINARY_IO_H
+#include <istream>
+#include <ostream>
+
+namespace raptor::binary {
+    /**
+     * Writes the bytes of a trivially copyable value. Files written this way can only be read on machines with the
+     * same byte order.
+     */
+    template <typename T>
+    void write_value(std::ostream& output, const T& value) {
+        output.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    /**
+     * Reads a value written by write_value. If reading fails, the stream's fail bit is set.
+     */
+    template <typename T>
+    T read_value(std::istream& input) {
+        auto value = T{};
+        input.read(reinterpret_cast<char*>(&value), sizeof(T));
+        return value;
+    }
+}
+
+#endif //PT_ROUTING_BINARY_IO_H
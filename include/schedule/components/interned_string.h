@@ -0,0 +1,206 @@
+#ifndef PT_ROUTING_INTERNED_STRING_H
+#define PT_ROUTING_INTERNED_STRING_H
+
+#include <array>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <schedule/memory_usage.h>
+
+namespace raptor {
+
+    /**
+     * Handle to a string stored in a StringPool.
+     *
+     * Interning the same string twice in the same pool always returns the same handle, so equality and hashing only
+     * involve the handle itself and never look at the characters. Handles of different pools are compared by their
+     * contents. The handle is the size of a pointer and can be freely copied.
+     *
+     * Ordering compares the string contents, so that handles can be used in ordered containers and produce the same
+     * order as the original strings.
+     */
+    class InternedString {
+        /**
+         * A string stored in a pool, along with the hash of its contents, which is the same in every pool.
+         */
+        struct Entry {
+            std::string_view view;
+            std::size_t hash;
+        };
+
+        // Points to the entry stored inside the pool. A null pointer represents the empty string.
+        const Entry* value = nullptr;
+
+        explicit InternedString(const Entry* value) :
+            value(value) {
+        }
+
+        friend class StringPool;
+
+    public:
+        /**
+         * Creates a handle to the empty string.
+         */
+        InternedString() = default;
+
+        /**
+         * Interns the given string in the current pool of the thread.
+         *
+         * Interning requires a lookup in the pool, so when the same string is used for many objects, intern it once and
+         * copy the handle instead.
+         * @see StringPool::current
+         */
+        explicit InternedString(std::string_view string);
+
+        [[nodiscard]] std::string_view view() const noexcept {
+            return value ? value->view : std::string_view{};
+        }
+
+        [[nodiscard]] bool empty() const noexcept {
+            return value == nullptr;
+        }
+
+        operator std::string_view() const noexcept {
+            return view();
+        }
+
+        friend bool operator==(const InternedString& lhs, const InternedString& rhs) noexcept {
+            if (lhs.value == rhs.value) {
+                return true;
+            }
+            // Strings of the same pool are equal only if their handles are. Different pools can store the same string.
+            return lhs.value && rhs.value && lhs.value->hash == rhs.value->hash && lhs.value->view == rhs.value->view;
+        }
+
+        friend bool operator==(const InternedString& lhs, const std::string_view rhs) noexcept {
+            return lhs.view() == rhs;
+        }
+
+        friend std::strong_ordering operator<=>(const InternedString& lhs, const InternedString& rhs) noexcept {
+            if (lhs.value == rhs.value) {
+                return std::strong_ordering::equal;
+            }
+            return lhs.view() <=> rhs.view();
+        }
+
+        /**
+         * Identifier which is unique among the strings of a pool.
+         */
+        [[nodiscard]] std::uintptr_t id() const noexcept {
+            return reinterpret_cast<std::uintptr_t>(value);
+        }
+
+        /**
+         * Hash of the contents, which is computed when the string is interned.
+         */
+        [[nodiscard]] std::size_t hash() const noexcept {
+            return value ? value->hash : 0;
+        }
+    };
+
+    /**
+     * Stores each distinct string once and hands out InternedString handles to it.
+     *
+     * Characters are copied into large contiguous blocks, which are never moved while the pool exists, so handles
+     * remain valid for the lifetime of the pool. Each Schedule owns the pool its importer interned its strings into,
+     * so the strings are freed together with the schedule.
+     *
+     * Interning is thread-safe. Strings are split into shards by their hash, each with its own lock, so threads
+     * interning different strings rarely wait for each other. Reading the contents of a handle does not access the
+     * pool and requires no locking.
+     */
+    class StringPool {
+        static constexpr std::size_t block_size = 16 * 1024;
+        static constexpr std::size_t n_shards = 16;
+
+        struct Shard {
+            mutable std::mutex mutex;
+            std::vector<std::unique_ptr<char[]>> blocks;
+            std::size_t remaining_in_block = 0;
+            std::size_t reserved_bytes = 0;
+            char* next_free = nullptr;
+            // A deque is used so that the entries, which are pointed to by the handles, are never relocated.
+            std::deque<InternedString::Entry> entries;
+            std::unordered_map<std::string_view, InternedString> index;
+
+            /**
+             * Copies the given string to the arena and returns a view to the copy.
+             */
+            std::string_view store(std::string_view string);
+        };
+
+        std::array<Shard, n_shards> shards;
+
+    public:
+        StringPool() = default;
+        StringPool(const StringPool&) = delete;
+        StringPool& operator=(const StringPool&) = delete;
+
+        /**
+         * Pool used by threads which have not installed a pool of their own, for example for objects created outside
+         * of an importer. It lives until the end of the program.
+         */
+        static StringPool& shared();
+
+        /**
+         * Pool in which InternedString objects created by this thread are interned: the one installed by the innermost
+         * Scope of the thread, or the shared pool if there is none.
+         */
+        static StringPool& current();
+
+        /**
+         * Installs a pool as the current pool of the thread, until the object is destroyed.
+         */
+        class Scope {
+            StringPool* previous;
+
+        public:
+            explicit Scope(StringPool& pool);
+            ~Scope();
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+        };
+
+        /**
+         * Returns the handle for the given string, adding it to the pool if it is not already stored.
+         */
+        InternedString intern(std::string_view string);
+
+        /**
+         * Checks whether the given handle was created by this pool. The empty string belongs to every pool.
+         */
+        [[nodiscard]] bool owns(InternedString string) const;
+
+        /**
+         * Number of distinct strings stored in the pool.
+         */
+        [[nodiscard]] std::size_t size() const;
+
+        /**
+         * Number of bytes reserved for storing the characters of the strings.
+         */
+        [[nodiscard]] std::size_t arena_bytes() const;
+
+        /**
+         * Memory used by the pool, including the stored characters and the index used for finding existing strings.
+         */
+        [[nodiscard]] MemoryUsage memory_usage() const;
+    };
+}
+
+template <>
+struct std::hash<raptor::InternedString> {
+    size_t operator()(const raptor::InternedString& string) const noexcept {
+        return string.hash();
+    }
+};
+
+#endif //PT_ROUTING_INTERNED_STRING_H
@@ -1,51 +1,172 @@
 #ifndef PT_ROUTING_ROUTE_H
 #define PT_ROUTING_ROUTE_H
+#include <algorithm>
+#include <functional>
+#include <span>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 #include <schedule/components/agency.h>
 #include <schedule/components/trip.h>
 
 namespace raptor {
+    /**
+     * Ordered sequence of stops, visited by all trips of a route.
+     */
+    using StopSequence = std::span<const std::reference_wrapper<const Stop>>;
+
+    /**
+     * Stores the stop sequences of all routes in a single contiguous array.
+     *
+     * Each distinct sequence of stops is stored exactly once, even when multiple routes share it. Sequences are
+     * identified by the ID returned when adding them, since the storage might be relocated while sequences are being
+     * added. Once all sequences have been added, views to them remain valid for the lifetime of the object, even if it
+     * is moved.
+     */
+    class StopPatternStore {
+    public:
+        using PatternId = std::size_t;
+
+    private:
+        std::vector<std::reference_wrapper<const Stop>> stops;
+        /**
+         * Offset and length of each pattern inside the stops vector.
+         */
+        std::vector<std::pair<std::size_t, std::size_t>> patterns;
+        /**
+         * Patterns with the given hash. Used for finding existing patterns when adding new ones.
+         */
+        std::unordered_map<std::size_t, std::vector<PatternId>> patterns_by_hash;
+
+    public:
+        StopPatternStore() = default;
+
+        StopPatternStore(const StopPatternStore&) = delete;
+        StopPatternStore& operator=(const StopPatternStore&) = delete;
+        StopPatternStore(StopPatternStore&&) noexcept = default;
+        StopPatternStore& operator=(StopPatternStore&&) noexcept = default;
+
+        /**
+         * Adds the given sequence of stops, unless an identical sequence is already stored.
+         * @return ID of the stored sequence.
+         */
+        PatternId add(StopSequence sequence);
+
+        /**
+         * Returns a view of the stored sequence with the given ID.
+         *
+         * The view is invalidated when more sequences are added.
+         * @throw std::out_of_range If there is no sequence with the given ID.
+         */
+        [[nodiscard]] StopSequence get(PatternId pattern_id) const;
+
+        /**
+         * Number of distinct sequences stored.
+         */
+        [[nodiscard]] std::size_t size() const noexcept {
+            return patterns.size();
+        }
+
+        [[nodiscard]] MemoryUsage memory_usage() const;
+
+        /**
+         * Calculates a hash for the given sequence of stops, using the stops' indices.
+         */
+        static std::size_t hash(StopSequence sequence);
+    };
+
     /**
      * A route is a collection of trips, which stop at exactly the same stops, in the same order, and have the same
      * GTFS route ID.
      */
     class Route {
         std::vector<Trip> trips;
-        std::string short_name;
-        std::string long_name;
-        std::string gtfs_id;
+        StopSequence stops;
+        bool fifo;
+        InternedString short_name;
+        InternedString long_name;
+        InternedString gtfs_id;
         std::reference_wrapper<const Agency> agency;
+        std::size_t index = 0;
+
+        friend class Schedule;
 
     public:
-        Route(std::vector<Trip>&& trips, std::string short_name,
-              std::string long_name, std::string gtfs_id, const Agency& agency) :
+        /**
+         * @param trips Trips of the route.
+         * @param stop_sequence Stops visited by all the trips. The route stores a view, so the sequence must outlive
+         * the object. Usually the sequence is stored in a StopPatternStore.
+         * @throw std::invalid_argument If the number of stops in the sequence is different from the number of stop
+         * times in the trips.
+         */
+        Route(std::vector<Trip>&& trips, const StopSequence stop_sequence, const std::string_view short_name,
+              const std::string_view long_name, const std::string_view gtfs_id, const Agency& agency) :
             trips(std::move(trips)),
-            short_name(std::move(short_name)),
-            long_name(std::move(long_name)),
-            gtfs_id(std::move(gtfs_id)),
+            stops(stop_sequence),
+            short_name(short_name),
+            long_name(long_name),
+            gtfs_id(gtfs_id),
             agency(std::cref(agency)) {
+            for (const auto& trip : this->trips) {
+                if (trip.get_stop_times().size() != stops.size()) {
+                    throw std::invalid_argument("All trips of a route must visit the stops of its stop sequence");
+                }
+            }
+            fifo = std::ranges::adjacent_find(this->trips, std::not_fn(never_overtakes)) == this->trips.end();
         }
 
         [[nodiscard]] const std::vector<Trip>& get_trips() const {
             return trips;
         }
 
-        [[nodiscard]] const std::string& get_short_name() const {
+        [[nodiscard]] InternedString get_short_name() const {
             return short_name;
         }
 
-        [[nodiscard]] const std::string& get_long_name() const {
+        [[nodiscard]] InternedString get_long_name() const {
             return long_name;
         }
 
-        [[nodiscard]] const std::string& get_gtfs_id() const {
+        [[nodiscard]] InternedString get_gtfs_id() const {
             return gtfs_id;
         }
 
+        /**
+         * Position of the route in the Schedule which owns it. Indices are dense, so they can be used to store
+         * information about routes in arrays instead of hash maps.
+         *
+         * Routes which are not owned by a Schedule have an index of 0.
+         */
+        [[nodiscard]] std::size_t get_index() const noexcept {
+            return index;
+        }
+
+        /**
+         * Checks if the trips of the route are in first-in-first-out order, meaning that no trip arrives at or departs
+         * from any stop before a trip preceding it in the route.
+         *
+         * For FIFO routes, the trips are sorted by their departure time at every stop, so binary search can be used
+         * to find the earliest trip from any stop.
+         */
+        [[nodiscard]] bool is_fifo() const noexcept {
+            return fifo;
+        }
+
+        /**
+         * Checks that the later trip does not arrive at or depart from any stop before the earlier trip.
+         * Both trips must visit the same stops.
+         */
+        static bool never_overtakes(const Trip& earlier, const Trip& later);
+
         friend bool operator==(const Route& lhs, const Route& rhs) {
-            return lhs.trips == rhs.trips && lhs.gtfs_id == rhs.gtfs_id;
+            // Routes of a schedule differ in their index, so their trips are only compared for routes which are not
+            // owned by a schedule
+            if (&lhs == &rhs) {
+                return true;
+            }
+            return lhs.index == rhs.index && lhs.gtfs_id == rhs.gtfs_id && lhs.trips == rhs.trips;
         }
 
         friend bool operator!=(const Route& lhs, const Route& rhs) {
@@ -53,22 +174,40 @@ namespace raptor {
         }
 
         /**
-         * Return an ordered vector of the stops this route passes through.
+         * Return an ordered view of the stops this route passes through.
          * All trips in a route have the same stop sequence.
          */
-        [[nodiscard]] std::vector<std::reference_wrapper<const Stop>> stop_sequence() const;
+        [[nodiscard]] StopSequence stop_sequence() const noexcept {
+            return stops;
+        }
 
         [[nodiscard]] size_t hash() const;
 
-        static size_t hash(const std::vector<std::reference_wrapper<const Stop>>& stops,
-                           const std::string& gtfs_route_id);
+        /**
+         * Memory owned by the route, consisting of its trips and their stop times. The stop sequence is owned by a
+         * StopPatternStore and is not included.
+         */
+        [[nodiscard]] MemoryUsage memory_usage() const;
+
+        static size_t hash(StopSequence stops, InternedString gtfs_route_id);
     };
+
+    /**
+     * Splits the given trips into groups in which no trip overtakes another, so that each group can form a FIFO
+     * route.
+     *
+     * Trips are assigned greedily to the first group they do not overtake, so the number of groups is kept low.
+     * @param trips Trips visiting the same stops, sorted by departure time from the first stop.
+     * @return Groups of trips, each sorted by departure time. If no trip overtakes another, a single group is
+     * returned.
+     */
+    std::vector<std::vector<Trip>> split_into_fifo_groups(std::vector<Trip>&& trips);
 }
 
 template <>
 struct std::hash<raptor::Route> {
     size_t operator()(const raptor::Route& route) const noexcept {
-        return std::hash<std::string>{}(route.get_gtfs_id());
+        return std::hash<std::size_t>{}(route.get_index());
     }
 };
 
@@ -1,9 +1,14 @@
 #ifndef PT_ROUTING_STOP_H
 #define PT_ROUTING_STOP_H
 
+#include <cstddef>
 #include <deque>
+#include <string_view>
 #include <unordered_map>
 
+#include <schedule/components/interned_string.h>
+#include <schedule/memory_usage.h>
+
 namespace raptor {
 
     class Station;
@@ -17,8 +22,8 @@ namespace raptor {
      */
     class BaseStop {
 
-        std::string name;
-        std::string gtfs_id;
+        InternedString name;
+        InternedString gtfs_id;
 
         struct {
             double latitude;
@@ -26,18 +31,19 @@ namespace raptor {
         } coordinates;
 
     public:
-        BaseStop(std::string name, std::string gtfs_id, const double latitude, const double longitude) :
-            name(std::move(name)),
-            gtfs_id(std::move(gtfs_id)),
+        BaseStop(const std::string_view name, const std::string_view gtfs_id, const double latitude,
+                 const double longitude) :
+            name(name),
+            gtfs_id(gtfs_id),
             coordinates({latitude, longitude}) {
 
         }
 
-        [[nodiscard]] const std::string& get_name() const {
+        [[nodiscard]] InternedString get_name() const {
             return name;
         }
 
-        [[nodiscard]] const std::string& get_gtfs_id() const {
+        [[nodiscard]] InternedString get_gtfs_id() const {
             return gtfs_id;
         }
 
@@ -60,20 +66,26 @@ namespace raptor {
 
     class Stop : public BaseStop {
         const Station* parent_station = nullptr;
-        std::string platform_code;
+        InternedString platform_code;
         std::vector<BoardingArea> boarding_areas;
+        std::size_t index = 0;
 
         void set_parent_station(const Station* station) {
             parent_station = station;
         }
 
+        void set_index(const std::size_t new_index) {
+            index = new_index;
+        }
+
         friend class StopManager;
 
     public:
-        Stop(std::string name, std::string gtfs_id, const double latitude, const double longitude,
-             std::string platform_code, std::vector<BoardingArea>&& boarding_areas) :
-            BaseStop(std::move(name), std::move(gtfs_id), latitude, longitude),
-            platform_code(std::move(platform_code)),
+        Stop(const std::string_view name, const std::string_view gtfs_id, const double latitude,
+             const double longitude, const std::string_view platform_code,
+             std::vector<BoardingArea>&& boarding_areas) :
+            BaseStop(name, gtfs_id, latitude, longitude),
+            platform_code(platform_code),
             boarding_areas(std::move(boarding_areas)) {
         }
 
@@ -84,9 +96,36 @@ namespace raptor {
             return std::nullopt;
         }
 
-        [[nodiscard]] const std::string& get_platform_code() const {
+        [[nodiscard]] InternedString get_platform_code() const {
             return platform_code;
         }
+
+        /**
+         * Position of the stop in the StopManager which owns it. Indices are dense, so they can be used to store
+         * information about stops in arrays instead of hash maps.
+         *
+         * Stops which are not owned by a StopManager have an index of 0.
+         */
+        [[nodiscard]] std::size_t get_index() const noexcept {
+            return index;
+        }
+
+        friend bool operator==(const Stop& lhs, const Stop& rhs) {
+            // Stops of a StopManager differ in their index. The GTFS ID distinguishes stops which are not owned by one.
+            return lhs.index == rhs.index && lhs.get_gtfs_id() == rhs.get_gtfs_id();
+        }
+
+        friend bool operator!=(const Stop& lhs, const Stop& rhs) {
+            return !(lhs == rhs);
+        }
+
+        /**
+         * Heap memory owned by the stop. The name and IDs are stored in the StringPool of the schedule and are not
+         * included.
+         */
+        [[nodiscard]] std::size_t heap_bytes() const noexcept {
+            return memory::heap_bytes(boarding_areas);
+        }
     };
 
     /**
@@ -95,8 +134,8 @@ namespace raptor {
     class Station {
         std::vector<std::reference_wrapper<const Stop>> stops;
         std::vector<StationEntrance> entrances = {};
-        std::string gtfs_id;
-        std::string name;
+        InternedString gtfs_id;
+        InternedString name;
 
         void add_child_stop(const Stop& stop) {
             stops.emplace_back(std::cref(stop));
@@ -106,24 +145,32 @@ namespace raptor {
         friend class StopManager;
 
     public:
-        Station(std::string name, std::string gtfs_id,
+        Station(const std::string_view name, const std::string_view gtfs_id,
                 std::vector<StationEntrance>&& entrances,
                 std::vector<std::reference_wrapper<const Stop>>&& stops = {}) :
             stops(std::move(stops)), entrances(std::move(entrances)),
-            gtfs_id(std::move(gtfs_id)), name(std::move(name)) {
+            gtfs_id(gtfs_id), name(name) {
         }
 
-        [[nodiscard]] const std::string& get_gtfs_id() const {
+        [[nodiscard]] InternedString get_gtfs_id() const {
             return gtfs_id;
         }
 
-        [[nodiscard]] const std::string& get_name() const {
+        [[nodiscard]] InternedString get_name() const {
             return name;
         }
 
         [[nodiscard]] const std::vector<std::reference_wrapper<const Stop>>& get_stops() const {
             return stops;
         }
+
+        /**
+         * Heap memory owned by the station. The name and ID are stored in the StringPool of the schedule and are not
+         * included.
+         */
+        [[nodiscard]] std::size_t heap_bytes() const noexcept {
+            return memory::heap_bytes(stops) + memory::heap_bytes(entrances);
+        }
     };
 
     /**
@@ -158,11 +205,18 @@ namespace raptor {
 
         void initialise_relationships(const StationToChildStopsMap& stops_per_station);
 
+        /**
+         * Orders the stops along a Hilbert curve, so that stops which are close to each other are also close in
+         * memory, and assigns their indices.
+         */
+        void order_stops();
+
     public:
         /**
          * Initialise the stop manager with the given stops and stations. The manager takes ownership of the objects
          * and initialises the parent/child relationship according to the given map.
-         * @param stops Stops to be used by the manager
+         * @param stops Stops to be used by the manager. They are reordered by location, so their order is not
+         * preserved.
          * @param stations
          * @param stops_per_station Map matching a parent station GTFS ID to multiple child station GTFS IDs
          * @throws std::out_of_range If the GTFS ID of a stop or station in stops_per_station does not correspond
@@ -171,6 +225,7 @@ namespace raptor {
         StopManager(std::deque<Stop>&& stops, std::vector<Station>&& stations,
                     const StationToChildStopsMap& stops_per_station) :
             stops(std::move(stops)), stations(std::move(stations)) {
+            order_stops();
             initialise_relationships(stops_per_station);
         }
 
@@ -197,6 +252,8 @@ namespace raptor {
             return stations;
         }
 
+        [[nodiscard]] MemoryUsage memory_usage() const;
+
     };
 }
 
@@ -204,7 +261,7 @@ template<typename T>
 requires std::is_convertible_v<T, const raptor::Station&>
 struct std::hash<T> {
     size_t operator()(const raptor::Station& station) const noexcept {
-        return std::hash<std::string>{}(station.get_gtfs_id());
+        return std::hash<raptor::InternedString>{}(station.get_gtfs_id());
     }
 };
 
@@ -219,7 +276,7 @@ template <typename T>
 requires std::is_convertible_v<T, const raptor::Stop&>
 struct std::hash<T> {
     size_t operator()(const raptor::Stop& stop) const noexcept {
-        return std::hash<std::string>{}(stop.get_gtfs_id());
+        return std::hash<std::size_t>{}(stop.get_index());
     }
 };
 
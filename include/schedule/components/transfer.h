@@ -0,0 +1,45 @@
+#ifndef PT_ROUTING_TRANSFER_H
+#define PT_ROUTING_TRANSFER_H
+
+#include <chrono>
+#include <functional>
+
+#include <schedule/components/stop.h>
+
+namespace raptor {
+    /**
+     * A transfer between two stops defined by the feed.
+     *
+     * Transfers defined by the feed take precedence over transfers calculated from the locations of the stops.
+     */
+    struct StopTransfer {
+        enum class Type {
+            /**
+             * The transfer is possible and takes as long as walking between the stops.
+             */
+            Recommended,
+            /**
+             * The departing vehicle waits for the arriving one, so the transfer takes no time.
+             */
+            Timed,
+            /**
+             * The transfer takes the given minimum transfer time.
+             */
+            MinimumTime,
+            /**
+             * The transfer is not possible.
+             */
+            NotPossible
+        };
+
+        std::reference_wrapper<const Stop> from;
+        std::reference_wrapper<const Stop> to;
+        Type type;
+        /**
+         * Used only for transfers of the MinimumTime type.
+         */
+        std::chrono::seconds min_transfer_time = std::chrono::seconds{0};
+    };
+}
+
+#endif //PT_ROUTING_TRANSFER_H
@@ -5,6 +5,8 @@
 #include <schedule/components/stop.h>
 
 namespace raptor {
+    class Schedule;
+
     using Time = std::chrono::zoned_seconds;
     /**
      * An instance of a specific vehicle arriving and departing from a stop.
@@ -79,8 +81,11 @@ namespace raptor {
      */
     class Trip {
         std::vector<StopTime> stop_times; /**< Stop times are completely owned by the trip */
-        std::string trip_gtfs_id;
-        std::string shape_gtfs_id;
+        InternedString trip_gtfs_id;
+        InternedString shape_gtfs_id;
+        std::size_t index = 0;
+
+        friend class Schedule;
 
     public:
         /**
@@ -91,28 +96,50 @@ namespace raptor {
          * @param shape_gtfs_id GTFS ID of the shape describing the trip
          * @throw std::invalid_argument If a Trip is constructed without any stop times.
          */
-        Trip(std::vector<StopTime>&& stop_times, std::string trip_gtfs_id,
-             std::string shape_gtfs_id) :
+        Trip(std::vector<StopTime>&& stop_times, const InternedString trip_gtfs_id,
+             const InternedString shape_gtfs_id) :
             stop_times(std::move(stop_times)),
-            trip_gtfs_id(std::move(trip_gtfs_id)),
-            shape_gtfs_id(std::move(shape_gtfs_id)) {
+            trip_gtfs_id(trip_gtfs_id),
+            shape_gtfs_id(shape_gtfs_id) {
             if (this->stop_times.empty()) {
                 throw std::invalid_argument("Trip must have at least one StopTime");
             }
         }
 
+        /**
+         * Creates a new Trip object, interning the given IDs.
+         *
+         * When creating multiple instances of the same GTFS trip, prefer interning the IDs once and using the
+         * constructor accepting InternedString objects.
+         */
+        Trip(std::vector<StopTime>&& stop_times, const std::string_view trip_gtfs_id,
+             const std::string_view shape_gtfs_id) :
+            Trip(std::move(stop_times), InternedString(trip_gtfs_id), InternedString(shape_gtfs_id)) {
+        }
+
         [[nodiscard]] const std::vector<StopTime>& get_stop_times() const {
             return stop_times;
         }
 
-        [[nodiscard]] const std::string& get_trip_gtfs_id() const {
+        [[nodiscard]] InternedString get_trip_gtfs_id() const {
             return trip_gtfs_id;
         }
 
-        [[nodiscard]] const std::string& get_shape_gtfs_id() const {
+        [[nodiscard]] InternedString get_shape_gtfs_id() const {
             return shape_gtfs_id;
         }
 
+        /**
+         * Position of the trip among the trips of the Schedule which owns it, counting the trips of each route in the
+         * order of the routes. Indices are dense, so they can be used to store information about trips in arrays
+         * instead of hash maps.
+         *
+         * Trips which are not owned by a Schedule have an index of 0.
+         */
+        [[nodiscard]] std::size_t get_index() const noexcept {
+            return index;
+        }
+
         /**
          * Get the stop time object at the given sequence
          * @param index Sequence of the stop
@@ -125,8 +152,10 @@ namespace raptor {
         }
 
         friend bool operator==(const Trip& lhs, const Trip& rhs) {
-            // Also use the departure time, since a GTFS trip maps to multiple raptor trips
-            return lhs.trip_gtfs_id == rhs.trip_gtfs_id && lhs.departure_time() == rhs.departure_time();
+            // Trips of a schedule differ in their index. The rest only distinguishes trips which are not owned by a
+            // schedule. Also use the departure time, since a GTFS trip maps to multiple raptor trips.
+            return lhs.index == rhs.index && lhs.trip_gtfs_id == rhs.trip_gtfs_id &&
+                    lhs.departure_time() == rhs.departure_time();
         }
 
         friend bool operator!=(const Trip& lhs, const Trip& rhs) {
@@ -143,4 +172,18 @@ namespace raptor {
     };
 }
 
+template <>
+struct std::hash<raptor::Trip> {
+    size_t operator()(const raptor::Trip& trip) const noexcept {
+        return std::hash<std::size_t>{}(trip.get_index());
+    }
+};
+
+template <>
+struct std::hash<std::reference_wrapper<const raptor::Trip>> {
+    size_t operator()(const raptor::Trip& trip) const noexcept {
+        return std::hash<raptor::Trip>{}(trip);
+    }
+};
+
 #endif //PT_ROUTING_TRIP_H
@@ -1,14 +1,21 @@
 #ifndef GTFS_H
 #define GTFS_H
 
+#include <functional>
+#include <string>
 #include <unordered_map>
+#include <vector>
 
 #include <just_gtfs/just_gtfs.h>
 
 #include "Schedule.h"
+#include "import_stats.h"
 
 namespace raptor::gtfs {
-    using stop_id = std::string;
+    /**
+     * Stop IDs are views of the interned IDs of the stops, so they can be used as keys without copying the strings.
+     */
+    using stop_id = std::string_view;
 
     /**
      * Maps an entity's ID to a reference wrapper of the given type.
@@ -42,6 +49,21 @@ namespace raptor::gtfs {
     */
     StopManager from_gtfs(::gtfs::Stops&& gtfs_stops);
 
+    /**
+     * Creates transfers between stops from the GTFS transfers and pathways.
+     *
+     * Transfers referring to a station apply to all of its stops. For each pair of stops connected through pathways,
+     * a transfer with the duration of the fastest connection is created, unless the pair is also in the transfers.
+     * Pathways without a traversal time or a length are ignored.
+     * @param stop_index Map from the stop IDs used in the feed to the stops.
+     * @param station_index Map from the station IDs used in the feed to the stations.
+     * @return Transfers between the stops of the given indexes. Transfers referring to other locations, such as
+     * entrances, are ignored.
+     */
+    std::vector<StopTransfer> from_gtfs(const ::gtfs::Transfers& gtfs_transfers, const ::gtfs::Pathways& pathways,
+                                        const reference_index<stop_id, const Stop>& stop_index,
+                                        const reference_index<stop_id, const Station>& station_index);
+
     /**
      * Creates Service objects from GTFS calendar and calendar_dates.
      * @return Map of the GTFS service_id to the corresponding Service object. A map is returned for faster searching.
@@ -53,6 +75,45 @@ namespace raptor::gtfs {
                                                        const std::optional<std::chrono::year_month_day>& to_date =
                                                                std::nullopt);
 
+    /**
+     * Converts GTFS times of a single service day to time points in a specific time zone.
+     *
+     * The UTC offsets in effect around the service day, including any daylight saving time transitions, are looked up
+     * once when the object is constructed. Converting a time then only requires integer arithmetic, instead of a
+     * time zone database lookup for every stop time.
+     */
+    class ServiceDayTimeConverter {
+        struct OffsetInterval {
+            std::chrono::sys_seconds begin;
+            std::chrono::sys_seconds end;
+            std::chrono::seconds offset;
+        };
+
+        std::chrono::local_seconds service_day_start;
+        const std::chrono::time_zone* time_zone;
+        std::vector<OffsetInterval> offset_intervals;
+
+    public:
+        /**
+         * @param service_day Day for which times will be converted.
+         * @param time_zone Time zone of the converted times.
+         */
+        ServiceDayTimeConverter(const std::chrono::year_month_day& service_day,
+                                const std::chrono::time_zone* time_zone);
+
+        /**
+         * Converts a time relative to the start of the service day. When the local time is ambiguous the earliest
+         * time is chosen, and when it does not exist the time of the transition is used.
+         * @param since_service_day_start Time elapsed since 00:00 of the service day. Can be longer than 24 hours.
+         */
+        [[nodiscard]] Time to_time(Time::duration since_service_day_start) const;
+
+        /**
+         * Converts the given GTFS time, which is relative to the start of the service day.
+         */
+        [[nodiscard]] Time to_time(const ::gtfs::Time& gtfs_time) const;
+    };
+
     /**
      * Creates an instantiation of a stop time, from a generic GTFS stop_time.
      *
@@ -70,6 +131,18 @@ namespace raptor::gtfs {
                        const std::chrono::time_zone* time_zone,
                        const Stop& stop);
 
+    /**
+     * Creates an instantiation of a stop time, using precomputed time zone information for the service day.
+     *
+     * Prefer this overload when instantiating many stop times on the same service day.
+     * @param stop_time The ``gtfs::StopTime`` object, containing departure and arrival times, without any specified
+     * date.
+     * @param converter Converter for the service day of the created stop time.
+     * @param stop A reference to the stop in the given ``stop_time`` object.
+     */
+    StopTime from_gtfs(const ::gtfs::StopTime& stop_time, const ServiceDayTimeConverter& converter,
+                       const Stop& stop);
+
     /**
      * Construct a Schedule from a GTFS feed. The schedule instantiates and creates specific trips for all the dates
      * in the given date range.
@@ -77,11 +150,66 @@ namespace raptor::gtfs {
      * @param feed GTFS feed. The read_feed method must have been already called.
      * @param from_date Trips occurring on and after this date will be instantiated.
      * @param to_date Trips occurring on and before this date will be instantiated.
+     * @param stats If given, it is filled with the time and memory taken by each phase of the import and the number
+     * of objects created.
      * @return
      */
     Schedule from_gtfs(const ::gtfs::Feed& feed,
                        const std::optional<std::chrono::year_month_day>& from_date = std::nullopt,
-                       const std::optional<std::chrono::year_month_day>& to_date = std::nullopt);
+                       const std::optional<std::chrono::year_month_day>& to_date = std::nullopt,
+                       ImportStats* stats = nullptr);
+
+    /**
+     * A GTFS feed which has already been read, along with the prefix added to its IDs.
+     *
+     * IDs are only unique inside a single feed, so when multiple feeds are merged, the IDs of stops, agencies,
+     * routes, trips and shapes of each feed are prefixed with a string unique to the feed.
+     */
+    struct NamespacedFeed {
+        std::reference_wrapper<const ::gtfs::Feed> feed;
+        std::string id_prefix;
+    };
+
+    /**
+     * Location of a GTFS feed on disk, along with the prefix added to its IDs.
+     * @see NamespacedFeed
+     */
+    struct FeedSource {
+        std::string path;
+        std::string id_prefix;
+    };
+
+    /**
+     * Construct a single Schedule from multiple GTFS feeds.
+     *
+     * The trips of each feed are instantiated in parallel, using the time zone of that feed. Stops of all feeds are
+     * stored in the same StopManager, so building a TransferManager on the resulting schedule also creates footpaths
+     * between stops of different feeds.
+     * @param feeds GTFS feeds and their ID prefixes. The read_feed method must have been already called. The prefixes
+     * should be unique, otherwise objects with the same ID in different feeds will be mixed up.
+     * @param from_date Trips occurring on and after this date will be instantiated.
+     * @param to_date Trips occurring on and before this date will be instantiated.
+     * @param stats If given, it is filled with the time and memory taken by each phase of the import and the number
+     * of objects created. The feeds are then processed one at a time, so that the memory of each phase is measured
+     * without the other feeds.
+     * @throw std::invalid_argument If no feeds are given.
+     */
+    Schedule from_gtfs(const std::vector<NamespacedFeed>& feeds,
+                       const std::optional<std::chrono::year_month_day>& from_date = std::nullopt,
+                       const std::optional<std::chrono::year_month_day>& to_date = std::nullopt,
+                       ImportStats* stats = nullptr);
+
+    /**
+     * Reads the given GTFS feeds in parallel and merges them into a single Schedule.
+     * @see from_gtfs(const std::vector<NamespacedFeed>&, const std::optional<std::chrono::year_month_day>&, const std::optional<std::chrono::year_month_day>&)
+     * @param stats If given, it is also filled with the time taken to parse the feeds, which are still read in
+     * parallel.
+     * @throw std::runtime_error If any of the feeds cannot be read.
+     */
+    Schedule from_gtfs(const std::vector<FeedSource>& sources,
+                       const std::optional<std::chrono::year_month_day>& from_date = std::nullopt,
+                       const std::optional<std::chrono::year_month_day>& to_date = std::nullopt,
+                       ImportStats* stats = nullptr);
 
 }
 
@@ -0,0 +1,126 @@
+#ifndef PT_ROUTING_IMPORT_STATS_H
+#define PT_ROUTING_IMPORT_STATS_H
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "schedule/memory_usage.h"
+
+namespace raptor {
+    /**
+     * Time and memory taken by a phase of the GTFS import.
+     */
+    struct ImportPhase {
+        std::string name;
+        std::chrono::nanoseconds wall_time{};
+        /**
+         * Change of the heap memory in use during the phase. Negative if the phase freed more memory than it
+         * allocated. Always 0 when the allocator does not report its usage.
+         * @see memory::heap_bytes_in_use
+         */
+        std::int64_t heap_growth = 0;
+    };
+
+    /**
+     * Phase timings, memory and object counts of a GTFS import, filled by gtfs::from_gtfs.
+     */
+    struct ImportStats {
+        /**
+         * Phases in the order they first ran. Phases which run once for every feed are summed over the feeds.
+         */
+        std::vector<ImportPhase> phases;
+        /**
+         * Peak resident set size of the process at the end of the import, which includes any memory used before it.
+         */
+        std::size_t peak_resident_bytes = 0;
+
+        std::size_t agencies = 0;
+        std::size_t stops = 0;
+        std::size_t stations = 0;
+        std::size_t services = 0;
+        /**
+         * Trips instantiated for each of their service days.
+         */
+        std::size_t trips = 0;
+        std::size_t stop_times = 0;
+        std::size_t routes = 0;
+        std::size_t stop_patterns = 0;
+        std::size_t transfers = 0;
+
+        /**
+         * Sum of the wall time of all phases.
+         */
+        [[nodiscard]] std::chrono::nanoseconds total_wall_time() const noexcept;
+
+        /**
+         * Prints a table with the phases, followed by the object counts and the peak memory.
+         */
+        friend std::ostream& operator<<(std::ostream& os, const ImportStats& stats);
+    };
+
+    /**
+     * Records the phases of an import into an ImportStats object, if one is given. Otherwise, the phases are run
+     * without measuring them.
+     */
+    class ImportStatsRecorder {
+        ImportStats* stats;
+
+        /**
+         * Adds the measurements to the phase with the given name, creating it if needed.
+         */
+        void add_phase(std::string_view name, std::chrono::nanoseconds wall_time, std::int64_t heap_growth) const;
+
+    public:
+        explicit ImportStatsRecorder(ImportStats* stats) noexcept :
+            stats(stats) {
+            if (stats != nullptr) {
+                *stats = ImportStats{};
+            }
+        }
+
+        [[nodiscard]] bool recording() const noexcept {
+            return stats != nullptr;
+        }
+
+        /**
+         * Sets a counter of the statistics.
+         * @param counter Pointer to the counter, for example &ImportStats::trips.
+         */
+        void set(std::size_t ImportStats::* counter, const std::size_t value) const noexcept {
+            if (recording()) {
+                stats->*counter = value;
+            }
+        }
+
+        /**
+         * Runs the given function and adds its wall time and heap growth to a phase. Measurements of phases which run
+         * on several threads at once include the memory allocated by the other threads.
+         * @return Value returned by the function.
+         */
+        template <typename F>
+        decltype(auto) measure(const std::string_view phase, F&& function) const {
+            if (!recording()) {
+                return function();
+            }
+            struct AddPhase {
+                const ImportStatsRecorder& recorder;
+                std::string_view phase;
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                std::size_t start_heap = memory::heap_bytes_in_use();
+
+                ~AddPhase() {
+                    const auto heap = memory::heap_bytes_in_use();
+                    recorder.add_phase(phase, std::chrono::steady_clock::now() - start,
+                                       static_cast<std::int64_t>(heap) - static_cast<std::int64_t>(start_heap));
+                }
+            } add_phase{*this, phase};
+            return function();
+        }
+    };
+}
+
+#endif //PT_ROUTING_IMPORT_STATS_H
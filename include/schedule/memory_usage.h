@@ -0,0 +1,110 @@
+#ifndef PT_ROUTING_MEMORY_USAGE_H
+#define PT_ROUTING_MEMORY_USAGE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace raptor {
+    /**
+     * Breakdown of the memory used by an object and the objects it owns.
+     *
+     * Each part reports the bytes it uses directly, including the heap memory of its containers, and the breakdown of
+     * its sub-parts. The memory of the object itself is counted by its owner, except for the top level report.
+     */
+    struct MemoryUsage {
+        std::string name;
+        /**
+         * Bytes used by this part, excluding its sub-parts.
+         */
+        std::size_t bytes = 0;
+        std::vector<MemoryUsage> parts = {};
+
+        /**
+         * Bytes used by this part and all its sub-parts.
+         */
+        [[nodiscard]] std::size_t total_bytes() const;
+
+        /**
+         * Adds a sub-part using the given number of bytes.
+         * @return Reference to the added part.
+         */
+        MemoryUsage& add(std::string part_name, std::size_t part_bytes);
+
+        /**
+         * Adds the given report as a sub-part.
+         * @return Reference to the added part.
+         */
+        MemoryUsage& add(MemoryUsage part);
+
+        /**
+         * Adds the bytes of the other report to this one. Sub-parts with the same name are merged, so that reports
+         * of many objects of the same type can be summed up.
+         */
+        MemoryUsage& operator+=(const MemoryUsage& other);
+
+        /**
+         * Prints the report as an indented tree, one part per line.
+         */
+        friend std::ostream& operator<<(std::ostream& os, const MemoryUsage& usage);
+    };
+
+    /**
+     * Functions calculating the heap memory owned by standard library containers.
+     *
+     * Only the memory of the container is counted, not the heap memory owned by its elements.
+     * Node based containers are estimated based on the layout of libstdc++, without any allocator overhead.
+     */
+    namespace memory {
+        template <typename T>
+        std::size_t heap_bytes(const std::vector<T>& vector) noexcept {
+            return vector.capacity() * sizeof(T);
+        }
+
+        /**
+         * Strings short enough to be stored inside the object do not use any heap memory.
+         */
+        inline std::size_t heap_bytes(const std::string& string) noexcept {
+            const auto* object = reinterpret_cast<const char*>(&string);
+            const auto* data = string.data();
+            if (data >= object && data < object + sizeof(std::string)) {
+                return 0;
+            }
+            return string.capacity() + 1;
+        }
+
+        template <typename T>
+        std::size_t heap_bytes(const std::deque<T>& deque) noexcept {
+            // Elements are stored in blocks of 512 bytes and a map contains pointers to the blocks
+            constexpr auto elements_per_block = sizeof(T) < 512 ? 512 / sizeof(T) : 1;
+            const auto n_blocks = deque.size() / elements_per_block + 1;
+            const auto map_size = std::max<std::size_t>(8, n_blocks + 2);
+            return n_blocks * elements_per_block * sizeof(T) + map_size * sizeof(T*);
+        }
+
+        template <typename K, typename V, typename Hash, typename Equal>
+        std::size_t heap_bytes(const std::unordered_map<K, V, Hash, Equal>& map) noexcept {
+            // Each node stores a pointer to the next node, the value and the cached hash code
+            using value_type = typename std::unordered_map<K, V, Hash, Equal>::value_type;
+            constexpr auto node_size = sizeof(void*) + sizeof(value_type) + sizeof(std::size_t);
+            return map.bucket_count() * sizeof(void*) + map.size() * node_size;
+        }
+
+        /**
+         * Bytes of heap memory currently allocated by the process, as reported by the allocator. Only available with
+         * the GNU C library, returns 0 elsewhere.
+         */
+        [[nodiscard]] std::size_t heap_bytes_in_use() noexcept;
+
+        /**
+         * Largest resident set size the process has reached so far. Returns 0 on platforms where it is not available.
+         */
+        [[nodiscard]] std::size_t peak_resident_bytes() noexcept;
+    }
+}
+
+#endif //PT_ROUTING_MEMORY_USAGE_H
@@ -0,0 +1,87 @@
+#ifndef PT_ROUTING_SYNTHETIC_H
+#define PT_ROUTING_SYNTHETIC_H
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include <just_gtfs/just_gtfs.h>
+
+#include "Schedule.h"
+
+/**
+ * Generates synthetic transit networks, used as reproducible inputs for benchmarks and memory tests.
+ */
+namespace raptor::synthetic {
+    enum class Topology {
+        /**
+         * Routes run along the rows and columns of a square grid of locations, crossing each other.
+         */
+        Grid,
+        /**
+         * Routes run outwards from a single hub in the centre of the network.
+         */
+        Radial
+    };
+
+    struct NetworkParameters {
+        Topology topology = Topology::Grid;
+        std::size_t n_routes = 10;
+        std::size_t stops_per_route = 20;
+        /**
+         * Distance between consecutive stops of a route, which sets the density of the stops.
+         */
+        double stop_spacing_km = 0.5;
+        /**
+         * Number of locations along each side of the grid. If 0, it is equal to the number of stops per route.
+         * Larger grids spread the routes over a larger area, so fewer routes cross each other.
+         */
+        std::size_t grid_size = 0;
+        /**
+         * Number of stops in the station of each location. If more than one, each location becomes a station and
+         * routes serving the same location stop at different stops of the station.
+         */
+        std::size_t stops_per_station = 1;
+        std::chrono::minutes headway{10};
+        /**
+         * Trips depart from the first stop of their route between these times of the day.
+         */
+        std::chrono::minutes first_departure{6 * 60};
+        std::chrono::minutes last_departure{22 * 60};
+        double speed_km_h = 30.0;
+        std::chrono::year_month_day start_date{std::chrono::year{2025}, std::chrono::September, std::chrono::day{1}};
+        std::size_t service_days = 7;
+        /**
+         * Coordinates of the centre of the network.
+         */
+        double latitude = 59.33;
+        double longitude = 18.06;
+        std::string time_zone = "Europe/Stockholm";
+        /**
+         * Seed for the positions of the grid routes and the times of the first trip of each route. The same
+         * parameters always generate the same network.
+         */
+        std::uint64_t seed = 1;
+    };
+
+    /**
+     * Generates a GTFS feed for the network. Every route has trips in both directions, running every day of the
+     * service period.
+     * @throw std::invalid_argument If the parameters are not valid, or the network does not fit between latitudes
+     * 85S and 85N.
+     */
+    ::gtfs::Feed generate_feed(const NetworkParameters& parameters);
+
+    /**
+     * Generates the network and writes it as a GTFS feed to the given directory, which is created if needed.
+     * @throw std::runtime_error If the feed cannot be written.
+     */
+    void write_feed(const NetworkParameters& parameters, const std::string& directory);
+
+    /**
+     * Generates the network and creates a Schedule with the trips of all service days, without writing the feed
+     * to disk.
+     */
+    Schedule generate_schedule(const NetworkParameters& parameters);
+}
+
+#endif //PT_ROUTING_SYNTHETIC_H
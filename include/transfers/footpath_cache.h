@@ -0,0 +1,127 @@
+#ifndef PT_ROUTING_FOOTPATH_CACHE_H
+#define PT_ROUTING_FOOTPATH_CACHE_H
+#include <array>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include "transfers.h"
+
+namespace raptor {
+    /**
+     * Walking times between pairs of points, which can be stored on disk and reused when building the transfers of
+     * a new version of a feed.
+     *
+     * Entries are addressed by the coordinates of both points, so pairs of stops which have not moved are found
+     * again, while pairs including added or moved stops are not. Walking times are stored without the durations
+     * added by the TransferManager, so changing its parameters does not invalidate the cache.
+     */
+    class FootpathCache {
+        /**
+         * Coordinates of both points in units of 1e-7 degrees, in the order latitude 1, longitude 1, latitude 2 and
+         * longitude 2.
+         */
+        using Key = std::array<std::int64_t, 4>;
+
+        struct KeyHash {
+            std::size_t operator()(const Key& key) const noexcept;
+        };
+
+        std::string calculator_key;
+        /**
+         * Entries loaded from disk, which have not been used since.
+         */
+        std::unordered_map<Key, std::chrono::seconds, KeyHash> loaded;
+        /**
+         * Entries used or added since loading the cache. Only these are saved, so that entries of removed or moved
+         * stops are dropped.
+         */
+        std::unordered_map<Key, std::chrono::seconds, KeyHash> current;
+
+        static Key key(double latitude_1, double longitude_1, double latitude_2, double longitude_2);
+
+    public:
+        /**
+         * Creates an empty cache.
+         * @param calculator_key Identifies the walk time calculator and its configuration, such as the street
+         * network version. Caches created with a different key are not loaded.
+         */
+        explicit FootpathCache(std::string calculator_key);
+
+        /**
+         * Loads a cache saved with the same calculator key.
+         * @return The loaded cache, or an empty cache if the file does not exist or was saved with a different key.
+         * @throw std::runtime_error If the file cannot be read, or if it is truncated or corrupt.
+         */
+        static FootpathCache load(const std::string& path, std::string calculator_key);
+
+        /**
+         * Saves the entries used or added since the cache was loaded. The file is replaced only after it has been
+         * completely written.
+         * @throw std::runtime_error If the file cannot be written.
+         */
+        void save(const std::string& path) const;
+
+        /**
+         * Finds the walking time between the given points.
+         * @return The walking time, or std::nullopt if the pair is not in the cache.
+         */
+        std::optional<std::chrono::seconds> find(double latitude_1, double longitude_1,
+                                                 double latitude_2, double longitude_2);
+
+        void insert(double latitude_1, double longitude_1, double latitude_2, double longitude_2,
+                    std::chrono::seconds walking_time);
+
+        /**
+         * Number of entries which will be saved.
+         */
+        [[nodiscard]] std::size_t size() const noexcept {
+            return current.size();
+        }
+    };
+
+    /**
+     * Looks up walking times in a FootpathCache and only calculates the missing ones with another calculator.
+     *
+     * It always requires coordinates, so that the TransferManager gives it the points of each pair.
+     */
+    class CachedWalkTimeCalculator final : public WalkTimeCalculator {
+        std::unique_ptr<WalkTimeCalculator> calculator;
+        FootpathCache& cache;
+
+    public:
+        /**
+         * @param calculator Calculator used for pairs not in the cache.
+         * @param cache Cache updated with the calculated walking times. The caller must ensure it outlives the
+         * object and save it after building the transfers.
+         */
+        CachedWalkTimeCalculator(std::unique_ptr<WalkTimeCalculator> calculator, FootpathCache& cache);
+
+        std::chrono::seconds calculate_walking_time(double latitude_1, double longitude_1,
+                                                    double latitude_2, double longitude_2) override;
+
+        /**
+         * Distances do not identify the points, so they are passed to the calculator without using the cache.
+         */
+        std::chrono::seconds calculate_walking_time(double distance_km) override;
+
+        void calculate_walking_times(double latitude, double longitude,
+                                     std::span<const double> latitudes, std::span<const double> longitudes,
+                                     std::span<std::chrono::seconds> walking_times) override;
+
+        void calculate_walking_times(std::span<const double> distances_km,
+                                     std::span<std::chrono::seconds> walking_times) override;
+
+        /**
+         * Calculates the walking times missing from the cache for all queries with a single call to the calculator,
+         * so that it can still process them in parallel.
+         */
+        void calculate_walking_times(std::span<const WalkingTimeQuery> queries) override;
+
+        [[nodiscard]] bool requires_coordinates() const noexcept override {
+            return true;
+        }
+    };
+}
+
+#endif //PT_ROUTING_FOOTPATH_CACHE_H
@@ -6,38 +6,55 @@
 #include "raptor/reconstruction.h"
 
 namespace raptor {
+    /**
+     * A stop found by a search, identified by its position in the stops of the tree.
+     */
+    struct StopSearchResult {
+        std::uint32_t stop_index;
+        double distance_km;
+    };
+
     /**
       * Finds nearby stops by using a KD tree for Stops.
       *
       * It transforms geographic coordinates to the cartesian coordinates to approximate the distance
       * (https://timvink.nl/blog/closest-coordinates/). As such, it should only be used for small distances.
       * In addition, the accuracy is limited.
+      *
+      * Points are stored in single precision, relative to the centre of the stops, so that they take less memory
+      * while keeping millimetre precision over the area of a city.
       */
     class StopKDTree final : public NearbyStopsFinder {
         using AdaptorType =
-        nanoflann::KDTreeSingleIndexAdaptor<nanoflann::L2_Simple_Adaptor<double, StopKDTree>, StopKDTree, 3>;
+        nanoflann::KDTreeSingleIndexAdaptor<nanoflann::L2_Simple_Adaptor<float, StopKDTree>, StopKDTree, 3>;
+        using Point = std::array<float, 3>;
 
         const std::deque<Stop>& stops;
-        std::vector<std::array<double, 3>> stops_with_cartesian_coords;
+        /**
+         * Cartesian coordinates of the stops relative to the origin, one vector for each dimension.
+         */
+        std::array<std::vector<float>, 3> stop_coordinates;
+        std::array<double, 3> origin;
         std::unique_ptr<AdaptorType> index;
 
         /**
-         * Converts geographic to cartesian coordinates.
-         * @param coordinates <Latitude, Longitude> pair
-         * @return Array containing 3-dimensional cartesian coordinates
+         * Converts geographic coordinates to a point of the tree.
          */
-        static std::array<double, 3> to_cartesian(const std::pair<double, double>& coordinates);
+        [[nodiscard]] Point to_point(const std::pair<double, double>& coordinates) const;
 
+        [[nodiscard]] Point get_point(const std::size_t stop_index) const noexcept {
+            return {stop_coordinates[0][stop_index], stop_coordinates[1][stop_index], stop_coordinates[2][stop_index]};
+        }
 
         /**
-         * Calculates all stops in radius of the given cartesian coordinates.
+         * Calculates all stops in radius of the given point.
          *
-         * @param cartesian_coords Stop coordinates, already transformed to the cartesian system.
+         * @param point Stop coordinates, already transformed to a point of the tree.
          * @param radius_km Search radius in kilometres
          * @return Vector of nanoflann result items.
          */
-        [[nodiscard]] std::vector<nanoflann::ResultItem<uint32_t>> stops_in_radius(
-                const std::array<double, 3>& cartesian_coords, double radius_km) const;
+        [[nodiscard]] std::vector<nanoflann::ResultItem<uint32_t, float>> stops_in_radius(
+                const Point& point, double radius_km) const;
 
         /**
          * Converts the results returned by the nanoflann library to a vector of StopWithDistance objects.
@@ -46,20 +63,26 @@ namespace raptor {
          * @return
          */
         template <std::ranges::input_range R>
-            requires std::is_same_v<std::ranges::range_value_t<R>, nanoflann::ResultItem<uint32_t>>
+            requires std::is_same_v<std::ranges::range_value_t<R>, nanoflann::ResultItem<uint32_t, float>>
         std::vector<StopWithDistance> convert_flann_results(R&& flann_results) const {
             auto results = std::vector<StopWithDistance>();
             std::ranges::transform(flann_results, std::back_inserter(results),
                                    [this](const auto& match) {
-                                       auto& stop = stops.at(match.first);
+                                       auto& stop = stops[match.first];
                                        // TODO: This seems correct but verify formally
-                                       auto distance = std::sqrt(match.second);
+                                       auto distance = std::sqrt(static_cast<double>(match.second));
                                        return StopWithDistance{stop, distance};
                                    });
             return results;
         }
 
     public:
+        /**
+         * Converts geographic to cartesian coordinates. Distances between the converted points are in kilometres.
+         * @param coordinates <Latitude, Longitude> pair
+         * @return Array containing 3-dimensional cartesian coordinates
+         */
+        static std::array<double, 3> to_cartesian(const std::pair<double, double>& coordinates);
 
         /**
          * The class stores references to the given stops, so passing a temporary will result in those references
@@ -113,16 +136,47 @@ namespace raptor {
          */
         [[nodiscard]] std::vector<StopsInRadius> stops_in_radius(double radius_km) const;
 
+        /**
+         * Searches the nearby stops of all the stops in parallel.
+         *
+         * Every pair is found from both of its stops, but only kept by the stop with the smaller position.
+         */
+        [[nodiscard]] std::optional<std::vector<StopPairWithDistance>> stop_pairs_in_radius(
+                double radius_km) const override;
+
+        /**
+         * Finds the stops closest to the given coordinates, without allocating memory.
+         * @param latitude Latitude of the centre point in decimal degrees.
+         * @param longitude Longitude of the centre point in decimal degrees.
+         * @param results Buffer for the results. At most as many stops as its size are found.
+         * @return Number of stops written to the buffer, sorted by their distance.
+         */
+        std::size_t nearest_stops(double latitude, double longitude, std::span<StopSearchResult> results) const;
+
+        /**
+         * Finds the stops closest to the given coordinates within the given radius, without allocating memory.
+         *
+         * Useful when only the closest few stops are needed, for example when accessing the network from a point,
+         * since the search does not visit all the stops in the radius.
+         * @param radius_km Search radius in kilometres.
+         * @param results Buffer for the results. At most as many stops as its size are found.
+         * @return Number of stops written to the buffer, sorted by their distance.
+         */
+        std::size_t nearest_stops_in_radius(double latitude, double longitude, double radius_km,
+                                            std::span<StopSearchResult> results) const;
+
+        [[nodiscard]] MemoryUsage memory_usage() const override;
+
         /*
          * Functions required by nanoflann
          */
 
         size_t kdtree_get_point_count() const {
-            return stops_with_cartesian_coords.size();
+            return stop_coordinates[0].size();
         }
 
-        double kdtree_get_pt(const size_t idx, int dim) const {
-            return stops_with_cartesian_coords.at(idx).at(dim);
+        float kdtree_get_pt(const size_t idx, const int dim) const {
+            return stop_coordinates[dim][idx];
         }
 
         template <class BBOX>
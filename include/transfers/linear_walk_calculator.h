@@ -1,5 +1,7 @@
 #ifndef PT_ROUTING_LINEAR_WALK_CALCULATOR_H
 #define PT_ROUTING_LINEAR_WALK_CALCULATOR_H
+#include <cmath>
+
 #include "transfers.h"
 
 namespace raptor {
@@ -11,17 +13,29 @@ namespace raptor {
         double scaling_factor;
 
         /**
-         * Calculates the great-circle distance between two points using the haversine formula.
-         * @param latitude_1 Latitude of the first point in decimal degrees.
-         * @param longitude_1 Longitude of the first point in decimal degrees.
-         * @param latitude_2 Latitude of the second point in decimal degrees.
-         * @param longitude_2 Longitude of the second point in decimal degrees.
-         * @return Distance in kilometres
+         * Converts a distance to a walking time. Shared by all the public functions, so that they give the same
+         * results for the same distance.
          */
-        static double calculate_distance(double latitude_1, double longitude_1,
-                                         double latitude_2, double longitude_2);
+        [[nodiscard]] std::chrono::seconds to_walking_time(const double distance_km) const noexcept {
+            auto time = 3600 * distance_km / walking_speed;
+            time *= scaling_factor;
+            return std::chrono::seconds{static_cast<int>(std::ceil(time))};
+        }
+
+        /**
+         * Number of distances calculated at once by the one-to-many calculate_walking_times.
+         */
+        static constexpr std::size_t chunk_size = 256;
+
+        /**
+         * Converts distances to walking times, like to_walking_time, in a loop which the compiler can vectorise.
+         */
+        void to_walking_times(std::span<const double> distances_km,
+                              std::span<std::chrono::seconds> walking_times) const noexcept;
 
     public:
+        static constexpr auto earth_radius_km = 6371.0;
+
         /**
          * A scaling factor can be applied to all the calculated times to offset the accuracy loss from assuming a
          * linear path between points.
@@ -32,6 +46,35 @@ namespace raptor {
          */
         explicit LinearWalkTimeCalculator(double walking_speed_km_h, double time_scaling_factor = 1.0);
 
+        /**
+         * Calculates the great-circle distance between two points using the haversine formula.
+         * @param latitude_1 Latitude of the first point in decimal degrees.
+         * @param longitude_1 Longitude of the first point in decimal degrees.
+         * @param latitude_2 Latitude of the second point in decimal degrees.
+         * @param longitude_2 Longitude of the second point in decimal degrees.
+         * @return Distance in kilometres
+         */
+        static double calculate_distance(double latitude_1, double longitude_1,
+                                         double latitude_2, double longitude_2);
+
+        /**
+         * Haversine formula for callers which keep coordinates in radians and the cosines of their latitudes
+         * precomputed, such as StopGrid.
+         * @param delta_latitude Latitude of the second point minus the latitude of the first point in radians
+         * @param delta_longitude Longitude of the second point minus the longitude of the first point in radians
+         * @param cos_latitude_1 Cosine of the latitude of the first point
+         * @param cos_latitude_2 Cosine of the latitude of the second point
+         * @return Distance in kilometres
+         */
+        static double haversine_distance(const double delta_latitude, const double delta_longitude,
+                                         const double cos_latitude_1, const double cos_latitude_2) noexcept {
+            const auto sin_latitude = std::sin(delta_latitude / 2);
+            const auto sin_longitude = std::sin(delta_longitude / 2);
+            const auto a = sin_latitude * sin_latitude +
+                    cos_latitude_1 * cos_latitude_2 * sin_longitude * sin_longitude;
+            return 2 * earth_radius_km * std::atan2(std::sqrt(a), std::sqrt(1 - a));
+        }
+
         /**
          * Calculates the walking time between two coordinates assuming a straight line path and a constant walking
          * speed.
@@ -49,6 +92,26 @@ namespace raptor {
          * @return Walking time in seconds
          */
         std::chrono::seconds calculate_walking_time(double distance) override;
+
+        /**
+         * Calculates the walking times from one point to many others, approximating the haversine distance with
+         * arithmetic operations and a square root.
+         *
+         * The distances are computed into a buffer, which is then converted to walking times, so that neither loop
+         * contains branches or calls. The source file is compiled with -fno-math-errno and -fno-trapping-math,
+         * which lets GCC vectorise both loops, as reported by -fopt-info-vec with -O3 -march=x86-64-v3.
+         *
+         * The sines and the arcsine of the haversine formula are replaced by their arguments, and the cosine of each
+         * destination's latitude is derived from the origin's. For points less than 10 km apart and latitudes below
+         * 80 degrees, the distance differs by less than 0.001% from calculate_distance, so walking times differ by at
+         * most one second.
+         */
+        void calculate_walking_times(double latitude, double longitude,
+                                     std::span<const double> latitudes, std::span<const double> longitudes,
+                                     std::span<std::chrono::seconds> walking_times) override;
+
+        void calculate_walking_times(std::span<const double> distances_km,
+                                     std::span<std::chrono::seconds> walking_times) override;
     };
 }
 
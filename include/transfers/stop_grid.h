@@ -0,0 +1,103 @@
+#ifndef PT_ROUTING_STOP_GRID_H
+#define PT_ROUTING_STOP_GRID_H
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+
+#include "transfers.h"
+
+namespace raptor {
+    /**
+     * Finds nearby stops by placing them in a uniform grid of latitude and longitude cells.
+     *
+     * Cells are sized so that a search with a radius up to the cell size only needs the neighbouring cells. Larger
+     * radii are supported, but search more cells. Distances are great-circle distances, so results are exact.
+     * Searches across the antimeridian are not supported.
+     */
+    class StopGrid final : public NearbyStopsFinder {
+        /**
+         * Half-open range of positions in the stop vectors.
+         */
+        struct Cell {
+            std::uint32_t begin;
+            std::uint32_t end;
+        };
+
+        const std::deque<Stop>& stops;
+        /**
+         * Size of the cells in radians. Longitude cells are wider, so that they are at least as wide as the cell
+         * size at the latitude of every stop.
+         */
+        double cell_latitude;
+        double cell_longitude;
+
+        /**
+         * Stops are stored ordered by their cell, so that the stops of a cell are contiguous.
+         * Coordinates are in radians.
+         */
+        std::vector<std::uint32_t> stop_indices;
+        std::vector<double> latitudes;
+        std::vector<double> longitudes;
+        std::vector<double> cos_latitudes;
+        std::unordered_map<std::uint64_t, Cell> cells;
+
+        [[nodiscard]] static std::uint64_t cell_key(std::int32_t x, std::int32_t y) noexcept {
+            return static_cast<std::uint64_t>(static_cast<std::uint32_t>(x)) << 32 | static_cast<std::uint32_t>(y);
+        }
+
+        [[nodiscard]] std::int32_t cell_x(const double longitude) const noexcept {
+            return static_cast<std::int32_t>(std::floor(longitude / cell_longitude));
+        }
+
+        [[nodiscard]] std::int32_t cell_y(const double latitude) const noexcept {
+            return static_cast<std::int32_t>(std::floor(latitude / cell_latitude));
+        }
+
+        /**
+         * Calls the given function with the position and distance of each stop within the radius of the given point.
+         * @param latitude Latitude in radians.
+         * @param longitude Longitude in radians.
+         */
+        template <typename F>
+        void for_each_stop_in_radius(double latitude, double longitude, double radius_km, F&& function) const;
+
+    public:
+        /**
+         * The class stores references to the given stops, so passing a temporary will result in those references
+         * becoming invalid.
+         */
+        explicit StopGrid(std::deque<Stop>&&, double) = delete;
+
+        /**
+         * @param stops Reference to a deque container. Its lifetime must be longer than the object's.
+         * @param cell_size_km Size of the cells. Searches are fastest when it is equal to the search radius.
+         * @throw std::invalid_argument If the cell size is not positive.
+         */
+        StopGrid(const std::deque<Stop>& stops, double cell_size_km);
+
+        /**
+         * Return a factory function which creates a StopGrid.
+         * @param cell_size_km Size of the cells, usually the maximum transfer radius.
+         */
+        static Factory create_factory(double cell_size_km);
+
+        /**
+         * Find all stops near the given geographic coordinates.
+         * @param latitude Latitude of the centre point in decimal degrees.
+         * @param longitude Longitude of the centre point in decimal degrees.
+         * @param radius_km Search radius in kilometres.
+         * @return Each stop inside the radius, along with its great-circle distance from the given point.
+         */
+        std::vector<StopWithDistance> stops_in_radius(double latitude, double longitude, double radius_km) override;
+
+        /**
+         * Searches the nearby stops of all the stops in parallel.
+         */
+        [[nodiscard]] std::optional<std::vector<StopPairWithDistance>> stop_pairs_in_radius(
+                double radius_km) const override;
+
+        [[nodiscard]] MemoryUsage memory_usage() const override;
+    };
+}
+
+#endif //PT_ROUTING_STOP_GRID_H
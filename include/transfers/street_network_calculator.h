@@ -0,0 +1,183 @@
+#ifndef PT_ROUTING_STREET_NETWORK_CALCULATOR_H
+#define PT_ROUTING_STREET_NETWORK_CALCULATOR_H
+#include <array>
+#include <istream>
+
+#include <boost/graph/compressed_sparse_row_graph.hpp>
+#include <nanoflann.hpp>
+
+#include "transfers.h"
+
+namespace raptor {
+    /**
+     * Walkable paths of a street network, usually extracted from OpenStreetMap.
+     */
+    struct StreetNetwork {
+        struct Node {
+            double latitude;
+            double longitude;
+        };
+
+        /**
+         * A path between two nodes, identified by their positions. Paths can be walked in both directions.
+         */
+        struct Segment {
+            std::uint32_t from;
+            std::uint32_t to;
+        };
+
+        std::vector<Node> nodes;
+        std::vector<Segment> segments;
+
+        /**
+         * Reads an OpenStreetMap extract in the OPL text format written by osmium, for example with
+         *
+         *     osmium tags-filter city.osm.pbf w/highway -o city-highways.opl
+         *
+         * Only ways which pedestrians can walk along are used: ways with a highway tag, except roads such as
+         * motorways and trunk roads, unless they are tagged with foot=yes. Ways tagged with foot=no or with a private
+         * access are skipped. Nodes which are not part of a walkable way are dropped, so that points are never snapped
+         * to them. Relations are ignored.
+         *
+         * Nodes must be given before the ways using them, as in every extract sorted by osmium.
+         * @throw std::runtime_error If a line cannot be parsed or a walkable way refers to an unknown node.
+         */
+        static StreetNetwork read(std::istream& input);
+
+        /**
+         * Reads a street network extract from the given file.
+         * @throw std::runtime_error If the file cannot be opened or parsed.
+         */
+        static StreetNetwork read(const std::string& path);
+    };
+
+    /**
+     * Calculates walking times along a street network.
+     *
+     * Points are snapped to the closest node of the network and the shortest path between the nodes is found using
+     * Dijkstra's algorithm. The straight-line distance between each point and its node is added to the path.
+     * Searches stop at the maximum walking distance, so destinations further away are unreachable.
+     */
+    class StreetNetworkWalkTimeCalculator final : public WalkTimeCalculator {
+        struct Edge {
+            double length_m;
+        };
+
+        using Graph = boost::compressed_sparse_row_graph<boost::directedS, boost::no_property, Edge>;
+        using Vertex = Graph::vertex_descriptor;
+        using AdaptorType = nanoflann::KDTreeSingleIndexAdaptor<
+            nanoflann::L2_Simple_Adaptor<double, StreetNetworkWalkTimeCalculator>, StreetNetworkWalkTimeCalculator, 3>;
+
+        /**
+         * Distances from the origin of a search. They are kept between searches, so that only the distances of the
+         * vertices reached by a search need to be reset.
+         */
+        struct SearchState {
+            std::vector<double> distances_m;
+            std::vector<Vertex> reached;
+        };
+
+        /**
+         * A point snapped to the closest vertex of the graph.
+         */
+        struct SnappedPoint {
+            Vertex vertex;
+            double distance_m;
+        };
+
+        Graph graph;
+        std::vector<std::array<double, 3>> nodes_with_cartesian_coords;
+        std::unique_ptr<AdaptorType> index;
+        double walking_speed_m_s;
+        double max_walking_distance_m;
+        double max_snapping_distance_m;
+        /**
+         * Used by the functions calculating the walking times of a single origin.
+         */
+        SearchState state;
+
+        [[nodiscard]] SearchState create_search_state() const;
+
+        /**
+         * Finds the closest vertex to the given point.
+         * @return The vertex, or std::nullopt if there is no vertex within the maximum snapping distance.
+         */
+        [[nodiscard]] std::optional<SnappedPoint> snap(double latitude, double longitude) const;
+
+        /**
+         * Calculates the walking times of the given query with a single search bounded by the maximum walking
+         * distance. The search stops early when all destinations have been reached.
+         */
+        void search(const WalkingTimeQuery& query, SearchState& search_state) const;
+
+        [[nodiscard]] std::chrono::seconds to_walking_time(const double distance_m) const noexcept {
+            return std::chrono::seconds{static_cast<int>(std::ceil(distance_m / walking_speed_m_s))};
+        }
+
+    public:
+        /**
+         * @param network Street network, which is copied into the calculator.
+         * @param walking_speed_km_h Walking speed in kilometres per hour.
+         * @param max_walking_distance_km Maximum distance of a walk, including the distance of the points from the
+         * network.
+         * @param max_snapping_distance_km Maximum distance between a point and its closest node. Points further away
+         * from the network are unreachable.
+         * @throw std::invalid_argument If a non-positive speed or distance is given, or a segment refers to a node
+         * not in the network.
+         */
+        explicit StreetNetworkWalkTimeCalculator(const StreetNetwork& network, double walking_speed_km_h,
+                                                 double max_walking_distance_km = 2.0,
+                                                 double max_snapping_distance_km = 0.25);
+
+        /**
+         * Calculates the walking time between two coordinates along the street network.
+         * @return Walking time in seconds, or unreachable if there is no path within the maximum walking distance.
+         */
+        std::chrono::seconds calculate_walking_time(double latitude_1, double longitude_1,
+                                                    double latitude_2, double longitude_2) override;
+
+        /**
+         * Calculates the walking time for the given straight-line distance. Paths along the network are usually
+         * longer, so it is a lower bound for the walking time between two points.
+         * @param distance_km Distance in kilometres
+         */
+        std::chrono::seconds calculate_walking_time(double distance_km) override;
+
+        /**
+         * Calculates the walking times from one point to many others with a single search.
+         */
+        void calculate_walking_times(double latitude, double longitude,
+                                     std::span<const double> latitudes, std::span<const double> longitudes,
+                                     std::span<std::chrono::seconds> walking_times) override;
+
+        using WalkTimeCalculator::calculate_walking_times;
+
+        /**
+         * Calculates the walking times of all queries, searching from multiple origins in parallel.
+         */
+        void calculate_walking_times(std::span<const WalkingTimeQuery> queries) override;
+
+        [[nodiscard]] bool requires_coordinates() const noexcept override {
+            return true;
+        }
+
+        /*
+         * Functions required by nanoflann
+         */
+
+        size_t kdtree_get_point_count() const {
+            return nodes_with_cartesian_coords.size();
+        }
+
+        double kdtree_get_pt(const size_t idx, int dim) const {
+            return nodes_with_cartesian_coords[idx][dim];
+        }
+
+        template <class BBOX>
+        bool kdtree_get_bbox(BBOX&) const {
+            return false;
+        }
+    };
+}
+
+#endif //PT_ROUTING_STREET_NETWORK_CALCULATOR_H
@@ -1,7 +1,10 @@
 #ifndef PT_ROUTING_TRANSFERS_H
 #define PT_ROUTING_TRANSFERS_H
 #include <chrono>
+#include <cstdint>
 #include <functional>
+#include <optional>
+#include <span>
 
 #include <nanoflann.hpp>
 #include "schedule/Schedule.h"
@@ -18,6 +21,15 @@ namespace raptor {
         const std::vector<StopWithDistance> nearby_stops;
     };
 
+    /**
+     * Two stops within some distance of each other, identified by their positions in a collection of stops.
+     */
+    struct StopPairWithDistance {
+        std::uint32_t first;
+        std::uint32_t second;
+        double distance_km;
+    };
+
     /**
      * Interface for classes that support performing nearby stop searches.
      */
@@ -34,14 +46,55 @@ namespace raptor {
          */
         virtual std::vector<StopWithDistance> stops_in_radius(double latitude, double longitude, double radius_km) = 0;
 
+        /**
+         * Finds all pairs of different stops within the given distance of each other, out of the stops given when
+         * creating the finder.
+         *
+         * Intended for finders which can search for all stops at once more efficiently than calling
+         * stops_in_radius for each stop.
+         * @param radius_km Search radius in kilometres.
+         * @return Each pair once, with the position of the first stop being smaller than the second, or std::nullopt
+         * if the finder does not support bulk searches.
+         */
+        [[nodiscard]] virtual std::optional<std::vector<StopPairWithDistance>> stop_pairs_in_radius(
+                [[maybe_unused]] double radius_km) const {
+            return std::nullopt;
+        }
+
+        /**
+         * Memory used by the finder, including the object itself. Finders which do not override it report no memory.
+         */
+        [[nodiscard]] virtual MemoryUsage memory_usage() const {
+            return MemoryUsage{"nearby stops finder"};
+        }
+
         // Use a factory function, since a finder might require arguments be given in its constructor.
         using Factory = std::function<std::unique_ptr<NearbyStopsFinder>(const std::deque<Stop>&)>;
     };
 
+    /**
+     * Origin and destinations of a one-to-many walking time calculation.
+     */
+    struct WalkingTimeQuery {
+        double latitude;
+        double longitude;
+        std::span<const double> latitudes;
+        std::span<const double> longitudes;
+        /**
+         * Output for the walking time to each destination.
+         */
+        std::span<std::chrono::seconds> walking_times;
+    };
+
     class WalkTimeCalculator {
     public:
         virtual ~WalkTimeCalculator() = default;
 
+        /**
+         * Walking time given for destinations which cannot be reached on foot.
+         */
+        static constexpr auto unreachable = std::chrono::seconds::max();
+
         /**
          * Calculates the walking time between two geographical coordinate pairs.
         * @param latitude_1 Latitude of the first point in decimal degrees.
@@ -59,6 +112,50 @@ namespace raptor {
          * @return Walking time in seconds
          */
         virtual std::chrono::seconds calculate_walking_time(double distance_km) = 0;
+
+        /**
+         * Calculates the walking times from one point to many others.
+         *
+         * The default implementation calls calculate_walking_time for every destination. Implementations should
+         * override it when they can process many destinations faster.
+         * @param latitude Latitude of the origin in decimal degrees.
+         * @param longitude Longitude of the origin in decimal degrees.
+         * @param latitudes Latitudes of the destinations in decimal degrees.
+         * @param longitudes Longitudes of the destinations in decimal degrees.
+         * @param walking_times Output for the walking time to each destination.
+         * @throw std::invalid_argument If the given spans have different sizes.
+         */
+        virtual void calculate_walking_times(double latitude, double longitude,
+                                             std::span<const double> latitudes, std::span<const double> longitudes,
+                                             std::span<std::chrono::seconds> walking_times);
+
+        /**
+         * Calculates the times required to walk each of the given distances.
+         *
+         * The default implementation calls calculate_walking_time for every distance.
+         * @param distances_km Distances in kilometres.
+         * @param walking_times Output for the walking time of each distance.
+         * @throw std::invalid_argument If the given spans have different sizes.
+         */
+        virtual void calculate_walking_times(std::span<const double> distances_km,
+                                             std::span<std::chrono::seconds> walking_times);
+
+        /**
+         * Calculates the walking times of many one-to-many queries.
+         *
+         * The default implementation calls the one-to-many calculate_walking_times for every query.
+         * Implementations may process the queries in parallel.
+         * @throw std::invalid_argument If the spans of a query have different sizes.
+         */
+        virtual void calculate_walking_times(std::span<const WalkingTimeQuery> queries);
+
+        /**
+         * Whether walking times depend on the locations of the points and not only on the distance between them.
+         * Transfers are then calculated from the coordinates of the stops, grouped by origin stop.
+         */
+        [[nodiscard]] virtual bool requires_coordinates() const noexcept {
+            return false;
+        }
     };
 
     struct TransferManagerParameters {
@@ -74,6 +171,26 @@ namespace raptor {
         std::chrono::seconds exit_station_duration = std::chrono::seconds{120};
 
         std::chrono::seconds in_station_transfer_duration = std::chrono::seconds{60};
+
+        /**
+         * Maximum duration of a chain of footpaths which is replaced by a single transfer.
+         * Raptor takes a single footpath after each round, so stops reachable only through a chain of footpaths are
+         * otherwise missed. The footpaths are not closed when it is zero.
+         */
+        std::chrono::seconds max_closure_duration = std::chrono::seconds{0};
+    };
+
+    /**
+     * A transfer to another stop.
+     *
+     * The destination is identified by its index and the duration is stored in 32 bits, so that footpaths are packed
+     * tightly in memory.
+     */
+    struct Footpath {
+        using Duration = std::chrono::duration<std::int32_t>;
+
+        std::uint32_t target_stop_index;
+        Duration duration;
     };
 
     /**
@@ -83,30 +200,87 @@ namespace raptor {
         const std::deque<Stop>& stops;
         TransferManagerParameters parameters;
 
-        using StopWithDuration = std::pair<std::reference_wrapper<const Stop>, std::chrono::seconds>;
-        std::unordered_map<std::reference_wrapper<const Stop>, std::vector<StopWithDuration>> transfers;
-        std::vector<StopWithDuration> empty;
+        /**
+         * Footpaths from each stop, indexed by the index of the stop. Used only while building the transfers.
+         */
+        using AdjacencyLists = std::vector<std::vector<Footpath>>;
+
+        /**
+         * Footpaths in compressed sparse row form. The footpaths from the stop with index i are stored in
+         * footpaths[footpath_offsets[i]] up to, but not including, footpaths[footpath_offsets[i + 1]].
+         */
+        std::vector<std::size_t> footpath_offsets;
+        std::vector<Footpath> footpaths;
 
         std::unique_ptr<NearbyStopsFinder> nearby_stops_finder;
         std::unique_ptr<WalkTimeCalculator> walk_time_calculator;
 
         /**
-         * Creates transfers for stops inside the same station.
+         * Stops to which a transfer has been defined, for each stop indexed by its index. Later steps of building the
+         * transfers do not create transfers between these pairs.
          */
-        void build_same_station_transfers();
+        using CoveredTargets = std::vector<std::vector<std::uint32_t>>;
+
+        /**
+         * Creates the transfers defined by the feed. If a pair of stops appears more than once, the first transfer
+         * is used.
+         * @throw std::invalid_argument If a transfer refers to a stop not managed by this object.
+         */
+        void build_given_transfers(std::span<const StopTransfer> given_transfers, AdjacencyLists& adjacency,
+                                   CoveredTargets& covered) const;
+
+        /**
+         * Creates transfers for stops inside the same station, unless a transfer between them has been defined.
+         */
+        void build_same_station_transfers(AdjacencyLists& adjacency, CoveredTargets& covered) const;
 
         /**
          * Builds on-foot transfers between stops in the given range. Only builds transfers between stops for which a
          * transfer has not been previously defined.
+         *
+         * When the nearby stops finder supports bulk searches, the walking time for each pair of stops is calculated
+         * once and used for both directions.
+         */
+        void build_on_foot_transfers(AdjacencyLists& adjacency, CoveredTargets& covered) const;
+
+        /**
+         * Builds on-foot transfers for walk time calculators which require the coordinates of the stops. The walking
+         * times from each stop to all of its nearby stops are calculated together. Stops which cannot be reached on
+         * foot do not get a transfer.
+         * @param covered Defined transfers, sorted for each stop.
+         */
+        void build_on_foot_transfers_from_coordinates(AdjacencyLists& adjacency,
+                                                      const CoveredTargets& covered) const;
+
+        /**
+         * Closes the footpaths transitively, up to the maximum closure duration. Chains of footpaths become a single
+         * footpath, and footpaths slower than a chain between the same stops get the duration of the chain. Like for
+         * a single footpath, the exit station duration is added once for each chain.
+         * Transfers defined by the feed and transfers inside stations are kept as they are, and no footpaths are added
+         * between stops with a transfer which is not possible.
+         * @param covered Defined transfers, sorted for each stop.
+         */
+        void close_footpaths(AdjacencyLists& adjacency, const CoveredTargets& covered) const;
+
+        /**
+         * Stores the footpaths of all stops in compressed sparse row form.
          */
-        void build_on_foot_transfers();
+        void compile_footpaths(const AdjacencyLists& adjacency);
 
         /**
-         * Calculates transfers and transfer times for all stops.
+         * Calculates transfers and transfer times for all stops. Transfers defined by the feed take precedence over
+         * calculated ones.
          */
-        void build_transfers() {
-            build_same_station_transfers();
-            build_on_foot_transfers();
+        void build_transfers(const std::span<const StopTransfer> given_transfers) {
+            auto adjacency = AdjacencyLists(stops.size());
+            auto covered = CoveredTargets(stops.size());
+            build_given_transfers(given_transfers, adjacency, covered);
+            build_same_station_transfers(adjacency, covered);
+            build_on_foot_transfers(adjacency, covered);
+            if (parameters.max_closure_duration > std::chrono::seconds{0}) {
+                close_footpaths(adjacency, covered);
+            }
+            compile_footpaths(adjacency);
         }
 
     public:
@@ -114,29 +288,59 @@ namespace raptor {
         template <typename... Args>
         explicit TransferManager(std::deque<Stop>&&, Args...) = delete;
 
+        template <typename... Args>
+        explicit TransferManager(Schedule&&, Args...) = delete;
+
         /**
-         * @param stops Collection of stops. A reference to it is stored inside the class, so the caller must ensure
-         * it outlives the TransferManager.
+         * @param stops Collection of stops, usually owned by a StopManager. A reference to it is stored inside the
+         * class, so the caller must ensure it outlives the TransferManager.
          * @param nearby_stops_finder_factory Factory for creating a NearbyStopsFinder object.
          * @param walk_time_calculator Object used for calculating walking times between stops.
          * @param parameters Options affecting
+         * @param given_transfers Transfers between the given stops which are used instead of calculated ones.
+         * Transfers of the NotPossible type prevent calculating a transfer between the stops.
+         * @throw std::invalid_argument If the index of a stop is different from its position in the collection, or a
+         * given transfer refers to other stops.
          */
         explicit TransferManager(const std::deque<Stop>& stops,
+                                 const NearbyStopsFinder::Factory& nearby_stops_finder_factory,
+                                 std::unique_ptr<WalkTimeCalculator> walk_time_calculator,
+                                 const TransferManagerParameters parameters = TransferManagerParameters(),
+                                 std::span<const StopTransfer> given_transfers = {});
+
+        /**
+         * Creates transfers between the stops of the schedule, using the transfers defined by its feed.
+         * @param schedule Schedule whose stops and transfers are used. A reference to its stops is stored inside the
+         * class, so the caller must ensure it outlives the TransferManager.
+         */
+        explicit TransferManager(const Schedule& schedule,
                                  const NearbyStopsFinder::Factory& nearby_stops_finder_factory,
                                  std::unique_ptr<WalkTimeCalculator> walk_time_calculator,
                                  const TransferManagerParameters parameters = TransferManagerParameters()) :
-            parameters(parameters), stops(stops),
-            nearby_stops_finder(nearby_stops_finder_factory(stops)),
-            walk_time_calculator(std::move(walk_time_calculator)) {
-            build_transfers();
+            TransferManager(schedule.get_stops(), nearby_stops_finder_factory, std::move(walk_time_calculator),
+                            parameters, schedule.get_transfers()) {
         }
 
         /**
          * Returns all transfers from the given stop, along with the time required to make the transfer.
-         * @param stop Transfer origin stop.
-         * @return Pairs of destination stop and transfer duration.
+         * @param stop Transfer origin stop. Must be one of the stops given when constructing the object.
+         * @return Footpaths with the index of the destination stop and the transfer duration.
+         */
+        [[nodiscard]] std::span<const Footpath> get_transfers_from_stop(const Stop& stop) const noexcept {
+            const auto index = stop.get_index();
+            return {footpaths.data() + footpath_offsets[index], footpaths.data() + footpath_offsets[index + 1]};
+        }
+
+        /**
+         * Memory used by the transfer manager, including the object itself and the nearby stops finder.
+         */
+        [[nodiscard]] MemoryUsage memory_usage() const;
+
+        /**
+         * Hash of the footpaths, which is the same in every process which builds the same footpaths. It covers the
+         * effect of the parameters and of the walk time calculator, unlike Schedule::fingerprint.
          */
-        const std::vector<StopWithDuration>& get_transfers_from_stop(const Stop& stop) const;
+        [[nodiscard]] std::uint64_t fingerprint() const;
     };
 
 }
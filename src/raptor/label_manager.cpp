@@ -2,12 +2,27 @@
 
 namespace raptor {
     std::optional<LabelManager::LabelType> LabelManager::get_label(const Stop& stop, const LabelContainer& labels) {
-        const auto label = labels.find(stop);
-        return label == labels.end() ? std::nullopt : std::make_optional(label->second);
+        const auto index = stop.get_index();
+        return index < labels.size() ? labels[index] : std::nullopt;
+    }
+
+    void LabelManager::reset(const std::size_t n_stops) {
+        for (const auto index : labelled_stops) {
+            current_round_labels[index].reset();
+            previous_round_labels[index].reset();
+        }
+        labelled_stops.clear();
+        changed_stops.clear();
+        current_round_labels.resize(n_stops);
+        previous_round_labels.resize(n_stops);
     }
 
     void LabelManager::new_round() {
-        previous_round_labels = current_round_labels;
+        // Labels which did not change in the last round are already the same in both sets
+        for (const auto index : changed_stops) {
+            previous_round_labels[index] = current_round_labels[index];
+        }
+        changed_stops.clear();
     }
 
     std::optional<LabelManager::LabelType> LabelManager::get_latest_label(const Stop& stop) const {
@@ -18,4 +33,3 @@ namespace raptor {
         return get_label(stop, previous_round_labels);
     }
 }
-
@@ -0,0 +1,121 @@
+#include <algorithm>
+#include <array>
+#include <limits>
+
+#include "raptor/query_log.h"
+#include "schedule/binary_io.h"
+
+namespace raptor {
+    using binary::read_value;
+    using binary::write_value;
+
+    /**
+     * Identifies the file format. The version is increased whenever the format changes.
+     */
+    constexpr auto log_magic = std::array{'P', 'T', 'Q', 'L'};
+    constexpr auto log_version = std::uint32_t{2};
+
+    namespace {
+        /**
+         * Mixes the bits of a number, so that consecutive numbers give unrelated results (splitmix64).
+         */
+        std::uint64_t mix(std::uint64_t value) noexcept {
+            value += 0x9e3779b97f4a7c15;
+            value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9;
+            value = (value ^ (value >> 27)) * 0x94d049bb133111eb;
+            return value ^ (value >> 31);
+        }
+
+        /**
+         * Counters are stored in 32 bits, which is enough for any single query.
+         */
+        std::uint32_t to_counter(const std::size_t value) noexcept {
+            return static_cast<std::uint32_t>(std::min<std::size_t>(value, std::numeric_limits<std::uint32_t>::max()));
+        }
+    }
+
+    QueryLog::QueryLog(const std::string& path, const Raptor& router, const QueryLogParameters parameters) :
+        output(path, std::ios::binary | std::ios::trunc), parameters(parameters) {
+        if (parameters.sample_fraction >= 1.0) {
+            sample_threshold = std::numeric_limits<std::uint64_t>::max();
+        } else {
+            sample_threshold = static_cast<std::uint64_t>(std::max(0.0, parameters.sample_fraction) * 0x1p64);
+        }
+        output.write(log_magic.data(), log_magic.size());
+        write_value(output, log_version);
+        write_value(output, router.get_schedule().fingerprint());
+        write_value(output, router.get_transfer_manager().fingerprint());
+        output.flush();
+        if (!output) {
+            throw std::runtime_error("Cannot write query log " + path);
+        }
+    }
+
+    bool QueryLog::sampled(const std::uint64_t query_number) const noexcept {
+        return sample_threshold > 0 && mix(parameters.seed ^ mix(query_number)) <= sample_threshold;
+    }
+
+    std::vector<Movement> QueryLog::route(Raptor& router, const Stop& origin, const Stop& destination,
+                                          const Time& departure_time) {
+        auto stats = QueryStats{};
+        const auto start = std::chrono::steady_clock::now();
+        auto journey = router.route(origin, destination, departure_time, QueryStats::enabled ? &stats : nullptr);
+        const auto latency = std::chrono::steady_clock::now() - start;
+
+        if (latency >= parameters.latency_threshold || sampled(n_queries++)) {
+            write({static_cast<std::uint32_t>(origin.get_index()), static_cast<std::uint32_t>(destination.get_index()),
+                   std::chrono::floor<std::chrono::seconds>(departure_time.get_sys_time()), latency,
+                   static_cast<std::uint32_t>(stats.rounds_executed()), stats.total()});
+        }
+        return journey;
+    }
+
+    void QueryLog::write(const LoggedQuery& query) {
+        const auto lock = std::scoped_lock{mutex};
+        write_value(output, query.origin);
+        write_value(output, query.destination);
+        write_value(output, static_cast<std::int64_t>(query.departure_time.time_since_epoch().count()));
+        write_value(output, static_cast<std::int64_t>(query.latency.count()));
+        write_value(output, query.rounds);
+        for (const auto counter : {query.work.stops_marked, query.work.routes_scanned, query.work.stop_events_visited,
+                                   query.work.trips_searched, query.work.labels_improved,
+                                   query.work.transfers_relaxed}) {
+            write_value(output, to_counter(counter));
+        }
+        output.flush();
+    }
+
+    QueryLog::Contents QueryLog::read(const std::string& path) {
+        auto input = std::ifstream(path, std::ios::binary);
+        auto magic = std::array<char, log_magic.size()>{};
+        input.read(magic.data(), magic.size());
+        if (!input || magic != log_magic || read_value<std::uint32_t>(input) != log_version) {
+            throw std::runtime_error("Invalid query log " + path);
+        }
+        auto contents = Contents{};
+        contents.schedule_fingerprint = read_value<std::uint64_t>(input);
+        contents.transfers_fingerprint = read_value<std::uint64_t>(input);
+        if (!input) {
+            throw std::runtime_error("Invalid query log " + path);
+        }
+        // A record cut short by the process stopping while writing it is ignored
+        while (true) {
+            auto query = LoggedQuery{};
+            query.origin = read_value<std::uint32_t>(input);
+            query.destination = read_value<std::uint32_t>(input);
+            query.departure_time = std::chrono::sys_seconds{std::chrono::seconds{read_value<std::int64_t>(input)}};
+            query.latency = std::chrono::nanoseconds{read_value<std::int64_t>(input)};
+            query.rounds = read_value<std::uint32_t>(input);
+            for (auto* counter : {&query.work.stops_marked, &query.work.routes_scanned,
+                                  &query.work.stop_events_visited, &query.work.trips_searched,
+                                  &query.work.labels_improved, &query.work.transfers_relaxed}) {
+                *counter = read_value<std::uint32_t>(input);
+            }
+            if (!input) {
+                break;
+            }
+            contents.queries.push_back(query);
+        }
+        return contents;
+    }
+}
@@ -0,0 +1,235 @@
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <iomanip>
+
+#include "raptor/query_trace.h"
+#include "schedule/Schedule.h"
+#include "schedule/binary_io.h"
+
+namespace raptor {
+    using binary::read_value;
+    using binary::write_value;
+
+    /**
+     * Identifies the file format. The version is increased whenever the format changes.
+     */
+    constexpr auto trace_magic = std::array{'P', 'T', 'Q', 'T'};
+    constexpr auto trace_version = std::uint32_t{1};
+
+    namespace {
+        /**
+         * Writes the size of a vector followed by its elements, using the given function for each element.
+         */
+        template <typename T, typename F>
+        void write_vector(std::ostream& output, const std::vector<T>& values, F&& write_element) {
+            write_value(output, static_cast<std::uint32_t>(values.size()));
+            for (const auto& value : values) {
+                write_element(value);
+            }
+        }
+
+        /**
+         * Reads a vector written by write_vector, using the given function for each element.
+         */
+        template <typename T, typename F>
+        std::vector<T> read_vector(std::istream& input, F&& read_element) {
+            const auto size = read_value<std::uint32_t>(input);
+            auto values = std::vector<T>{};
+            for (std::uint32_t i = 0; i < size && input; ++i) {
+                values.push_back(read_element());
+            }
+            return values;
+        }
+    }
+
+    void QueryTrace::write(const std::string& path, const Schedule& schedule) const {
+        auto output = std::ofstream(path, std::ios::binary | std::ios::trunc);
+        output.write(trace_magic.data(), trace_magic.size());
+        write_value(output, trace_version);
+        write_value(output, schedule.fingerprint());
+        write_value(output, origin);
+        write_value(output, destination);
+        write_value(output, static_cast<std::int64_t>(departure_time.time_since_epoch().count()));
+        write_vector(output, rounds, [&output, this](const TracedRound& round) {
+            write_vector(output, round.marked_stops, [&output](const std::uint32_t stop) {
+                write_value(output, stop);
+            });
+            write_vector(output, round.routes, [&output](const TracedRoute& route) {
+                write_value(output, route.route);
+                write_value(output, route.hop_on_stop_index);
+            });
+            // Arrival times are stored as seconds after the departure, which always fit in 32 bits
+            write_vector(output, round.labels, [&output, this](const TracedLabel& label) {
+                write_value(output, label.stop);
+                write_value(output, label.from_stop);
+                write_value(output, static_cast<std::uint32_t>((label.arrival_time - departure_time).count()));
+                write_value(output, static_cast<std::uint8_t>(label.reason));
+                write_value(output, label.route);
+            });
+        });
+        if (!output) {
+            throw std::runtime_error("Cannot write query trace " + path);
+        }
+    }
+
+    QueryTrace QueryTrace::read(const std::string& path, const Schedule& schedule) {
+        auto input = std::ifstream(path, std::ios::binary);
+        auto magic = std::array<char, trace_magic.size()>{};
+        input.read(magic.data(), magic.size());
+        if (!input || magic != trace_magic || read_value<std::uint32_t>(input) != trace_version) {
+            throw std::runtime_error("Invalid query trace " + path);
+        }
+        if (read_value<std::uint64_t>(input) != schedule.fingerprint()) {
+            throw std::runtime_error("The query trace " + path + " was written for a different schedule");
+        }
+        auto trace = QueryTrace{};
+        trace.origin = read_value<std::uint32_t>(input);
+        trace.destination = read_value<std::uint32_t>(input);
+        trace.departure_time = std::chrono::sys_seconds{std::chrono::seconds{read_value<std::int64_t>(input)}};
+        trace.rounds = read_vector<TracedRound>(input, [&input, &trace] {
+            auto round = TracedRound{};
+            round.marked_stops = read_vector<std::uint32_t>(input, [&input] {
+                return read_value<std::uint32_t>(input);
+            });
+            round.routes = read_vector<TracedRoute>(input, [&input] {
+                const auto route = read_value<std::uint32_t>(input);
+                return TracedRoute{route, read_value<std::uint32_t>(input)};
+            });
+            round.labels = read_vector<TracedLabel>(input, [&input, &trace] {
+                auto label = TracedLabel{};
+                label.stop = read_value<std::uint32_t>(input);
+                label.from_stop = read_value<std::uint32_t>(input);
+                label.arrival_time = trace.departure_time + std::chrono::seconds{read_value<std::uint32_t>(input)};
+                label.reason = static_cast<LabelReason>(read_value<std::uint8_t>(input));
+                label.route = read_value<std::uint32_t>(input);
+                return label;
+            });
+            return round;
+        });
+        if (!input) {
+            throw std::runtime_error("Invalid query trace " + path);
+        }
+
+        // Indices are checked here, so that the trace can be used without further checks
+        const auto n_stops = schedule.get_stops().size();
+        const auto n_routes = schedule.get_routes().size();
+        const auto valid_stop = [n_stops](const std::uint32_t stop) {
+            return stop < n_stops;
+        };
+        auto valid = valid_stop(trace.origin) && valid_stop(trace.destination);
+        for (const auto& round : trace.rounds) {
+            valid = valid && std::ranges::all_of(round.marked_stops, valid_stop);
+            for (const auto& route : round.routes) {
+                valid = valid && route.route < n_routes &&
+                        route.hop_on_stop_index < schedule.get_routes()[route.route].stop_sequence().size();
+            }
+            for (const auto& label : round.labels) {
+                valid = valid && valid_stop(label.stop) && valid_stop(label.from_stop) &&
+                        (label.reason == LabelReason::Transfer || label.reason == LabelReason::Trip) &&
+                        (label.reason == LabelReason::Transfer || label.route < n_routes);
+            }
+        }
+        if (!valid) {
+            throw std::runtime_error("Invalid query trace " + path);
+        }
+        return trace;
+    }
+
+    namespace {
+        /**
+         * Writes a string as a JSON string literal.
+         */
+        void write_json_string(std::ostream& output, const std::string_view string) {
+            output << '"';
+            for (const auto character : string) {
+                if (character == '"' || character == '\\') {
+                    output << '\\' << character;
+                } else if (static_cast<unsigned char>(character) < 0x20) {
+                    output << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+                            << static_cast<int>(character) << std::dec << std::setfill(' ');
+                } else {
+                    output << character;
+                }
+            }
+            output << '"';
+        }
+
+        /**
+         * Writes the coordinates of a stop as a GeoJSON position, which has the longitude first.
+         */
+        void write_position(std::ostream& output, const Stop& stop) {
+            const auto [latitude, longitude] = stop.get_coordinates();
+            output << '[' << longitude << ',' << latitude << ']';
+        }
+    }
+
+    void QueryTrace::write_geojson(std::ostream& output, const Schedule& schedule) const {
+        const auto& stops = schedule.get_stops();
+        const auto& routes = schedule.get_routes();
+        // Enough digits for positions accurate to about a centimetre
+        const auto previous_precision = output.precision(10);
+        auto first_feature = true;
+        const auto begin_feature = [&](const std::size_t round, const std::string_view kind) {
+            output << (first_feature ? "\n" : ",\n") << R"({"type":"Feature","properties":{"round":)" << round
+                    << R"(,"kind":")" << kind << '"';
+            first_feature = false;
+        };
+        const auto point = [&](const Stop& stop) {
+            output << R"(},"geometry":{"type":"Point","coordinates":)";
+            write_position(output, stop);
+            output << "}}";
+        };
+        const auto stop_property = [&](const std::string_view name, const Stop& stop) {
+            output << ",\"" << name << "\":";
+            write_json_string(output, stop.get_gtfs_id().view());
+        };
+
+        output << R"({"type":"FeatureCollection","features":[)";
+        begin_feature(0, "origin");
+        stop_property("stop", stops[origin]);
+        point(stops[origin]);
+        begin_feature(0, "destination");
+        stop_property("stop", stops[destination]);
+        point(stops[destination]);
+        for (std::size_t round = 0; round < rounds.size(); ++round) {
+            for (const auto stop : rounds[round].marked_stops) {
+                begin_feature(round, "marked_stop");
+                stop_property("stop", stops[stop]);
+                point(stops[stop]);
+            }
+            for (const auto& [route_index, hop_on_stop_index] : rounds[round].routes) {
+                const auto& route = routes[route_index];
+                const auto route_stops = route.stop_sequence();
+                begin_feature(round, "scanned_route");
+                output << R"(,"route":)";
+                write_json_string(output, route.get_gtfs_id().view());
+                stop_property("hop_on_stop", route_stops[hop_on_stop_index]);
+                output << R"(},"geometry":{"type":"LineString","coordinates":[)";
+                for (auto i = hop_on_stop_index; i < route_stops.size(); ++i) {
+                    output << (i == hop_on_stop_index ? "" : ",");
+                    write_position(output, route_stops[i]);
+                }
+                output << "]}}";
+            }
+            for (const auto& label : rounds[round].labels) {
+                begin_feature(round, "label");
+                output << R"(,"reason":")" << (label.reason == LabelReason::Trip ? "trip" : "transfer") << '"';
+                stop_property("stop", stops[label.stop]);
+                stop_property("from_stop", stops[label.from_stop]);
+                if (label.reason == LabelReason::Trip) {
+                    output << R"(,"route":)";
+                    write_json_string(output, routes[label.route].get_gtfs_id().view());
+                }
+                output << R"(,"arrival_seconds":)" << (label.arrival_time - departure_time).count()
+                        << R"(},"geometry":{"type":"LineString","coordinates":[)";
+                write_position(output, stops[label.from_stop]);
+                output << ',';
+                write_position(output, stops[label.stop]);
+                output << "]}}";
+            }
+        }
+        output << "\n]}\n";
+        output.precision(previous_precision);
+    }
+}
@@ -7,23 +7,36 @@
 namespace raptor {
     void Raptor::build_routes_serving_stop() {
         // TODO: See if this can be done with ranges
+        routes_serving_stop.resize(schedule.get_stops().size());
         for (const auto& route : schedule.get_routes()) {
-            // Every trip of a route shares the same stops, so just take the first trip
-            auto& first_trip = route.get_trips().front();
             auto index = 0;
-            for (const auto& stop_time : first_trip.get_stop_times()) {
-                const auto& stop = stop_time.get_stop();
-                routes_serving_stop[stop].emplace_back(route, index);
+            for (const Stop& stop : route.stop_sequence()) {
+                routes_serving_stop[stop.get_index()].emplace_back(route, index);
                 index++;
             }
         }
     }
 
+    MemoryUsage Raptor::memory_usage() const {
+        auto usage = MemoryUsage{"raptor", sizeof(Raptor) - sizeof(TransferManager)};
+        auto& routes_usage = usage.add("routes serving stop", memory::heap_bytes(routes_serving_stop));
+        for (const auto& stop_routes : routes_serving_stop) {
+            routes_usage.bytes += memory::heap_bytes(stop_routes);
+        }
+        usage.add(transfer_manager.memory_usage());
+        return usage;
+    }
+
     Raptor::Raptor(const Schedule& schedule, TransferManager tm) :
         schedule(schedule), transfer_manager(std::move(tm)) {
         build_routes_serving_stop();
     }
 
+    Raptor::Workspace& Raptor::thread_workspace() {
+        thread_local auto workspace = Workspace{};
+        return workspace;
+    }
+
     std::vector<Movement> Raptor::build_trip(const Stop& origin, const Stop& destination,
                                              const LabelManager& stop_labels) {
         auto current_stop = std::cref(destination);
@@ -59,26 +72,41 @@ namespace raptor {
         return journey;
     }
 
-    void Raptor::process_transfers(RaptorState& status) {
-        for (auto& origin_stop : status.get_improved_stops()) {
+    void Raptor::process_transfers(RaptorState& status, const QueryStatsRecorder& stats) {
+        const auto& stops = schedule.get_stops();
+        const auto& improved_stops = status.get_improved_stops();
+        // Stops improved by the transfers are appended, but their transfers are only processed in the next round
+        for (std::size_t i = 0, n_improved = improved_stops.size(); i < n_improved; ++i) {
+            const auto origin_stop = improved_stops[i];
             auto arrival_time_to_origin = status.current_arrival_time_to_stop(origin_stop);
-            for (auto [destination_stop, transfer_time] : transfer_manager.get_transfers_from_stop(origin_stop)) {
+            const auto transfers = transfer_manager.get_transfers_from_stop(origin_stop);
+            stats.add(&RoundStats::transfers_relaxed, transfers.size());
+            for (auto [destination_index, transfer_time] : transfers) {
+                const auto& destination_stop = stops[destination_index];
                 auto arrival_time_with_transfer =
                         std::chrono::zoned_seconds(arrival_time_to_origin.get_time_zone(),
                                                    arrival_time_to_origin.get_sys_time() + transfer_time);
-                status.try_improve_stop_arrival_time(destination_stop, arrival_time_with_transfer, origin_stop, std::nullopt);
+                if (status.try_improve_stop_arrival_time(destination_stop, arrival_time_with_transfer, origin_stop,
+                                                         std::nullopt)) {
+                    stats.add(&RoundStats::labels_improved);
+                    stats.trace_label(destination_index, origin_stop.get().get_index(),
+                                      arrival_time_with_transfer.get_sys_time(), LabelReason::Transfer);
+                }
             }
         }
     }
 
     void Raptor::process_route(const Route& route, const StopIndex hop_on_stop_idx, const Time hop_on_time,
-                               RaptorState& status) {
-        auto hop_on_stop = route.stop_sequence().at(hop_on_stop_idx);
+                               RaptorState& status, const QueryStatsRecorder& stats) {
+        auto hop_on_stop = route.stop_sequence()[hop_on_stop_idx];
         // Find the earliest trip of the route that we can hop on from this stop
         const auto& route_trips = route.get_trips();
-        // TODO: Check with upper_bound
-        if (auto trip = find_earliest_trip(route_trips, hop_on_time, hop_on_stop_idx);
-            trip != route_trips.end()) {
+        const auto fifo = route.is_fifo();
+        auto trip = fifo
+                        ? find_earliest_trip_fifo(route_trips, hop_on_time, hop_on_stop_idx)
+                        : find_earliest_trip(route_trips, hop_on_time, hop_on_stop_idx);
+        stats.add(&RoundStats::trips_searched);
+        if (trip != route_trips.end()) {
             auto current_stop_idx = hop_on_stop_idx + 1;
             auto n_stops = trip->get_stop_times().size();
             auto trip_index = std::distance(route_trips.begin(), trip);
@@ -88,19 +116,29 @@ namespace raptor {
                 const auto& current_stop = current_stoptime.get_stop();
                 const auto current_arrival_time = current_stoptime.get_arrival_time();
                 const auto current_departure_time = current_stoptime.get_departure_time();
+                stats.add(&RoundStats::stop_events_visited);
 
                 // Try to improve the current journey
                 auto improved = status.try_improve_stop_arrival_time(current_stop, current_arrival_time,
                                         hop_on_stop,
                                         std::make_pair(std::cref(route), trip_index));
+                if (improved) {
+                    stats.add(&RoundStats::labels_improved);
+                    stats.trace_label(current_stop.get_index(), hop_on_stop.get().get_index(),
+                                      current_arrival_time.get_sys_time(), LabelReason::Trip, route.get_index());
+                }
                 // If the optimal arrival time is before the current arrival time we might be able to catch
                 // an earlier trip at that stop.
                 // TODO: Check if this works
                 if (!improved && status.might_catch_earlier_trip(current_stop, current_departure_time)) {
+                    const auto previous_arrival_time = status.previous_arrival_time_to_stop(current_stop);
+                    // In a FIFO route only trips up to the current one can depart earlier
                     auto earlier_trip =
-                            find_earliest_trip(route_trips,
-                                               status.previous_arrival_time_to_stop(current_stop),
-                                               current_stop_idx);
+                            fifo
+                                ? find_earliest_trip_fifo(std::ranges::subrange(route_trips.begin(), std::next(trip)),
+                                                          previous_arrival_time, current_stop_idx)
+                                : find_earliest_trip(route_trips, previous_arrival_time, current_stop_idx);
+                    stats.add(&RoundStats::trips_searched);
                     assert(earlier_trip != route_trips.end());
                     // From now on we are following a different trip
                     if (earlier_trip != trip) {
@@ -116,23 +154,52 @@ namespace raptor {
 
 
     std::vector<Movement> Raptor::route(const Stop& origin, const Stop& destination,
-                                        const Time& departure_time) {
-        auto status = RaptorState{origin, destination, departure_time};
+                                        const Time& departure_time, QueryStats* query_stats, QueryTrace* trace) {
+        const auto stats = QueryStatsRecorder{query_stats, trace};
+        stats.trace_query(origin.get_index(), destination.get_index(), departure_time.get_sys_time());
+        auto& workspace = thread_workspace();
+        workspace.earliest_marked_stop.resize(schedule.get_routes().size(), no_marked_stop);
+        auto& status = workspace.state;
+        status.reset(origin, destination, departure_time, schedule.get_stops().size());
         /* Since we don't consider a foot transfer to actually count as a transfer we must process all transfers from
          * the origin stop here, otherwise they will never be processed. */
-        process_transfers(status);
+        stats.new_round();
+        stats.trace_marked_stops(status.get_improved_stops());
+        stats.time(&QueryStats::transfers, [&] {
+            process_transfers(status, stats);
+        });
         while (status.have_stops_to_improve()) {
             status.new_round();
+            stats.new_round();
             // Second stage: Traverse all routes
-            auto current_round_routes = find_routes_to_examine(status.get_and_clear_improved_stops());
-            for (auto& [route, stop_index] : current_round_routes) {
-                auto hop_on_stop = route.get().stop_sequence().at(stop_index);
-                const auto hop_on_time = status.previous_arrival_time_to_stop(hop_on_stop);
-                process_route(route, stop_index, hop_on_time, status);
-            }
+            const auto& current_round_routes = stats.time(&QueryStats::route_collection, [&]() -> const auto& {
+                const auto& improved_stops = status.get_and_clear_improved_stops();
+                stats.add(&RoundStats::stops_marked, improved_stops.size());
+                stats.trace_marked_stops(improved_stops);
+                return find_routes_to_examine(improved_stops, workspace);
+            });
+            stats.add(&RoundStats::routes_scanned, current_round_routes.size());
+            stats.time(&QueryStats::route_scanning, [&] {
+                for (const auto& [route, stop_index] : current_round_routes) {
+                    stats.trace_route(route.get().get_index(), stop_index);
+                    auto hop_on_stop = route.get().stop_sequence()[stop_index];
+                    const auto hop_on_time = status.previous_arrival_time_to_stop(hop_on_stop);
+                    process_route(route, stop_index, hop_on_time, status, stats);
+                }
+            });
             // Third stage: Process transfers
-            process_transfers(status);
+            stats.time(&QueryStats::transfers, [&] {
+                process_transfers(status, stats);
+            });
         }
-        return build_trip(origin, destination, status.get_label_manager());
+        return stats.time(&QueryStats::reconstruction, [&] {
+            return build_trip(origin, destination, status.get_label_manager());
+        });
+    }
+
+    std::vector<Movement> Raptor::route(const std::size_t origin, const std::size_t destination,
+                                        const Time& departure_time, QueryStats* query_stats, QueryTrace* trace) {
+        const auto& stops = schedule.get_stops();
+        return route(stops.at(origin), stops.at(destination), departure_time, query_stats, trace);
     }
 } // namespace raptor
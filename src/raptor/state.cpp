@@ -1,25 +1,47 @@
 #include "raptor/state.h"
 
 namespace raptor {
-    RaptorState::RaptorState(const Stop& origin_stop, const Stop& destination, const Time& departure_time) :
-        destination(destination) {
+    RaptorState::RaptorState(const Stop& origin_stop, const Stop& destination, const Time& departure_time,
+                             const std::size_t n_stops) {
+        reset(origin_stop, destination, departure_time, n_stops);
+    }
+
+    void RaptorState::reset(const Stop& origin_stop, const Stop& destination, const Time& departure_time,
+                            const std::size_t n_stops) {
+        label_manager.reset(n_stops);
+        for (const auto index : reached_stops) {
+            earliest_arrival_time[index].reset();
+        }
+        reached_stops.clear();
+        for (const Stop& stop : improved_stops) {
+            is_improved[stop.get_index()] = false;
+        }
+        improved_stops.clear();
+        marked_stops.clear();
+        earliest_arrival_time.resize(n_stops);
+        is_improved.resize(n_stops);
+        n_round = 0;
+        this->destination = &destination;
+
         // TODO: Remove the need for nullopt boarding_stop
         label_manager.add_label(origin_stop, departure_time, std::nullopt, std::nullopt);
-        earliest_arrival_time[origin_stop] = departure_time;
-        improved_stops.insert(origin_stop);
+        earliest_arrival_time[origin_stop.get_index()] = departure_time;
+        reached_stops.push_back(origin_stop.get_index());
+        is_improved[origin_stop.get_index()] = true;
+        improved_stops.emplace_back(origin_stop);
     }
 
     bool RaptorState::can_improve_current_journey_to_stop(const Time& new_arrival_time,
                                                           const Stop& current_stop) const {
-        auto arrival_time_to_current_stop = earliest_arrival_time.find(current_stop);
-        if (arrival_time_to_current_stop == earliest_arrival_time.end())
+        const auto& arrival_time_to_current_stop = earliest_arrival_time[current_stop.get_index()];
+        if (!arrival_time_to_current_stop.has_value())
             return true;
-        auto arrival_time_to_destination = earliest_arrival_time.find(destination);
-        if (arrival_time_to_destination == earliest_arrival_time.end()) {
-            return new_arrival_time.get_sys_time() < arrival_time_to_current_stop->second.get_sys_time();
+        const auto& arrival_time_to_destination = earliest_arrival_time[destination->get_index()];
+        if (!arrival_time_to_destination.has_value()) {
+            return new_arrival_time.get_sys_time() < arrival_time_to_current_stop->get_sys_time();
         }
-        return new_arrival_time.get_sys_time() < std::min(arrival_time_to_current_stop->second.get_sys_time(),
-                                                          arrival_time_to_destination->second.get_sys_time());
+        return new_arrival_time.get_sys_time() < std::min(arrival_time_to_current_stop->get_sys_time(),
+                                                          arrival_time_to_destination->get_sys_time());
     }
 
     int RaptorState::new_round() {
@@ -39,9 +61,17 @@ namespace raptor {
                                                         std::reference_wrapper<const Route>, TripIndex>>&
                                                     route_with_trip_index) {
         if (can_improve_current_journey_to_stop(new_arrival_time, stop)) {
+            const auto index = stop.get_index();
             label_manager.add_label(stop, new_arrival_time, boarding_stop, route_with_trip_index);
-            earliest_arrival_time[stop] = new_arrival_time;
-            improved_stops.insert(std::cref(stop));
+            auto& earliest_arrival_time_to_stop = earliest_arrival_time[index];
+            if (!earliest_arrival_time_to_stop.has_value()) {
+                reached_stops.push_back(index);
+            }
+            earliest_arrival_time_to_stop = new_arrival_time;
+            if (!is_improved[index]) {
+                is_improved[index] = true;
+                improved_stops.emplace_back(stop);
+            }
             return true;
         }
         return false;
@@ -53,18 +83,21 @@ namespace raptor {
                 previous_journey->arrival_time.get_sys_time() <= departure_time.get_sys_time();
     }
 
-    std::unordered_set<std::reference_wrapper<const Stop>> RaptorState::get_and_clear_improved_stops() {
-        auto old_improved_stops = std::move(improved_stops);
+    const std::vector<std::reference_wrapper<const Stop>>& RaptorState::get_and_clear_improved_stops() {
+        std::swap(marked_stops, improved_stops);
         improved_stops.clear();
-        return old_improved_stops;
+        for (const Stop& stop : marked_stops) {
+            is_improved[stop.get_index()] = false;
+        }
+        return marked_stops;
     }
 
-    std::unordered_set<std::reference_wrapper<const Stop>> RaptorState::get_improved_stops() const {
+    const std::vector<std::reference_wrapper<const Stop>>& RaptorState::get_improved_stops() const {
         return improved_stops;
     }
 
     Time RaptorState::current_arrival_time_to_stop(const Stop& stop) const {
-        return earliest_arrival_time.at(stop);
+        return earliest_arrival_time[stop.get_index()].value();
     }
 
     Time RaptorState::previous_arrival_time_to_stop(const Stop& stop) const {
@@ -1,6 +1,7 @@
 #include "schedule/Schedule.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <ranges>
 #include <boost/container_hash/hash.hpp>
 
@@ -8,13 +9,14 @@ namespace raptor {
 
     void StopManager::initialise_relationships(
             const StationToChildStopsMap& stops_per_station) {
-        auto stop_index = std::unordered_map<std::string, std::reference_wrapper<Stop>>{};
+        // Views of interned strings remain valid, so they can be used as keys without copying the IDs
+        auto stop_index = std::unordered_map<std::string_view, std::reference_wrapper<Stop>>{};
         for (auto& stop: stops) {
-            stop_index.insert({stop.get_gtfs_id(), std::ref(stop)});
+            stop_index.insert({stop.get_gtfs_id().view(), std::ref(stop)});
         }
-        auto station_index = std::unordered_map<std::string, std::reference_wrapper<Station>>{};
+        auto station_index = std::unordered_map<std::string_view, std::reference_wrapper<Station>>{};
         for (auto& station: stations) {
-            station_index.insert({station.get_gtfs_id(), std::ref(station)});
+            station_index.insert({station.get_gtfs_id().view(), std::ref(station)});
         }
 
         for (auto& [station_id, child_stop_ids] : stops_per_station) {
@@ -26,27 +28,229 @@ namespace raptor {
         }
     }
 
-    std::vector<std::reference_wrapper<const Stop>> Route::stop_sequence() const {
-        // All trips have the same stops, so take the stops from the first trip
-        auto stops = std::vector<std::reference_wrapper<const Stop>>{};
-        auto& first_trip = trips.front();
-        stops.reserve(first_trip.get_stop_times().size());
-        std::ranges::transform(first_trip.get_stop_times(), std::back_inserter(stops), [](const StopTime& stop_time) {
-            return std::cref(stop_time.get_stop());
+    namespace {
+        /**
+         * Calculates the distance along a Hilbert curve filling a square grid to the given cell.
+         * @param grid_size Number of cells in each side of the grid. Must be a power of 2.
+         */
+        std::uint64_t hilbert_curve_distance(const std::uint32_t grid_size, std::uint32_t x, std::uint32_t y) {
+            auto distance = std::uint64_t{0};
+            for (auto s = grid_size / 2; s > 0; s /= 2) {
+                const auto rx = (x & s) > 0 ? 1U : 0U;
+                const auto ry = (y & s) > 0 ? 1U : 0U;
+                distance += static_cast<std::uint64_t>(s) * s * ((3 * rx) ^ ry);
+                // Rotate the quadrant, so that the curve inside it has the right orientation
+                if (ry == 0) {
+                    if (rx == 1) {
+                        x = grid_size - 1 - x;
+                        y = grid_size - 1 - y;
+                    }
+                    std::swap(x, y);
+                }
+            }
+            return distance;
+        }
+    }
+
+    void StopManager::order_stops() {
+        if (!stops.empty()) {
+            constexpr auto grid_size = std::uint32_t{1} << 16;
+            auto [min_lat, max_lat] = std::ranges::minmax(stops | std::views::transform([](const Stop& stop) {
+                return stop.get_coordinates().first;
+            }));
+            auto [min_lon, max_lon] = std::ranges::minmax(stops | std::views::transform([](const Stop& stop) {
+                return stop.get_coordinates().second;
+            }));
+            // Map the bounding box of the stops to the grid
+            auto to_cell = [](const double value, const double min, const double max) {
+                if (max <= min) {
+                    return std::uint32_t{0};
+                }
+                return static_cast<std::uint32_t>((value - min) / (max - min) * (grid_size - 1));
+            };
+            auto curve_distance = [&](const Stop& stop) {
+                auto [latitude, longitude] = stop.get_coordinates();
+                return hilbert_curve_distance(grid_size, to_cell(longitude, min_lon, max_lon),
+                                              to_cell(latitude, min_lat, max_lat));
+            };
+            // Ties are broken by the original position, which keeps the order of stops in the same cell
+            auto order = std::vector<std::pair<std::uint64_t, std::size_t>>{};
+            order.reserve(stops.size());
+            for (std::size_t position = 0; const auto& stop : stops) {
+                order.emplace_back(curve_distance(stop), position++);
+            }
+            std::ranges::sort(order);
+            auto ordered_stops = std::deque<Stop>{};
+            for (const auto position : order | std::views::values) {
+                ordered_stops.emplace_back(std::move(stops[position]));
+            }
+            stops = std::move(ordered_stops);
+        }
+        for (std::size_t index = 0; auto& stop : stops) {
+            stop.set_index(index++);
+        }
+    }
+
+    std::vector<Route> Schedule::order_routes(std::vector<Route>&& routes) {
+        auto stop_index = [](const Stop& stop) {
+            return stop.get_index();
+        };
+        std::ranges::stable_sort(routes, [&stop_index](const Route& lhs, const Route& rhs) {
+            return std::ranges::lexicographical_compare(lhs.stop_sequence(), rhs.stop_sequence(), std::less{},
+                                                        stop_index, stop_index);
         });
-        return stops;
+        for (std::size_t index = 0, trip_index = 0; auto& route : routes) {
+            route.index = index++;
+            for (auto& trip : route.trips) {
+                trip.index = trip_index++;
+            }
+        }
+        return std::move(routes);
+    }
+
+    StopPatternStore::PatternId StopPatternStore::add(const StopSequence sequence) {
+        auto& candidates = patterns_by_hash[hash(sequence)];
+        // Compare the contents, since different sequences can have the same hash
+        for (const auto candidate : candidates) {
+            if (std::ranges::equal(get(candidate), sequence)) {
+                return candidate;
+            }
+        }
+        auto pattern_id = patterns.size();
+        patterns.emplace_back(stops.size(), sequence.size());
+        stops.insert(stops.end(), sequence.begin(), sequence.end());
+        candidates.emplace_back(pattern_id);
+        return pattern_id;
+    }
+
+    StopSequence StopPatternStore::get(const PatternId pattern_id) const {
+        auto [offset, length] = patterns.at(pattern_id);
+        return StopSequence{stops}.subspan(offset, length);
+    }
+
+    std::size_t StopPatternStore::hash(const StopSequence sequence) {
+        auto hasher = std::hash<std::reference_wrapper<const Stop>>{};
+        std::size_t seed = 0;
+        for (const auto& stop : sequence) {
+            boost::hash_combine(seed, hasher(stop));
+        }
+        return seed;
+    }
+
+    bool Route::never_overtakes(const Trip& earlier, const Trip& later) {
+        auto is_not_before = [](const StopTime& earlier_stop_time, const StopTime& later_stop_time) {
+            return earlier_stop_time.get_arrival_time().get_sys_time() <=
+                    later_stop_time.get_arrival_time().get_sys_time() &&
+                    earlier_stop_time.get_departure_time().get_sys_time() <=
+                    later_stop_time.get_departure_time().get_sys_time();
+        };
+        return std::ranges::equal(earlier.get_stop_times(), later.get_stop_times(), is_not_before);
+    }
+
+    std::vector<std::vector<Trip>> split_into_fifo_groups(std::vector<Trip>&& trips) {
+        auto groups = std::vector<std::vector<Trip>>{};
+        // Most routes do not contain any overtaking trips, so avoid moving the trips in that case
+        if (std::ranges::adjacent_find(trips, std::not_fn(Route::never_overtakes)) == trips.end()) {
+            groups.emplace_back(std::move(trips));
+            return groups;
+        }
+        for (auto& trip : trips) {
+            auto group = std::ranges::find_if(groups, [&trip](const std::vector<Trip>& group_trips) {
+                return Route::never_overtakes(group_trips.back(), trip);
+            });
+            if (group == groups.end()) {
+                groups.emplace_back().emplace_back(std::move(trip));
+            } else {
+                group->emplace_back(std::move(trip));
+            }
+        }
+        return groups;
     }
 
     size_t Route::hash() const {
-        auto stops = stop_sequence();
-        auto gtfs_route_id = gtfs_id;
-        return hash(stops, gtfs_route_id);
+        return hash(stops, gtfs_id);
     }
 
-    size_t Route::hash(const std::vector<std::reference_wrapper<const Stop>>& stops, const std::string& gtfs_route_id) {
+    size_t Route::hash(const StopSequence stops, const InternedString gtfs_route_id) {
         size_t seed = 0;
-        boost::hash_combine(seed, std::hash<std::vector<std::reference_wrapper<const Stop>>>{}(stops));
-        boost::hash_combine(seed, std::hash<std::string>{}(gtfs_route_id));
+        boost::hash_combine(seed, StopPatternStore::hash(stops));
+        boost::hash_combine(seed, std::hash<InternedString>{}(gtfs_route_id));
+        return seed;
+    }
+
+    MemoryUsage Route::memory_usage() const {
+        auto usage = MemoryUsage{"routes"};
+        usage.add("trips", memory::heap_bytes(trips));
+        auto& stop_times = usage.add("stop times", 0);
+        for (const auto& trip : trips) {
+            stop_times.bytes += memory::heap_bytes(trip.get_stop_times());
+        }
+        return usage;
+    }
+
+    MemoryUsage StopPatternStore::memory_usage() const {
+        auto usage = MemoryUsage{"stop patterns"};
+        usage.add("stops", memory::heap_bytes(stops));
+        usage.add("patterns", memory::heap_bytes(patterns));
+        auto& index = usage.add("index", memory::heap_bytes(patterns_by_hash));
+        for (const auto& candidates : patterns_by_hash | std::views::values) {
+            index.bytes += memory::heap_bytes(candidates);
+        }
+        return usage;
+    }
+
+    MemoryUsage StopManager::memory_usage() const {
+        auto usage = MemoryUsage{"stop manager"};
+        auto& stops_usage = usage.add("stops", memory::heap_bytes(stops));
+        for (const auto& stop : stops) {
+            stops_usage.bytes += stop.heap_bytes();
+        }
+        auto& stations_usage = usage.add("stations", memory::heap_bytes(stations));
+        for (const auto& station : stations) {
+            stations_usage.bytes += station.heap_bytes();
+        }
+        return usage;
+    }
+
+    MemoryUsage Schedule::memory_usage() const {
+        auto usage = MemoryUsage{"schedule", sizeof(Schedule)};
+        auto& agencies_usage = usage.add("agencies", memory::heap_bytes(agencies));
+        for (const auto& agency : agencies) {
+            agencies_usage.bytes += memory::heap_bytes(agency.get_gtfs_id()) + memory::heap_bytes(agency.get_name()) +
+                    memory::heap_bytes(agency.get_url());
+        }
+        usage.add(stop_manager.memory_usage());
+        usage.add(stop_patterns.memory_usage());
+        auto& routes_usage = usage.add("routes", memory::heap_bytes(routes));
+        for (const auto& route : routes) {
+            routes_usage += route.memory_usage();
+        }
+        usage.add("transfers", memory::heap_bytes(transfers));
+        if (string_pool) {
+            usage.add(string_pool->memory_usage());
+        }
+        return usage;
+    }
+
+    std::uint64_t Schedule::fingerprint() const {
+        // Hashes contents rather than addresses, so that the fingerprint is the same in every process
+        auto seed = std::size_t{0};
+        const auto combine_string = [&seed](const std::string_view string) {
+            boost::hash_combine(seed, boost::hash_range(string.begin(), string.end()));
+        };
+        for (const auto& stop : get_stops()) {
+            combine_string(stop.get_gtfs_id().view());
+            boost::hash_combine(seed, stop.get_coordinates());
+        }
+        for (const auto& route : routes) {
+            combine_string(route.get_gtfs_id().view());
+            for (const Stop& stop : route.stop_sequence()) {
+                boost::hash_combine(seed, stop.get_index());
+            }
+            for (const auto& trip : route.get_trips()) {
+                boost::hash_combine(seed, trip.departure_time().get_sys_time().time_since_epoch().count());
+            }
+        }
         return seed;
     }
 }
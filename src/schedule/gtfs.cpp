@@ -1,6 +1,9 @@
 #include <deque>
+#include <future>
 #include <list>
+#include <map>
 #include <ranges>
+#include <stdexcept>
 
 #include "schedule/gtfs.h"
 
@@ -8,20 +11,37 @@
 namespace raptor::gtfs {
 
     using agency_id = std::string;
-    using route_id = std::string;
     using calendar_id = std::string;
     using trip_id = std::string;
 
+    /**
+     * Maps the GTFS ID of each trip to the GTFS ID of the route it belongs to.
+     */
+    using TripToRouteMap = std::unordered_map<InternedString, InternedString>;
+
+
+    /**
+     * Returns the ID with the prefix of its feed prepended.
+     */
+    std::string namespaced_id(const std::string_view id_prefix, const std::string_view id) {
+        auto result = std::string{};
+        result.reserve(id_prefix.size() + id.size());
+        result.append(id_prefix).append(id);
+        return result;
+    }
 
     /**
      * Create Agency objects from the given GTFS agencies.
+     * @param id_prefix Prefix added to the IDs of the agencies.
      */
-    std::deque<Agency> from_gtfs(const ::gtfs::Agencies& gtfs_agencies) {
+    std::deque<Agency> from_gtfs(const ::gtfs::Agencies& gtfs_agencies, const std::string_view id_prefix) {
         std::deque<Agency> agencies;
-        std::ranges::transform(gtfs_agencies, std::back_inserter(agencies), [](const ::gtfs::Agency& gtfs_agency) {
+        std::ranges::transform(gtfs_agencies, std::back_inserter(agencies),
+                               [id_prefix](const ::gtfs::Agency& gtfs_agency) {
             // TODO: Handle wrong timezone. But is this likely to happen?
             auto time_zone = std::chrono::locate_zone(gtfs_agency.agency_timezone);
-            return Agency(gtfs_agency.agency_id, gtfs_agency.agency_name, gtfs_agency.agency_url, time_zone);
+            return Agency(namespaced_id(id_prefix, gtfs_agency.agency_id), gtfs_agency.agency_name,
+                          gtfs_agency.agency_url, time_zone);
         });
         return agencies;
     }
@@ -29,28 +49,28 @@ namespace raptor::gtfs {
     /**
      * Creates a specific instantiation of a GTFS trip.
      * While GTFS objects are
-     * @param gtfs_trip GTFS trip.
+     * @param trip_gtfs_id Interned GTFS ID of the trip.
+     * @param shape_gtfs_id Interned GTFS ID of the trip's shape.
      * @param gtfs_stop_times GTFS stop times for the given trip.
-     * @param service_day Day for the created stop time object. GTFS service days are slightly different from normal
-     * days so the resulting stop times might be on a different day.
-     * @param time_zone Time zone of the values in the stop_times.
+     * @param time_converter Converter for the service day of the trip. GTFS service days are slightly different from
+     * normal days so the resulting stop times might be on a different day.
      * @param stop_index Map of GTFS stop IDs to the corresponding Stop objects.
      * @return The resulting stop times in the trips contain references to the stops in the index. Ensure proper
      * ownership.
      */
-    Trip from_gtfs(const ::gtfs::Trip& gtfs_trip,
+    Trip from_gtfs(const InternedString trip_gtfs_id, const InternedString shape_gtfs_id,
                    const std::vector<std::reference_wrapper<const ::gtfs::StopTime>>& gtfs_stop_times,
-                   const std::chrono::year_month_day& service_day, const std::chrono::time_zone* time_zone,
+                   const ServiceDayTimeConverter& time_converter,
                    const reference_index<stop_id, const Stop>& stop_index) {
         auto stop_times = std::vector<StopTime>{};
         stop_times.reserve(gtfs_stop_times.size());
         // Convert all the gtfs stop times to raptor stop times
         std::ranges::transform(gtfs_stop_times, std::back_inserter(stop_times),
-                               [service_day, time_zone, &stop_index](const ::gtfs::StopTime& stop_time) {
+                               [&time_converter, &stop_index](const ::gtfs::StopTime& stop_time) {
                                    auto& stop = stop_index.at(stop_time.stop_id);
-                                   return from_gtfs(stop_time, service_day, time_zone, stop);
+                                   return from_gtfs(stop_time, time_converter, stop);
                                });
-        return {std::move(stop_times), gtfs_trip.trip_id, gtfs_trip.shape_id};
+        return {std::move(stop_times), trip_gtfs_id, shape_gtfs_id};
     }
 
     /**
@@ -78,131 +98,386 @@ namespace raptor::gtfs {
      * @param services Map of GTFS service ids to the corresponding Service objects.
      * @param gtfs_stop_times The GTFS stop times that will be assigned to the trips.
      * @param time_zone Time zone for all the stop times.
-     * @param stop_index Map from a stop's GTFS ID to the stop object.
+     * @param stop_index Map from a stop's GTFS ID, as given in the feed, to the stop object.
+     * @param id_prefix Prefix added to the trip, shape and route IDs.
+     * @param stats Recorder for the grouping and instantiation phases.
      * @return
      */
-    std::pair<std::vector<Trip>, std::unordered_map<trip_id, route_id>>
+    std::pair<std::vector<Trip>, TripToRouteMap>
     from_gtfs(
             const ::gtfs::Trips& gtfs_trips,
             const std::unordered_map<std::string, Service>& services,
             const ::gtfs::StopTimes& gtfs_stop_times,
             const std::chrono::time_zone* time_zone,
-            const reference_index<std::string, const Stop>& stop_index) {
+            const reference_index<stop_id, const Stop>& stop_index,
+            const std::string_view id_prefix,
+            const ImportStatsRecorder& stats) {
         // Group stop times by the corresponding trip id
-        auto stop_times_by_trip = group_stop_times_by_trip(gtfs_stop_times, gtfs_trips.size());
+        auto stop_times_by_trip = stats.measure("stop time grouping", [&] {
+            return group_stop_times_by_trip(gtfs_stop_times, gtfs_trips.size());
+        });
         // Create a corresponding trip object for each day of the service
         // In addition, maintain a map for the route each trip belongs to
         auto trips = std::vector<Trip>{};
-        auto trip_id_to_route_id = std::unordered_map<trip_id, route_id>{};
+        auto trip_id_to_route_id = TripToRouteMap{};
+        // Time zone information is computed once for every service day and shared by all trips on that day
+        auto time_converters = std::map<std::chrono::year_month_day, ServiceDayTimeConverter>{};
         trips.reserve(gtfs_trips.size());
-        for (const auto& trip : gtfs_trips) {
-            auto& service = services.at(trip.service_id);
-            auto& stop_times = stop_times_by_trip.at(trip.trip_id);
-            std::ranges::transform(service.get_active_days(), std::back_inserter(trips),
-                                   [&trip, &time_zone, &stop_times, &stop_index, &trip_id_to_route_id](
-                                   const std::chrono::year_month_day& service_day) {
-                                       auto trip_id = trip.trip_id;
-                                       auto route_id = trip.route_id;
-                                       trip_id_to_route_id[trip_id] = route_id;
-                                       return from_gtfs(trip, stop_times, service_day, time_zone, stop_index);
-                                   });
-        }
+        trip_id_to_route_id.reserve(gtfs_trips.size());
+        stats.measure("trip instantiation", [&] {
+            for (const auto& trip : gtfs_trips) {
+                auto& service = services.at(trip.service_id);
+                auto& stop_times = stop_times_by_trip.at(trip.trip_id);
+                // Intern the IDs once, every instance of the trip shares them
+                auto trip_gtfs_id = InternedString(namespaced_id(id_prefix, trip.trip_id));
+                auto shape_gtfs_id = trip.shape_id.empty()
+                                         ? InternedString{}
+                                         : InternedString(namespaced_id(id_prefix, trip.shape_id));
+                trip_id_to_route_id.insert_or_assign(trip_gtfs_id,
+                                                     InternedString(namespaced_id(id_prefix, trip.route_id)));
+                std::ranges::transform(service.get_active_days(), std::back_inserter(trips),
+                                       [trip_gtfs_id, shape_gtfs_id, &time_zone, &time_converters, &stop_times,
+                                           &stop_index](const std::chrono::year_month_day& service_day) {
+                                           auto& time_converter = time_converters.try_emplace(
+                                                   service_day, service_day, time_zone).first->second;
+                                           return from_gtfs(trip_gtfs_id, shape_gtfs_id, stop_times, time_converter,
+                                                            stop_index);
+                                       });
+            }
+        });
         // If move is not specified a copy happens here
         return {std::move(trips), std::move(trip_id_to_route_id)};
     }
 
+    /**
+     * Identifies a Raptor route by the ID of its stop sequence and its GTFS route ID.
+     */
+    using RouteKey = std::pair<StopPatternStore::PatternId, InternedString>;
+
     /**
      * Groups the given trips by route.
-     * Two trips belong in the same route if they have the same stop order and the same route ID.
+     * Two trips belong in the same route if they have exactly the same stop sequence and the same route ID.
      * @param trips Collection of Raptor trip objects. Ownership of the trips in the vector is transferred
      * to the returned map.
      * @param trip_id_to_route_id Map matching the GTFS trip ID to the GTFS route ID for each route.
-     * @return Map matching the Raptor route hash to a vector of trips belonging to it.
+     * @param stop_patterns Store to which the stop sequence of each trip is added.
+     * @return Map matching the key of each Raptor route to a vector of trips belonging to it.
      */
-    std::unordered_map<size_t, std::vector<Trip>>
-    group_trips_by_route(std::vector<Trip>&& trips, const std::unordered_map<trip_id, route_id>& trip_id_to_route_id) {
+    std::map<RouteKey, std::vector<Trip>>
+    group_trips_by_route(std::vector<Trip>&& trips, const TripToRouteMap& trip_id_to_route_id,
+                         StopPatternStore& stop_patterns) {
         // Each raptor route is considered unique if it contains the same stops and corresponds to the same gtfs id
-        auto route_map = std::unordered_map<size_t, std::vector<Trip>>{};
+        auto route_map = std::map<RouteKey, std::vector<Trip>>{};
+        auto stops = std::vector<std::reference_wrapper<const Stop>>{};
+        // Instances of the same GTFS trip are adjacent and visit the same stops, so the route is only looked up once
+        // for all of them.
+        auto previous_trip_id = InternedString{};
+        std::vector<Trip>* route_trips = nullptr;
         for (auto& trip : trips) {
-            // Calculate the hash of the trip
-            // Create a vector of stops
-            auto stops = std::vector<std::reference_wrapper<const Stop>>{};
-            stops.reserve(trip.get_stop_times().size());
-            std::ranges::transform(trip.get_stop_times(), std::back_inserter(stops),
-                                   [](const StopTime& st) {
-                                       return std::cref(st.get_stop());
-                                   });
-            auto& route_id = trip_id_to_route_id.at(trip.get_trip_gtfs_id());
-            auto hash = Route::hash(stops, route_id);
-            route_map[hash].emplace_back(std::move(trip));
+            if (route_trips == nullptr || trip.get_trip_gtfs_id() != previous_trip_id) {
+                stops.clear();
+                std::ranges::transform(trip.get_stop_times(), std::back_inserter(stops),
+                                       [](const StopTime& st) {
+                                           return std::cref(st.get_stop());
+                                       });
+                auto pattern_id = stop_patterns.add(stops);
+                auto route_id = trip_id_to_route_id.at(trip.get_trip_gtfs_id());
+                route_trips = &route_map[{pattern_id, route_id}];
+                previous_trip_id = trip.get_trip_gtfs_id();
+            }
+            route_trips->emplace_back(std::move(trip));
         }
         return route_map;
     }
 
+    /**
+     * GTFS information of a route and the agency operating it.
+     */
+    struct RouteDetails {
+        std::reference_wrapper<const ::gtfs::Route> gtfs_route;
+        std::reference_wrapper<const Agency> agency;
+    };
+
+    /**
+     * Maps the namespaced GTFS ID of each route to its details.
+     */
+    using RouteDetailsIndex = std::unordered_map<InternedString, RouteDetails>;
+
+    /**
+     * Adds the routes of a feed to the index.
+     * @param agencies Agencies of all feeds, with namespaced IDs.
+     * @param id_prefix Prefix of the feed's IDs.
+     */
+    void add_route_details(const ::gtfs::Routes& gtfs_routes, const reference_index<std::string_view, const Agency>&
+                           agencies_index, const std::string_view id_prefix, RouteDetailsIndex& route_details) {
+        for (const auto& gtfs_route : gtfs_routes) {
+            auto& agency = agencies_index.at(namespaced_id(id_prefix, gtfs_route.agency_id));
+            route_details.insert_or_assign(InternedString(namespaced_id(id_prefix, gtfs_route.route_id)),
+                                           RouteDetails{std::cref(gtfs_route), agency});
+        }
+    }
+
     /**
      * Creates Route objects using existing Trip objects and the GTFS route information.
      * @param trips Vector of Trip objects that will be assigned to the routes.
      * @param trip_id_to_route_id Map matching each trip's GTFS ID to the corresponding route's GTFS ID.
-     * @param gtfs_routes GTFS Route objects, used for getting additional information about the routes.
+     * @param route_details GTFS information and agency of each route, used for getting additional information about
+     * the routes.
+     * @param stop_patterns Store for the stop sequences of the routes. The created routes refer to the sequences in
+     * it, so it must outlive them.
+     * @param stats Recorder for the route grouping and route construction phases.
      * @return
      */
     std::vector<Route> from_gtfs(std::vector<Trip>&& trips,
-                                 const std::unordered_map<trip_id, route_id>& trip_id_to_route_id,
-                                 const std::deque<Agency>& agencies,
-                                 const ::gtfs::Routes& gtfs_routes) {
-        auto gtfs_route_index = create_index(gtfs_routes, [](const ::gtfs::Route& route) {
-            return route.route_id;
-        });
-        auto agencies_index = create_index(agencies, [](const Agency& agency) {
-            return agency.get_gtfs_id();
+                                 const TripToRouteMap& trip_id_to_route_id,
+                                 const RouteDetailsIndex& route_details,
+                                 StopPatternStore& stop_patterns,
+                                 const ImportStatsRecorder& stats) {
+        auto route_map = stats.measure("route grouping", [&] {
+            return group_trips_by_route(std::move(trips), trip_id_to_route_id, stop_patterns);
         });
-        auto route_map = group_trips_by_route(std::move(trips), trip_id_to_route_id);
-        // Create the actual route objects
+        // Create the actual route objects. All patterns have been added, so views to them remain valid from now on.
         auto routes = std::vector<Route>{};
         routes.reserve(route_map.size());
-        for (auto& route_trips : route_map | std::views::values) {
-            // TODO: All trips for the same route should have the same gtfs id. Hash collisions?
-            auto& route_gtfs_id = trip_id_to_route_id.at(route_trips[0].get_trip_gtfs_id());
-            auto& gtfs_route = gtfs_route_index.at(route_gtfs_id);
-            auto& agency = agencies_index.at(gtfs_route.get().agency_id);
-
-            // TODO: Check performance.
-            std::ranges::sort(route_trips, std::less{}, [](const Trip& trip) {
-                return trip.get_stop_times()[0].get_departure_time().get_sys_time();
-            });
-            route_trips.shrink_to_fit();
+        stats.measure("route construction", [&] {
+            for (auto& [route_key, route_trips] : route_map) {
+                auto [pattern_id, route_gtfs_id] = route_key;
+                auto& [gtfs_route, agency] = route_details.at(route_gtfs_id);
 
-            auto& short_name = gtfs_route.get().route_short_name;
-            auto& long_name = gtfs_route.get().route_long_name;
-            routes.emplace_back(std::move(route_trips), short_name, long_name, route_gtfs_id, agency);
-        }
+                // TODO: Check performance.
+                std::ranges::sort(route_trips, std::less{}, [](const Trip& trip) {
+                    return trip.get_stop_times()[0].get_departure_time().get_sys_time();
+                });
+
+                auto& short_name = gtfs_route.get().route_short_name;
+                auto& long_name = gtfs_route.get().route_long_name;
+                // Trips which overtake each other are placed in separate routes, so every route is FIFO
+                for (auto& fifo_trips : split_into_fifo_groups(std::move(route_trips))) {
+                    fifo_trips.shrink_to_fit();
+                    routes.emplace_back(std::move(fifo_trips), stop_patterns.get(pattern_id), short_name, long_name,
+                                        route_gtfs_id, agency.get());
+                }
+            }
+        });
         return routes;
     }
 
+    /**
+     * Copies the stops of all feeds, prefixing their IDs.
+     */
+    ::gtfs::Stops namespaced_stops(const std::vector<NamespacedFeed>& feeds) {
+        auto n_stops = std::size_t{0};
+        for (const auto& [feed, id_prefix] : feeds) {
+            n_stops += feed.get().get_stops().size();
+        }
+        auto gtfs_stops = ::gtfs::Stops{};
+        gtfs_stops.reserve(n_stops);
+        for (const auto& [feed, id_prefix] : feeds) {
+            for (auto gtfs_stop : feed.get().get_stops()) {
+                gtfs_stop.stop_id = namespaced_id(id_prefix, gtfs_stop.stop_id);
+                if (!gtfs_stop.parent_station.empty()) {
+                    gtfs_stop.parent_station = namespaced_id(id_prefix, gtfs_stop.parent_station);
+                }
+                gtfs_stops.emplace_back(std::move(gtfs_stop));
+            }
+        }
+        return gtfs_stops;
+    }
+
+    /**
+     * Creates an index from the IDs used inside a feed to the stops or stations of the merged schedule.
+     * @param merged_index Index of all stops or stations by their namespaced IDs.
+     */
+    template <typename T>
+    reference_index<stop_id, const T> create_feed_index(const NamespacedFeed& namespaced_feed,
+                                                        const reference_index<stop_id, const T>& merged_index) {
+        auto& [feed, id_prefix] = namespaced_feed;
+        if (id_prefix.empty()) {
+            return merged_index;
+        }
+        auto feed_index = reference_index<stop_id, const T>{};
+        feed_index.reserve(feed.get().get_stops().size());
+        for (const auto& gtfs_stop : feed.get().get_stops()) {
+            // Locations of other types are not part of the index
+            if (auto item = merged_index.find(namespaced_id(id_prefix, gtfs_stop.stop_id)); item != merged_index.
+                end()) {
+                feed_index.emplace(gtfs_stop.stop_id, item->second);
+            }
+        }
+        return feed_index;
+    }
+
+    /**
+     * Schedule objects created from a single feed.
+     */
+    struct FeedObjects {
+        std::vector<Trip> trips;
+        TripToRouteMap trip_id_to_route_id;
+        std::vector<StopTransfer> transfers;
+        std::size_t n_services;
+    };
+
     Schedule from_gtfs(const ::gtfs::Feed& feed,
                        const std::optional<std::chrono::year_month_day>& from_date,
-                       const std::optional<std::chrono::year_month_day>& to_date) {
+                       const std::optional<std::chrono::year_month_day>& to_date,
+                       ImportStats* import_stats) {
+        return from_gtfs(std::vector{NamespacedFeed{std::cref(feed), ""}}, from_date, to_date, import_stats);
+    }
+
+    Schedule from_gtfs(const std::vector<NamespacedFeed>& feeds,
+                       const std::optional<std::chrono::year_month_day>& from_date,
+                       const std::optional<std::chrono::year_month_day>& to_date,
+                       ImportStats* import_stats) {
+        if (feeds.empty()) {
+            throw std::invalid_argument("At least one GTFS feed is required");
+        }
+        const auto stats = ImportStatsRecorder{import_stats};
+        // IDs and names are interned in a pool owned by the schedule, so that they are freed with it
+        auto string_pool = std::make_shared<StringPool>();
+        const auto string_pool_scope = StringPool::Scope{*string_pool};
         // TODO: Add day limit
-        // TODO: Get the timezone from each agency
-        auto agencies = from_gtfs(feed.get_agencies());
-        auto timezone = agencies.front().get_time_zone();
-
-        // TODO: Avoid duplication of stop objects by consuming the GTFS feed.
-        auto feed_stops = feed.get_stops();
-        auto stop_manager = from_gtfs(std::move(feed_stops));
-        auto& stops = stop_manager.get_stops();
-
-        auto services = from_gtfs(feed.get_calendar(), feed.get_calendar_dates(),
-                                  from_date, to_date);
-        // Group stop times by trip
-        auto& gtfs_times = feed.get_stop_times();
-        // Assemble trips from the services
-        auto stop_index = create_index(stops, [](const Stop& stop) {
-            return stop.get_gtfs_id();
+        auto agencies = std::deque<Agency>{};
+        auto agencies_index = stats.measure("agencies", [&] {
+            for (const auto& [feed, id_prefix] : feeds) {
+                std::ranges::move(from_gtfs(feed.get().get_agencies(), id_prefix), std::back_inserter(agencies));
+            }
+            return create_index(agencies, [](const Agency& agency) {
+                return std::string_view(agency.get_gtfs_id());
+            });
         });
-        auto [trips, trip_id_to_route_id] =
-                from_gtfs(feed.get_trips(), services, gtfs_times, timezone, stop_index);
-        auto routes = from_gtfs(std::move(trips), trip_id_to_route_id, agencies, feed.get_routes());
-        return {std::move(agencies), std::move(stop_manager), std::move(routes)};
+
+        // Stops of all feeds are managed together, so that stations and transfers can span feeds
+        auto stop_manager = stats.measure("stops and stations", [&] {
+            return from_gtfs(namespaced_stops(feeds));
+        });
+        auto stop_index = stats.measure("stops and stations", [&] {
+            return create_index(stop_manager.get_stops(), [](const Stop& stop) {
+                return stop.get_gtfs_id().view();
+            });
+        });
+        auto station_index = stats.measure("stops and stations", [&] {
+            return create_index(stop_manager.get_stations(), [](const Station& station) {
+                return station.get_gtfs_id().view();
+            });
+        });
+        stats.set(&ImportStats::stations, stop_manager.get_stations().size());
+
+        // Trips of different feeds are independent, so they are instantiated in parallel. When recording statistics,
+        // feeds are processed one at a time instead, so that the memory allocated in each phase can be measured.
+        const auto launch_policy = stats.recording() ? std::launch::deferred : std::launch::async;
+        auto feed_objects = std::vector<std::future<FeedObjects>>{};
+        feed_objects.reserve(feeds.size());
+        for (const auto& namespaced_feed : feeds) {
+            feed_objects.emplace_back(std::async(launch_policy, [&namespaced_feed, &stop_index, &station_index,
+                                                     &from_date, &to_date, &stats, &string_pool] {
+                const auto feed_string_pool_scope = StringPool::Scope{*string_pool};
+                auto& [feed, id_prefix] = namespaced_feed;
+                // TODO: Get the timezone from each agency
+                auto time_zone = std::chrono::locate_zone(feed.get().get_agencies().front().agency_timezone);
+                auto services = stats.measure("calendars", [&] {
+                    return from_gtfs(feed.get().get_calendar(), feed.get().get_calendar_dates(), from_date, to_date);
+                });
+                auto feed_stop_index = stats.measure("stops and stations", [&] {
+                    return create_feed_index(namespaced_feed, stop_index);
+                });
+                auto feed_station_index = stats.measure("stops and stations", [&] {
+                    return create_feed_index(namespaced_feed, station_index);
+                });
+                auto [trips, trip_id_to_route_id] = from_gtfs(feed.get().get_trips(), services,
+                                                              feed.get().get_stop_times(), time_zone,
+                                                              feed_stop_index, id_prefix, stats);
+                auto transfers = stats.measure("transfers", [&] {
+                    return from_gtfs(feed.get().get_transfers(), feed.get().get_pathways(), feed_stop_index,
+                                     feed_station_index);
+                });
+                return FeedObjects{std::move(trips), std::move(trip_id_to_route_id), std::move(transfers),
+                                   services.size()};
+            }));
+        }
+
+        auto route_details = RouteDetailsIndex{};
+        for (const auto& [feed, id_prefix] : feeds) {
+            add_route_details(feed.get().get_routes(), agencies_index, id_prefix, route_details);
+        }
+
+        auto trips = std::vector<Trip>{};
+        auto trip_id_to_route_id = TripToRouteMap{};
+        auto transfers = std::vector<StopTransfer>{};
+        auto n_services = std::size_t{0};
+        for (auto& result : feed_objects) {
+            auto [single_feed_trips, single_feed_trip_routes, single_feed_transfers, single_feed_services] =
+                    result.get();
+            if (trips.empty()) {
+                trips = std::move(single_feed_trips);
+            } else {
+                std::ranges::move(single_feed_trips, std::back_inserter(trips));
+            }
+            trip_id_to_route_id.merge(single_feed_trip_routes);
+            std::ranges::move(single_feed_transfers, std::back_inserter(transfers));
+            n_services += single_feed_services;
+        }
+
+        auto stop_patterns = StopPatternStore{};
+        auto routes = from_gtfs(std::move(trips), trip_id_to_route_id, route_details, stop_patterns, stats);
+        stats.set(&ImportStats::stop_patterns, stop_patterns.size());
+        auto schedule = stats.measure("schedule", [&] {
+            return Schedule{std::move(agencies), std::move(stop_manager), std::move(stop_patterns), std::move(routes),
+                            std::move(transfers), std::move(string_pool)};
+        });
+
+        if (stats.recording()) {
+            stats.set(&ImportStats::agencies, schedule.get_agencies().size());
+            stats.set(&ImportStats::stops, schedule.get_stops().size());
+            stats.set(&ImportStats::services, n_services);
+            stats.set(&ImportStats::routes, schedule.get_routes().size());
+            stats.set(&ImportStats::transfers, schedule.get_transfers().size());
+            auto n_trips = std::size_t{0};
+            auto n_stop_times = std::size_t{0};
+            for (const auto& route : schedule.get_routes()) {
+                n_trips += route.get_trips().size();
+                n_stop_times += route.get_trips().size() * route.stop_sequence().size();
+            }
+            stats.set(&ImportStats::trips, n_trips);
+            stats.set(&ImportStats::stop_times, n_stop_times);
+            stats.set(&ImportStats::peak_resident_bytes, memory::peak_resident_bytes());
+        }
+        return schedule;
+    }
+
+    Schedule from_gtfs(const std::vector<FeedSource>& sources,
+                       const std::optional<std::chrono::year_month_day>& from_date,
+                       const std::optional<std::chrono::year_month_day>& to_date,
+                       ImportStats* import_stats) {
+        // The statistics are reset when the schedule is built, so parsing is recorded separately and added after
+        auto parsing_stats = ImportStats{};
+        const auto stats = ImportStatsRecorder{import_stats != nullptr ? &parsing_stats : nullptr};
+        // Feeds are stored in a deque, so that references to them remain valid
+        auto feeds = std::deque<::gtfs::Feed>{};
+        auto namespaced_feeds = std::vector<NamespacedFeed>{};
+        stats.measure("feed parsing", [&] {
+            // Parsing the files of each feed is independent, so they are read in parallel
+            auto feed_futures = std::vector<std::future<::gtfs::Feed>>{};
+            feed_futures.reserve(sources.size());
+            for (const auto& source : sources) {
+                feed_futures.emplace_back(std::async(std::launch::async, [&source] {
+                    auto feed = ::gtfs::Feed(source.path);
+                    if (auto result = feed.read_feed(); result.code != ::gtfs::ResultCode::OK) {
+                        throw std::runtime_error("Could not read GTFS feed " + source.path + ": " + result.message);
+                    }
+                    return feed;
+                }));
+            }
+            namespaced_feeds.reserve(sources.size());
+            for (auto i = 0U; i < sources.size(); ++i) {
+                auto& feed = feeds.emplace_back(feed_futures[i].get());
+                namespaced_feeds.push_back({std::cref(feed), sources[i].id_prefix});
+            }
+        });
+        auto schedule = from_gtfs(namespaced_feeds, from_date, to_date, import_stats);
+        if (import_stats != nullptr) {
+            import_stats->phases.insert(import_stats->phases.begin(), parsing_stats.phases.begin(),
+                                        parsing_stats.phases.end());
+        }
+        return schedule;
     }
 }
@@ -103,7 +103,10 @@ namespace raptor::gtfs {
                              gtfs_stop.platform_code, std::move(stop_boarding_areas));
             auto& inserted_stop = stops.emplace_back(std::move(stop));
             auto& parent_station_id = gtfs_stop.parent_station;
-            station_to_child_stops[parent_station_id].emplace_back(inserted_stop.get_gtfs_id());
+            // Stops without a parent station are not part of any station
+            if (!parent_station_id.empty()) {
+                station_to_child_stops[parent_station_id].emplace_back(inserted_stop.get_gtfs_id());
+            }
         }
         return {std::move(stops), std::move(station_to_child_stops)};
     }
@@ -26,14 +26,58 @@ namespace raptor::gtfs {
         return time;
     }
 
+    ServiceDayTimeConverter::ServiceDayTimeConverter(const std::chrono::year_month_day& service_day,
+                                                     const std::chrono::time_zone* time_zone) :
+        service_day_start(std::chrono::local_days(service_day)), time_zone(time_zone) {
+        using namespace std::chrono_literals;
+        // UTC offsets are always less than a day, so interpreting the local times as UTC and extending the period by
+        // a day on each side covers every time point of the service day. GTFS times can go past 24:00, so cover two
+        // days after the start of the service day.
+        const auto covered_start = std::chrono::sys_seconds{service_day_start.time_since_epoch() - 24h};
+        const auto covered_end = std::chrono::sys_seconds{service_day_start.time_since_epoch() + 72h};
+        auto info = time_zone->get_info(covered_start);
+        offset_intervals.emplace_back(info.begin, info.end, info.offset);
+        while (info.end < covered_end) {
+            info = time_zone->get_info(info.end);
+            offset_intervals.emplace_back(info.begin, info.end, info.offset);
+        }
+    }
+
+    Time ServiceDayTimeConverter::to_time(const Time::duration since_service_day_start) const {
+        const auto local_time = service_day_start + since_service_day_start;
+        // Intervals are sorted, so the first interval containing the time gives the earliest time.
+        for (auto interval = offset_intervals.begin(); interval != offset_intervals.end(); ++interval) {
+            const auto utc_time = std::chrono::sys_seconds{local_time.time_since_epoch() - interval->offset};
+            if (utc_time < interval->begin) {
+                if (interval == offset_intervals.begin()) {
+                    break;
+                }
+                // The local time was skipped by the transition between the previous interval and this one.
+                return {time_zone, interval->begin};
+            }
+            if (utc_time < interval->end) {
+                return {time_zone, utc_time};
+            }
+        }
+        // Outside the precomputed period, fall back to the time zone database
+        return {time_zone, local_time, std::chrono::choose::earliest};
+    }
+
+    Time ServiceDayTimeConverter::to_time(const ::gtfs::Time& gtfs_time) const {
+        return to_time(gtfs_time_to_duration(gtfs_time));
+    }
+
+    /**
+     * Checks if two GTFS times are equal.
+     */
+    bool time_equal(const ::gtfs::Time& time_a, const ::gtfs::Time& time_b) {
+        auto [a_hours, a_minutes, a_seconds] = time_a.get_hh_mm_ss();
+        auto [b_hours, b_minutes, b_seconds] = time_b.get_hh_mm_ss();
+        return (a_hours == b_hours) && (a_minutes == b_minutes) && (a_seconds == b_seconds);
+    }
+
     StopTime from_gtfs(const ::gtfs::StopTime& stop_time, const std::chrono::year_month_day& service_day,
                        const std::chrono::time_zone* time_zone, const Stop& stop) {
-        auto time_equal = [](const ::gtfs::Time& time_a, const ::gtfs::Time& time_b) {
-            auto [a_hours, a_minutes, a_seconds] = time_a.get_hh_mm_ss();
-            auto [b_hours, b_minutes, b_seconds] = time_b.get_hh_mm_ss();
-            return (a_hours == b_hours) && (a_minutes == b_minutes) && (a_seconds == b_seconds);
-        };
-
         // Often the departure time is the same as the arrival time. In this case we can skip the creation of an
         // extra object and create just a copy instead.
         // This is probably feed dependent, but if this happens, this optimization increases performance.
@@ -46,4 +90,15 @@ namespace raptor::gtfs {
         return {arrival_time, departure_time, std::cref(stop)};
 
     }
+
+    StopTime from_gtfs(const ::gtfs::StopTime& stop_time, const ServiceDayTimeConverter& converter,
+                       const Stop& stop) {
+        auto departure_time = converter.to_time(stop_time.departure_time);
+        if (time_equal(stop_time.departure_time, stop_time.arrival_time)) {
+            auto arrival_time = departure_time;
+            return {arrival_time, departure_time, std::cref(stop)};
+        }
+        auto arrival_time = converter.to_time(stop_time.arrival_time);
+        return {arrival_time, departure_time, std::cref(stop)};
+    }
 }
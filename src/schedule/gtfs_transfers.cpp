@@ -0,0 +1,157 @@
+#include <cmath>
+#include <queue>
+#include <ranges>
+#include <set>
+
+#include "schedule/gtfs.h"
+
+namespace raptor::gtfs {
+
+    /**
+     * Walking speed used for pathways which only have a length, in metres per second.
+     */
+    constexpr auto pathway_walking_speed_m_s = 1.3;
+
+    namespace {
+        /**
+         * Returns the stops referred to by the given ID. A station ID refers to all the stops of the station.
+         * @return The stops, or an empty vector if the ID refers to neither a stop nor a station.
+         */
+        std::vector<std::reference_wrapper<const Stop>> resolve_stops(
+                const std::string_view location_id,
+                const reference_index<stop_id, const Stop>& stop_index,
+                const reference_index<stop_id, const Station>& station_index) {
+            if (const auto stop = stop_index.find(location_id); stop != stop_index.end()) {
+                return {stop->second};
+            }
+            if (const auto station = station_index.find(location_id); station != station_index.end()) {
+                return station->second.get().get_stops();
+            }
+            return {};
+        }
+
+        StopTransfer::Type from_gtfs(const ::gtfs::TransferType transfer_type) {
+            // Values are defined by the GTFS specification
+            switch (static_cast<int>(transfer_type)) {
+                case 1:
+                    return StopTransfer::Type::Timed;
+                case 2:
+                    return StopTransfer::Type::MinimumTime;
+                case 3:
+                    return StopTransfer::Type::NotPossible;
+                default:
+                    return StopTransfer::Type::Recommended;
+            }
+        }
+
+        /**
+         * Duration of traversing the given pathway.
+         * @return The duration, or std::nullopt if the pathway has neither a traversal time nor a length.
+         */
+        std::optional<std::chrono::seconds> pathway_duration(const ::gtfs::Pathway& pathway) {
+            if (pathway.traversal_time > 0) {
+                return std::chrono::seconds{static_cast<std::chrono::seconds::rep>(pathway.traversal_time)};
+            }
+            if (pathway.length > 0) {
+                const auto duration = std::ceil(pathway.length / pathway_walking_speed_m_s);
+                return std::chrono::seconds{static_cast<std::chrono::seconds::rep>(duration)};
+            }
+            return std::nullopt;
+        }
+
+        /**
+         * Creates transfers between all the stops connected through pathways, using the fastest connection between
+         * them.
+         */
+        std::vector<StopTransfer> pathway_transfers(const ::gtfs::Pathways& pathways,
+                                                    const reference_index<stop_id, const Stop>& stop_index) {
+            using Edge = std::pair<std::string_view, std::chrono::seconds>;
+            auto graph = std::unordered_map<std::string_view, std::vector<Edge>>{};
+            for (const auto& pathway : pathways) {
+                if (const auto duration = pathway_duration(pathway)) {
+                    graph[pathway.from_stop_id].emplace_back(pathway.to_stop_id, *duration);
+                    if (static_cast<int>(pathway.is_bidirectional) == 1) {
+                        graph[pathway.to_stop_id].emplace_back(pathway.from_stop_id, *duration);
+                    }
+                }
+            }
+
+            // Pathways of different stations are not connected, so each search only covers a single station
+            auto transfers = std::vector<StopTransfer>{};
+            using QueueItem = std::pair<std::chrono::seconds, std::string_view>;
+            auto durations = std::unordered_map<std::string_view, std::chrono::seconds>{};
+            for (const auto& origin_id : graph | std::views::keys) {
+                const auto origin = stop_index.find(origin_id);
+                if (origin == stop_index.end()) {
+                    continue;
+                }
+                durations.clear();
+                auto queue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<>>{};
+                durations.emplace(origin_id, std::chrono::seconds{0});
+                queue.emplace(std::chrono::seconds{0}, origin_id);
+                while (!queue.empty()) {
+                    const auto [duration, location_id] = queue.top();
+                    queue.pop();
+                    if (duration > durations.at(location_id)) {
+                        continue;
+                    }
+                    if (const auto stop = stop_index.find(location_id);
+                        location_id != origin_id && stop != stop_index.end()) {
+                        transfers.push_back({origin->second, stop->second, StopTransfer::Type::MinimumTime, duration});
+                    }
+                    const auto edges = graph.find(location_id);
+                    if (edges == graph.end()) {
+                        continue;
+                    }
+                    for (const auto& [next_id, edge_duration] : edges->second) {
+                        const auto next_duration = duration + edge_duration;
+                        auto [next, inserted] = durations.try_emplace(next_id, next_duration);
+                        if (inserted || next_duration < next->second) {
+                            next->second = next_duration;
+                            queue.emplace(next_duration, next_id);
+                        }
+                    }
+                }
+            }
+            return transfers;
+        }
+    }
+
+    std::vector<StopTransfer> from_gtfs(const ::gtfs::Transfers& gtfs_transfers, const ::gtfs::Pathways& pathways,
+                                        const reference_index<stop_id, const Stop>& stop_index,
+                                        const reference_index<stop_id, const Station>& station_index) {
+        // Transfers between stops take precedence over transfers between stations, so process them first
+        auto is_station = [&station_index](const std::string& location_id) {
+            return station_index.contains(location_id) ? 1 : 0;
+        };
+        auto ordered_transfers = std::vector<std::reference_wrapper<const ::gtfs::Transfer>>{
+            gtfs_transfers.begin(), gtfs_transfers.end()
+        };
+        std::ranges::stable_sort(ordered_transfers, std::less{}, [&is_station](const ::gtfs::Transfer& transfer) {
+            return is_station(transfer.from_stop_id) + is_station(transfer.to_stop_id);
+        });
+
+        auto transfers = std::vector<StopTransfer>{};
+        auto defined_pairs = std::set<std::pair<const Stop*, const Stop*>>{};
+        for (const ::gtfs::Transfer& gtfs_transfer : ordered_transfers) {
+            const auto type = from_gtfs(gtfs_transfer.transfer_type);
+            const auto min_transfer_time =
+                    std::chrono::seconds{static_cast<std::chrono::seconds::rep>(gtfs_transfer.min_transfer_time)};
+            for (const Stop& from : resolve_stops(gtfs_transfer.from_stop_id, stop_index, station_index)) {
+                for (const Stop& to : resolve_stops(gtfs_transfer.to_stop_id, stop_index, station_index)) {
+                    // Transfers at the same stop do not create a footpath
+                    if (from != to && defined_pairs.emplace(&from, &to).second) {
+                        transfers.push_back({from, to, type, min_transfer_time});
+                    }
+                }
+            }
+        }
+
+        for (auto& transfer : pathway_transfers(pathways, stop_index)) {
+            if (defined_pairs.emplace(&transfer.from.get(), &transfer.to.get()).second) {
+                transfers.push_back(transfer);
+            }
+        }
+        return transfers;
+    }
+}
@@ -0,0 +1,50 @@
+#include <algorithm>
+#include <iomanip>
+#include <numeric>
+
+#include "schedule/import_stats.h"
+
+namespace raptor {
+    std::chrono::nanoseconds ImportStats::total_wall_time() const noexcept {
+        return std::accumulate(phases.begin(), phases.end(), std::chrono::nanoseconds::zero(),
+                               [](const std::chrono::nanoseconds sum, const ImportPhase& phase) {
+                                   return sum + phase.wall_time;
+                               });
+    }
+
+    void ImportStatsRecorder::add_phase(const std::string_view name, const std::chrono::nanoseconds wall_time,
+                                        const std::int64_t heap_growth) const {
+        auto phase = std::ranges::find(stats->phases, name, &ImportPhase::name);
+        if (phase == stats->phases.end()) {
+            phase = stats->phases.insert(phase, ImportPhase{std::string{name}});
+        }
+        phase->wall_time += wall_time;
+        phase->heap_growth += heap_growth;
+    }
+
+    std::ostream& operator<<(std::ostream& os, const ImportStats& stats) {
+        constexpr auto bytes_in_mib = 1024.0 * 1024.0;
+        const auto milliseconds = [](const std::chrono::nanoseconds duration) {
+            return std::chrono::duration<double, std::milli>(duration).count();
+        };
+        const auto flags = os.flags();
+        const auto precision = os.precision(1);
+        os << std::fixed << std::left << std::setw(22) << "phase" << std::right << std::setw(12) << "time ms"
+           << std::setw(14) << "heap MiB" << '\n';
+        for (const auto& phase : stats.phases) {
+            os << std::left << std::setw(22) << phase.name << std::right << std::setw(12)
+               << milliseconds(phase.wall_time) << std::setw(14)
+               << static_cast<double>(phase.heap_growth) / bytes_in_mib << '\n';
+        }
+        os << std::left << std::setw(22) << "total" << std::right << std::setw(12)
+           << milliseconds(stats.total_wall_time()) << '\n'
+           << "agencies " << stats.agencies << ", stops " << stats.stops << ", stations " << stats.stations
+           << ", services " << stats.services << ", transfers " << stats.transfers << '\n'
+           << "trips " << stats.trips << ", stop times " << stats.stop_times << ", routes " << stats.routes
+           << ", stop patterns " << stats.stop_patterns << '\n'
+           << "peak resident memory " << static_cast<double>(stats.peak_resident_bytes) / bytes_in_mib << " MiB\n";
+        os.precision(precision);
+        os.flags(flags);
+        return os;
+    }
+}
@@ -0,0 +1,112 @@
+#include <algorithm>
+#include <cstring>
+
+#include "schedule/components/interned_string.h"
+
+namespace raptor {
+    namespace {
+        // Pool installed by the innermost StringPool::Scope of the thread
+        thread_local StringPool* current_pool = nullptr;
+    }
+
+    InternedString::InternedString(const std::string_view string) :
+        InternedString(StringPool::current().intern(string)) {
+    }
+
+    StringPool& StringPool::shared() {
+        // Intentionally leaked, so that handles stay valid during static destruction.
+        static auto* pool = new StringPool();
+        return *pool;
+    }
+
+    StringPool& StringPool::current() {
+        return current_pool != nullptr ? *current_pool : shared();
+    }
+
+    StringPool::Scope::Scope(StringPool& pool) :
+        previous(current_pool) {
+        current_pool = &pool;
+    }
+
+    StringPool::Scope::~Scope() {
+        current_pool = previous;
+    }
+
+    std::string_view StringPool::Shard::store(const std::string_view string) {
+        if (string.size() > remaining_in_block) {
+            // Strings longer than a block get a block of their own, otherwise start a new block.
+            auto new_block_size = std::max(block_size, string.size());
+            blocks.emplace_back(std::make_unique<char[]>(new_block_size));
+            next_free = blocks.back().get();
+            remaining_in_block = new_block_size;
+            reserved_bytes += new_block_size;
+        }
+        std::memcpy(next_free, string.data(), string.size());
+        auto stored = std::string_view{next_free, string.size()};
+        next_free += string.size();
+        remaining_in_block -= string.size();
+        return stored;
+    }
+
+    InternedString StringPool::intern(const std::string_view string) {
+        if (string.empty()) {
+            return {};
+        }
+        const auto hash = std::hash<std::string_view>{}(string);
+        auto& shard = shards[hash % n_shards];
+        auto lock = std::scoped_lock{shard.mutex};
+        if (const auto existing = shard.index.find(string); existing != shard.index.end()) {
+            return existing->second;
+        }
+        const auto& entry = shard.entries.emplace_back(shard.store(string), hash);
+        auto handle = InternedString{&entry};
+        // The key must refer to the stored copy, since the given view may not outlive the pool.
+        shard.index.emplace(entry.view, handle);
+        return handle;
+    }
+
+    bool StringPool::owns(const InternedString string) const {
+        if (string.empty()) {
+            return true;
+        }
+        const auto& shard = shards[string.hash() % n_shards];
+        auto lock = std::scoped_lock{shard.mutex};
+        const auto existing = shard.index.find(string.view());
+        return existing != shard.index.end() && existing->second.id() == string.id();
+    }
+
+    std::size_t StringPool::size() const {
+        auto size = std::size_t{0};
+        for (const auto& shard : shards) {
+            auto lock = std::scoped_lock{shard.mutex};
+            size += shard.entries.size();
+        }
+        return size;
+    }
+
+    std::size_t StringPool::arena_bytes() const {
+        auto bytes = std::size_t{0};
+        for (const auto& shard : shards) {
+            auto lock = std::scoped_lock{shard.mutex};
+            bytes += shard.reserved_bytes;
+        }
+        return bytes;
+    }
+
+    MemoryUsage StringPool::memory_usage() const {
+        auto characters = std::size_t{0};
+        auto entries = std::size_t{0};
+        auto index = std::size_t{0};
+        for (const auto& shard : shards) {
+            auto lock = std::scoped_lock{shard.mutex};
+            characters += shard.reserved_bytes + memory::heap_bytes(shard.blocks);
+            entries += memory::heap_bytes(shard.entries);
+            index += memory::heap_bytes(shard.index);
+        }
+        auto usage = MemoryUsage{"string pool", sizeof(StringPool)};
+        usage.add("characters", characters);
+        usage.add("entries", entries);
+        usage.add("index", index);
+        return usage;
+    }
+}
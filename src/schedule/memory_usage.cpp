@@ -0,0 +1,93 @@
+#include <iomanip>
+#include <numeric>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+#include "schedule/memory_usage.h"
+
+namespace raptor {
+
+    std::size_t MemoryUsage::total_bytes() const {
+        return std::accumulate(parts.begin(), parts.end(), bytes, [](std::size_t sum, const MemoryUsage& part) {
+            return sum + part.total_bytes();
+        });
+    }
+
+    MemoryUsage& MemoryUsage::add(std::string part_name, const std::size_t part_bytes) {
+        return parts.emplace_back(MemoryUsage{std::move(part_name), part_bytes});
+    }
+
+    MemoryUsage& MemoryUsage::add(MemoryUsage part) {
+        return parts.emplace_back(std::move(part));
+    }
+
+    MemoryUsage& MemoryUsage::operator+=(const MemoryUsage& other) {
+        bytes += other.bytes;
+        for (const auto& other_part : other.parts) {
+            auto existing = std::ranges::find(parts, other_part.name, &MemoryUsage::name);
+            if (existing != parts.end()) {
+                *existing += other_part;
+            } else {
+                parts.emplace_back(other_part);
+            }
+        }
+        return *this;
+    }
+
+    namespace {
+        /**
+         * Prints the given report and its parts, indenting each level of the tree.
+         */
+        void print_memory_usage(std::ostream& os, const MemoryUsage& usage, const int depth) {
+            constexpr auto bytes_in_mib = 1024.0 * 1024.0;
+            const auto total = usage.total_bytes();
+            os << std::string(depth * 2, ' ') << usage.name << ": " << total << " bytes ("
+               << static_cast<double>(total) / bytes_in_mib << " MiB)\n";
+            for (const auto& part : usage.parts) {
+                print_memory_usage(os, part, depth + 1);
+            }
+        }
+    }
+
+    std::ostream& operator<<(std::ostream& os, const MemoryUsage& usage) {
+        const auto flags = os.flags();
+        const auto precision = os.precision(2);
+        os << std::fixed;
+        print_memory_usage(os, usage, 0);
+        os.precision(precision);
+        os.flags(flags);
+        return os;
+    }
+
+    std::size_t memory::heap_bytes_in_use() noexcept {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+        // Large blocks are allocated with mmap and are counted separately
+        const auto info = mallinfo2();
+        return info.uordblks + info.hblkhd;
+#else
+        return 0;
+#endif
+    }
+
+    std::size_t memory::peak_resident_bytes() noexcept {
+#if defined(__unix__) || defined(__APPLE__)
+        auto usage = rusage{};
+        if (getrusage(RUSAGE_SELF, &usage) != 0) {
+            return 0;
+        }
+#if defined(__APPLE__)
+        return static_cast<std::size_t>(usage.ru_maxrss);
+#else
+        // Linux reports the size in kibibytes
+        return static_cast<std::size_t>(usage.ru_maxrss) * 1024;
+#endif
+#else
+        return 0;
+#endif
+    }
+}
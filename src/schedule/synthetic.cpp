@@ -0,0 +1,244 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <filesystem>
+#include <random>
+#include <unordered_map>
+
+#include "schedule/gtfs.h"
+#include "schedule/synthetic.h"
+
+namespace raptor::synthetic {
+    constexpr auto km_per_degree = 6371.0 * M_PI / 180.0;
+    /**
+     * Distance between the stops of a station.
+     */
+    constexpr auto platform_spacing_km = 0.02;
+    constexpr auto max_latitude = 85.0;
+
+    namespace {
+        struct Location {
+            double latitude;
+            double longitude;
+        };
+
+        /**
+         * Locations of the network and the locations visited by each route, in order.
+         */
+        struct Layout {
+            std::vector<Location> locations;
+            std::vector<std::vector<std::uint32_t>> routes;
+        };
+
+        void validate(const NetworkParameters& parameters) {
+            if (parameters.n_routes == 0 || parameters.stops_per_route < 2) {
+                throw std::invalid_argument("The network needs at least one route with two stops");
+            }
+            if (!(parameters.stop_spacing_km > 0) || !(parameters.speed_km_h > 0)) {
+                throw std::invalid_argument("Stop spacing and speed must be positive");
+            }
+            if (parameters.stops_per_station == 0 || parameters.service_days == 0) {
+                throw std::invalid_argument("Stations and the service period must not be empty");
+            }
+            if (parameters.headway <= std::chrono::minutes::zero() ||
+                parameters.last_departure < parameters.first_departure) {
+                throw std::invalid_argument("Invalid departure times");
+            }
+            if (!parameters.start_date.ok()) {
+                throw std::invalid_argument("Invalid start date");
+            }
+        }
+
+        /**
+         * Longitude difference corresponding to the given distance east of the centre of the network.
+         */
+        double longitude_offset(const NetworkParameters& parameters, const double distance_km) {
+            return distance_km / (km_per_degree * std::cos(parameters.latitude * M_PI / 180.0));
+        }
+
+        Layout grid_layout(const NetworkParameters& parameters, std::mt19937_64& generator) {
+            const auto size = parameters.grid_size == 0 ? parameters.stops_per_route : parameters.grid_size;
+            if (size < parameters.stops_per_route) {
+                throw std::invalid_argument("The grid must be at least as large as a route");
+            }
+            auto layout = Layout{};
+            // Only locations visited by a route are created
+            auto location_indices = std::unordered_map<std::uint64_t, std::uint32_t>{};
+            const auto location = [&](const std::size_t x, const std::size_t y) {
+                const auto [it, inserted] = location_indices.try_emplace(
+                        static_cast<std::uint64_t>(x) << 32 | y, static_cast<std::uint32_t>(layout.locations.size()));
+                if (inserted) {
+                    const auto centre = (static_cast<double>(size) - 1) / 2;
+                    const auto east_km = (static_cast<double>(x) - centre) * parameters.stop_spacing_km;
+                    const auto north_km = (static_cast<double>(y) - centre) * parameters.stop_spacing_km;
+                    layout.locations.push_back({parameters.latitude + north_km / km_per_degree,
+                                                parameters.longitude + longitude_offset(parameters, east_km)});
+                }
+                return it->second;
+            };
+
+            const auto n_lines = std::array{(parameters.n_routes + 1) / 2, parameters.n_routes / 2};
+            auto first_stop = std::uniform_int_distribution<std::size_t>{0, size - parameters.stops_per_route};
+            for (std::size_t r = 0; r < parameters.n_routes; ++r) {
+                // Routes alternate between rows and columns, which are spread evenly over the grid
+                const auto horizontal = r % 2 == 0;
+                const auto line = r / 2 * size / n_lines[r % 2];
+                const auto first = first_stop(generator);
+                auto& route = layout.routes.emplace_back();
+                for (auto i = first; i < first + parameters.stops_per_route; ++i) {
+                    route.push_back(horizontal ? location(i, line) : location(line, i));
+                }
+            }
+            return layout;
+        }
+
+        Layout radial_layout(const NetworkParameters& parameters) {
+            auto layout = Layout{};
+            layout.locations.push_back({parameters.latitude, parameters.longitude});
+            for (std::size_t r = 0; r < parameters.n_routes; ++r) {
+                const auto angle = 2 * M_PI * static_cast<double>(r) / static_cast<double>(parameters.n_routes);
+                auto& route = layout.routes.emplace_back();
+                route.push_back(0);
+                for (std::size_t i = 1; i < parameters.stops_per_route; ++i) {
+                    const auto distance_km = static_cast<double>(i) * parameters.stop_spacing_km;
+                    route.push_back(static_cast<std::uint32_t>(layout.locations.size()));
+                    layout.locations.push_back({
+                        parameters.latitude + distance_km * std::cos(angle) / km_per_degree,
+                        parameters.longitude + longitude_offset(parameters, distance_km * std::sin(angle))
+                    });
+                }
+            }
+            return layout;
+        }
+
+        ::gtfs::Time to_gtfs_time(const std::chrono::seconds time) {
+            const auto hh_mm_ss = std::chrono::hh_mm_ss{time};
+            return {static_cast<std::uint16_t>(hh_mm_ss.hours().count()),
+                    static_cast<std::uint16_t>(hh_mm_ss.minutes().count()),
+                    static_cast<std::uint16_t>(hh_mm_ss.seconds().count())};
+        }
+
+        ::gtfs::Date to_gtfs_date(const std::chrono::year_month_day& date) {
+            return {static_cast<std::uint16_t>(static_cast<int>(date.year())),
+                    static_cast<std::uint16_t>(static_cast<unsigned>(date.month())),
+                    static_cast<std::uint16_t>(static_cast<unsigned>(date.day()))};
+        }
+
+        std::chrono::year_month_day last_service_day(const NetworkParameters& parameters) {
+            return std::chrono::sys_days{parameters.start_date} + std::chrono::days{parameters.service_days - 1};
+        }
+    }
+
+    ::gtfs::Feed generate_feed(const NetworkParameters& parameters) {
+        validate(parameters);
+        auto generator = std::mt19937_64{parameters.seed};
+        const auto layout = parameters.topology == Topology::Grid
+                                ? grid_layout(parameters, generator)
+                                : radial_layout(parameters);
+        if (std::ranges::any_of(layout.locations, [](const Location& location) {
+            return std::abs(location.latitude) > max_latitude;
+        })) {
+            throw std::invalid_argument("The network does not fit between latitudes 85S and 85N");
+        }
+
+        auto feed = ::gtfs::Feed{};
+        auto agency = ::gtfs::Agency{};
+        agency.agency_id = "A";
+        agency.agency_name = "Synthetic";
+        agency.agency_url = "https://example.com";
+        agency.agency_timezone = parameters.time_zone;
+        feed.add_agency(agency);
+
+        // Each location is a stop, or a station with a row of stops
+        const auto n_platforms = parameters.stops_per_station;
+        for (std::size_t i = 0; i < layout.locations.size(); ++i) {
+            auto stop = ::gtfs::Stop{};
+            stop.stop_id = "L" + std::to_string(i);
+            stop.stop_name = stop.stop_id;
+            stop.stop_lat = layout.locations[i].latitude;
+            stop.stop_lon = layout.locations[i].longitude;
+            if (n_platforms > 1) {
+                stop.location_type = ::gtfs::StopLocationType::Station;
+                feed.add_stop(stop);
+                auto platform = stop;
+                platform.location_type = ::gtfs::StopLocationType::StopOrPlatform;
+                platform.parent_station = stop.stop_id;
+                for (std::size_t j = 0; j < n_platforms; ++j) {
+                    platform.stop_id = stop.stop_id + "P" + std::to_string(j);
+                    platform.stop_lon = stop.stop_lon + longitude_offset(
+                                                parameters, static_cast<double>(j) * platform_spacing_km);
+                    feed.add_stop(platform);
+                }
+            } else {
+                feed.add_stop(stop);
+            }
+        }
+
+        auto calendar = ::gtfs::CalendarItem{};
+        calendar.service_id = "S";
+        for (auto* day : {&calendar.monday, &calendar.tuesday, &calendar.wednesday, &calendar.thursday,
+                          &calendar.friday, &calendar.saturday, &calendar.sunday}) {
+            *day = ::gtfs::CalendarAvailability::Available;
+        }
+        calendar.start_date = to_gtfs_date(parameters.start_date);
+        calendar.end_date = to_gtfs_date(last_service_day(parameters));
+        feed.add_calendar_item(calendar);
+
+        // Consecutive stops are always the same distance apart
+        const auto hop = std::max(std::chrono::seconds{1}, std::chrono::seconds{
+                                      std::lround(parameters.stop_spacing_km / parameters.speed_km_h * 3600)});
+        auto first_departure = std::uniform_int_distribution<std::chrono::minutes::rep>{
+            0, parameters.headway.count() - 1
+        };
+        for (std::size_t r = 0; r < layout.routes.size(); ++r) {
+            auto route = ::gtfs::Route{};
+            route.route_id = "R" + std::to_string(r);
+            route.agency_id = agency.agency_id;
+            route.route_short_name = std::to_string(r);
+            route.route_type = ::gtfs::RouteType::Bus;
+            feed.add_route(route);
+
+            auto stop_ids = std::vector<std::string>{};
+            for (const auto location : layout.routes[r]) {
+                stop_ids.push_back("L" + std::to_string(location) +
+                                   (n_platforms > 1 ? "P" + std::to_string(r % n_platforms) : ""));
+            }
+            const auto offset = std::chrono::minutes{first_departure(generator)};
+            for (auto direction = 0; direction < 2; ++direction) {
+                auto n_trips = 0;
+                for (auto departure = parameters.first_departure + offset; departure <= parameters.last_departure;
+                     departure += parameters.headway) {
+                    auto trip = ::gtfs::Trip{};
+                    trip.route_id = route.route_id;
+                    trip.service_id = calendar.service_id;
+                    trip.trip_id = route.route_id + "D" + std::to_string(direction) + "T" + std::to_string(n_trips++);
+                    feed.add_trip(trip);
+
+                    for (std::size_t i = 0; i < stop_ids.size(); ++i) {
+                        auto stop_time = ::gtfs::StopTime{};
+                        stop_time.trip_id = trip.trip_id;
+                        stop_time.stop_id = direction == 0 ? stop_ids[i] : stop_ids[stop_ids.size() - 1 - i];
+                        stop_time.stop_sequence = static_cast<std::uint32_t>(i);
+                        stop_time.arrival_time = to_gtfs_time(departure + static_cast<int>(i) * hop);
+                        stop_time.departure_time = stop_time.arrival_time;
+                        feed.add_stop_time(stop_time);
+                    }
+                }
+            }
+        }
+        return feed;
+    }
+
+    void write_feed(const NetworkParameters& parameters, const std::string& directory) {
+        const auto feed = generate_feed(parameters);
+        std::filesystem::create_directories(directory);
+        if (auto result = feed.write_feed(directory); result.code != ::gtfs::ResultCode::OK) {
+            throw std::runtime_error("Could not write GTFS feed " + directory + ": " + result.message);
+        }
+    }
+
+    Schedule generate_schedule(const NetworkParameters& parameters) {
+        const auto feed = generate_feed(parameters);
+        return gtfs::from_gtfs(feed, parameters.start_date, last_service_day(parameters));
+    }
+}
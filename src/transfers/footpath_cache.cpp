@@ -0,0 +1,215 @@
+#include <array>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+
+#include <boost/container_hash/hash.hpp>
+
+#include "schedule/binary_io.h"
+#include "transfers/footpath_cache.h"
+
+namespace raptor {
+    using binary::read_value;
+    using binary::write_value;
+
+    /**
+     * Identifies the file format. The version is increased whenever the format changes.
+     */
+    constexpr auto cache_magic = std::array{'P', 'T', 'F', 'C'};
+    constexpr auto cache_version = std::uint32_t{2};
+
+    FootpathCache::FootpathCache(std::string calculator_key) :
+        calculator_key(std::move(calculator_key)) {
+    }
+
+    std::size_t FootpathCache::KeyHash::operator()(const Key& key) const noexcept {
+        return boost::hash_range(key.begin(), key.end());
+    }
+
+    FootpathCache::Key FootpathCache::key(const double latitude_1, const double longitude_1,
+                                          const double latitude_2, const double longitude_2) {
+        // Coordinates are rounded to about 1cm, so that reading them from a new feed gives the same key
+        return {std::llround(latitude_1 * 1e7), std::llround(longitude_1 * 1e7),
+                std::llround(latitude_2 * 1e7), std::llround(longitude_2 * 1e7)};
+    }
+
+    FootpathCache FootpathCache::load(const std::string& path, std::string calculator_key) {
+        auto cache = FootpathCache(std::move(calculator_key));
+        auto input = std::ifstream(path, std::ios::binary | std::ios::ate);
+        if (!input) {
+            return cache;
+        }
+        // Sizes read from the file are checked against the rest of the file before allocating anything for them
+        const auto file_size = static_cast<std::uint64_t>(input.tellg());
+        input.seekg(0);
+        const auto remaining_bytes = [&input, file_size] {
+            return file_size - static_cast<std::uint64_t>(input.tellg());
+        };
+        const auto invalid_cache = [&path] {
+            return std::runtime_error("Invalid footpath cache " + path);
+        };
+
+        auto magic = std::array<char, cache_magic.size()>{};
+        input.read(magic.data(), magic.size());
+        if (!input || magic != cache_magic || read_value<std::uint32_t>(input) != cache_version || !input) {
+            throw invalid_cache();
+        }
+        const auto key_size = read_value<std::uint64_t>(input);
+        if (!input || key_size > remaining_bytes()) {
+            throw invalid_cache();
+        }
+        auto saved_key = std::string(key_size, '\0');
+        input.read(saved_key.data(), static_cast<std::streamsize>(saved_key.size()));
+        if (!input) {
+            throw invalid_cache();
+        }
+        if (saved_key != cache.calculator_key) {
+            return cache;
+        }
+        constexpr auto entry_size = std::tuple_size_v<Key> * sizeof(std::int64_t) + sizeof(std::int64_t);
+        const auto n_entries = read_value<std::uint64_t>(input);
+        if (!input || n_entries > remaining_bytes() / entry_size) {
+            throw invalid_cache();
+        }
+        cache.loaded.reserve(n_entries);
+        for (std::uint64_t i = 0; i < n_entries; ++i) {
+            auto entry_key = Key{};
+            for (auto& coordinate : entry_key) {
+                coordinate = read_value<std::int64_t>(input);
+            }
+            const auto seconds = read_value<std::int64_t>(input);
+            cache.loaded.emplace(entry_key, std::chrono::seconds{seconds});
+        }
+        if (!input) {
+            throw invalid_cache();
+        }
+        return cache;
+    }
+
+    void FootpathCache::save(const std::string& path) const {
+        // Written next to the cache and moved over it, so that an interrupted save keeps the previous cache
+        const auto temporary_path = path + ".tmp";
+        {
+            auto output = std::ofstream(temporary_path, std::ios::binary | std::ios::trunc);
+            output.write(cache_magic.data(), cache_magic.size());
+            write_value(output, cache_version);
+            write_value(output, static_cast<std::uint64_t>(calculator_key.size()));
+            output.write(calculator_key.data(), static_cast<std::streamsize>(calculator_key.size()));
+            write_value(output, static_cast<std::uint64_t>(current.size()));
+            for (const auto& [entry_key, walking_time] : current) {
+                for (const auto coordinate : entry_key) {
+                    write_value(output, coordinate);
+                }
+                write_value(output, static_cast<std::int64_t>(walking_time.count()));
+            }
+            if (!output) {
+                throw std::runtime_error("Cannot write footpath cache " + temporary_path);
+            }
+        }
+        std::filesystem::rename(temporary_path, path);
+    }
+
+    std::optional<std::chrono::seconds> FootpathCache::find(const double latitude_1, const double longitude_1,
+                                                            const double latitude_2, const double longitude_2) {
+        const auto entry_key = key(latitude_1, longitude_1, latitude_2, longitude_2);
+        if (const auto entry = current.find(entry_key); entry != current.end()) {
+            return entry->second;
+        }
+        // Loaded entries are moved to the current ones when used, so that they are saved again
+        if (auto entry = loaded.extract(entry_key)) {
+            return current.insert(std::move(entry)).position->second;
+        }
+        return std::nullopt;
+    }
+
+    void FootpathCache::insert(const double latitude_1, const double longitude_1,
+                               const double latitude_2, const double longitude_2,
+                               const std::chrono::seconds walking_time) {
+        current.insert_or_assign(key(latitude_1, longitude_1, latitude_2, longitude_2), walking_time);
+    }
+
+    CachedWalkTimeCalculator::CachedWalkTimeCalculator(std::unique_ptr<WalkTimeCalculator> calculator,
+                                                       FootpathCache& cache) :
+        calculator(std::move(calculator)), cache(cache) {
+    }
+
+    std::chrono::seconds CachedWalkTimeCalculator::calculate_walking_time(
+            const double latitude_1, const double longitude_1, const double latitude_2, const double longitude_2) {
+        if (const auto walking_time = cache.find(latitude_1, longitude_1, latitude_2, longitude_2)) {
+            return *walking_time;
+        }
+        const auto walking_time = calculator->calculate_walking_time(latitude_1, longitude_1,
+                                                                     latitude_2, longitude_2);
+        cache.insert(latitude_1, longitude_1, latitude_2, longitude_2, walking_time);
+        return walking_time;
+    }
+
+    std::chrono::seconds CachedWalkTimeCalculator::calculate_walking_time(const double distance_km) {
+        return calculator->calculate_walking_time(distance_km);
+    }
+
+    void CachedWalkTimeCalculator::calculate_walking_times(const double latitude, const double longitude,
+                                                           const std::span<const double> latitudes,
+                                                           const std::span<const double> longitudes,
+                                                           const std::span<std::chrono::seconds> walking_times) {
+        const auto query = WalkingTimeQuery{latitude, longitude, latitudes, longitudes, walking_times};
+        calculate_walking_times(std::span{&query, 1});
+    }
+
+    void CachedWalkTimeCalculator::calculate_walking_times(const std::span<const double> distances_km,
+                                                           const std::span<std::chrono::seconds> walking_times) {
+        calculator->calculate_walking_times(distances_km, walking_times);
+    }
+
+    void CachedWalkTimeCalculator::calculate_walking_times(const std::span<const WalkingTimeQuery> queries) {
+        // Destinations missing from the cache are copied, so that they can be given to the calculator together
+        struct Miss {
+            std::size_t query;
+            std::size_t destination;
+        };
+        auto misses = std::vector<Miss>{};
+        auto latitudes = std::vector<double>{};
+        auto longitudes = std::vector<double>{};
+        for (std::size_t q = 0; q < queries.size(); ++q) {
+            const auto& query = queries[q];
+            if (query.latitudes.size() != query.longitudes.size() ||
+                query.latitudes.size() != query.walking_times.size()) {
+                throw std::invalid_argument("Coordinates and walking times must have the same size");
+            }
+            for (std::size_t i = 0; i < query.latitudes.size(); ++i) {
+                if (const auto walking_time = cache.find(query.latitude, query.longitude,
+                                                         query.latitudes[i], query.longitudes[i])) {
+                    query.walking_times[i] = *walking_time;
+                } else {
+                    misses.push_back({q, i});
+                    latitudes.push_back(query.latitudes[i]);
+                    longitudes.push_back(query.longitudes[i]);
+                }
+            }
+        }
+        if (misses.empty()) {
+            return;
+        }
+
+        // The misses of each query are consecutive, so they form a single query for the calculator
+        auto walking_times = std::vector<std::chrono::seconds>(misses.size());
+        auto missing_queries = std::vector<WalkingTimeQuery>{};
+        for (std::size_t begin = 0, end = 0; begin < misses.size(); begin = end) {
+            while (end < misses.size() && misses[end].query == misses[begin].query) {
+                ++end;
+            }
+            const auto& query = queries[misses[begin].query];
+            missing_queries.push_back({query.latitude, query.longitude,
+                                       std::span{latitudes}.subspan(begin, end - begin),
+                                       std::span{longitudes}.subspan(begin, end - begin),
+                                       std::span{walking_times}.subspan(begin, end - begin)});
+        }
+        calculator->calculate_walking_times(missing_queries);
+
+        for (std::size_t i = 0; i < misses.size(); ++i) {
+            const auto& query = queries[misses[i].query];
+            query.walking_times[misses[i].destination] = walking_times[i];
+            cache.insert(query.latitude, query.longitude, latitudes[i], longitudes[i], walking_times[i]);
+        }
+    }
+}
@@ -1,4 +1,7 @@
+#include <future>
+#include <limits>
 #include <ranges>
+#include <thread>
 
 #include "schedule/Schedule.h"
 #include "transfers/kd_tree.h"
@@ -6,13 +9,24 @@
 namespace raptor {
 
     StopKDTree::StopKDTree(const std::deque<Stop>& stops) :
-        stops(stops) {
-        stops_with_cartesian_coords = std::vector<std::array<double, 3>>();
-        stops_with_cartesian_coords.reserve(stops.size());
-        std::ranges::transform(stops, std::back_inserter(stops_with_cartesian_coords),
+        stops(stops), origin() {
+        auto cartesian_coords = std::vector<std::array<double, 3>>();
+        cartesian_coords.reserve(stops.size());
+        std::ranges::transform(stops, std::back_inserter(cartesian_coords),
                                [](const std::pair<double, double>& coords) {
                                    return to_cartesian(coords);
                                }, &Stop::get_coordinates);
+        for (const auto& coords : cartesian_coords) {
+            for (int dim = 0; dim < 3; ++dim) {
+                origin[dim] += coords[dim] / static_cast<double>(cartesian_coords.size());
+            }
+        }
+        for (int dim = 0; dim < 3; ++dim) {
+            stop_coordinates[dim].reserve(cartesian_coords.size());
+            for (const auto& coords : cartesian_coords) {
+                stop_coordinates[dim].push_back(static_cast<float>(coords[dim] - origin[dim]));
+            }
+        }
         index = std::make_unique<AdaptorType>(3, *this);
     }
 
@@ -23,6 +37,17 @@ namespace raptor {
         };
     }
 
+    MemoryUsage StopKDTree::memory_usage() const {
+        auto usage = MemoryUsage{"stop KD tree", sizeof(StopKDTree)};
+        auto& coordinates = usage.add("coordinates", 0);
+        for (const auto& dimension : stop_coordinates) {
+            coordinates.bytes += memory::heap_bytes(dimension);
+        }
+        // Includes the nodes of the tree and the point indices
+        usage.add("index", sizeof(AdaptorType) + index->usedMemory(*index));
+        return usage;
+    }
+
     std::array<double, 3> StopKDTree::to_cartesian(const std::pair<double, double>& coordinates) {
         auto latitude = coordinates.first * (M_PI / 180.0);
         auto longitude = coordinates.second * (M_PI / 180.0);
@@ -35,27 +60,32 @@ namespace raptor {
         return {X, Y, Z};
     }
 
-    std::vector<nanoflann::ResultItem<uint32_t>> StopKDTree::stops_in_radius(
-            const std::array<double, 3>& cartesian_coords, double radius_km) const {
-        std::vector<nanoflann::ResultItem<uint32_t>> ret_matches;
-        index->radiusSearch(cartesian_coords.data(), radius_km*radius_km, ret_matches);
+    StopKDTree::Point StopKDTree::to_point(const std::pair<double, double>& coordinates) const {
+        const auto cartesian_coords = to_cartesian(coordinates);
+        return {static_cast<float>(cartesian_coords[0] - origin[0]),
+                static_cast<float>(cartesian_coords[1] - origin[1]),
+                static_cast<float>(cartesian_coords[2] - origin[2])};
+    }
+
+    std::vector<nanoflann::ResultItem<uint32_t, float>> StopKDTree::stops_in_radius(
+            const Point& point, double radius_km) const {
+        std::vector<nanoflann::ResultItem<uint32_t, float>> ret_matches;
+        index->radiusSearch(point.data(), static_cast<float>(radius_km * radius_km), ret_matches);
         return ret_matches;
     }
 
     std::vector<StopWithDistance> StopKDTree::stops_in_radius(double latitude, double longitude, double radius_km) {
-        auto stop_cartesian_coords = to_cartesian({latitude, longitude});
-        auto ret_matches = stops_in_radius(stop_cartesian_coords, radius_km);
+        auto ret_matches = stops_in_radius(to_point({latitude, longitude}), radius_km);
         auto results = convert_flann_results(ret_matches);
         return results;
     }
 
     std::vector<StopWithDistance>
     StopKDTree::stops_in_radius(const Stop& stop, double radius_km) const {
-        auto stop_cartesian_coords = to_cartesian(stop.get_coordinates());
-        auto ret_matches = stops_in_radius(stop_cartesian_coords, radius_km);
+        auto ret_matches = stops_in_radius(to_point(stop.get_coordinates()), radius_km);
 
-        auto is_not_search_stop = [this, stop](const nanoflann::ResultItem<uint32_t>& result_item) {
-            return stop != stops.at(result_item.first);
+        auto is_not_search_stop = [this, stop](const nanoflann::ResultItem<uint32_t, float>& result_item) {
+            return stop != stops[result_item.first];
         };
 
         auto results = convert_flann_results(ret_matches | std::views::filter(is_not_search_stop));
@@ -68,10 +98,9 @@ namespace raptor {
         results.reserve(stops.size());
 
         for (int i = 0; i < stops.size(); i++) {
-            auto coordinates = stops_with_cartesian_coords.at(i);
-            auto nearby_stops = stops_in_radius(coordinates, radius_km);
+            auto nearby_stops = stops_in_radius(get_point(i), radius_km);
 
-            auto is_not_current_stop = [i](const nanoflann::ResultItem<uint32_t>& result_item) {
+            auto is_not_current_stop = [i](const nanoflann::ResultItem<uint32_t, float>& result_item) {
                 return result_item.first != i;
             };
 
@@ -81,4 +110,118 @@ namespace raptor {
         }
         return results;
     }
+
+    std::optional<std::vector<StopPairWithDistance>> StopKDTree::stop_pairs_in_radius(const double radius_km) const {
+        const auto n_stops = kdtree_get_point_count();
+        const auto n_tasks = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+        const auto chunk_size = std::max<std::size_t>(1, (n_stops + n_tasks - 1) / n_tasks);
+
+        // Each task searches around a contiguous range of stops
+        auto tasks = std::vector<std::future<std::vector<StopPairWithDistance>>>{};
+        for (std::size_t begin = 0; begin < n_stops; begin += chunk_size) {
+            const auto end = std::min(n_stops, begin + chunk_size);
+            tasks.emplace_back(std::async(std::launch::async, [this, begin, end, radius_km] {
+                auto pairs = std::vector<StopPairWithDistance>{};
+                auto matches = std::vector<nanoflann::ResultItem<uint32_t, float>>{};
+                for (auto i = static_cast<std::uint32_t>(begin); i < end; ++i) {
+                    const auto point = get_point(i);
+                    index->radiusSearch(point.data(), static_cast<float>(radius_km * radius_km), matches);
+                    for (const auto& [j, squared_distance] : matches) {
+                        if (j > i) {
+                            pairs.push_back({i, j, std::sqrt(static_cast<double>(squared_distance))});
+                        }
+                    }
+                }
+                return pairs;
+            }));
+        }
+
+        auto pairs = std::vector<StopPairWithDistance>{};
+        for (auto& task : tasks) {
+            auto task_pairs = task.get();
+            pairs.insert(pairs.end(), task_pairs.begin(), task_pairs.end());
+        }
+        return pairs;
+    }
+
+    namespace {
+        /**
+         * Keeps the closest points within a maximum distance in a buffer, sorted by their distance.
+         * Implements the result set interface of nanoflann.
+         */
+        class NearestStopsResultSet {
+            std::span<StopSearchResult> results;
+            std::size_t count = 0;
+            float max_squared_distance;
+
+        public:
+            /**
+             * @param results Buffer for the results. Must not be empty.
+             */
+            NearestStopsResultSet(const std::span<StopSearchResult> results, const float max_squared_distance) :
+                results(results), max_squared_distance(max_squared_distance) {
+            }
+
+            [[nodiscard]] std::size_t size() const noexcept {
+                return count;
+            }
+
+            [[nodiscard]] bool empty() const noexcept {
+                return count == 0;
+            }
+
+            [[nodiscard]] bool full() const noexcept {
+                return count == results.size();
+            }
+
+            [[nodiscard]] float worstDist() const noexcept {
+                return full() ? static_cast<float>(results.back().distance_km) : max_squared_distance;
+            }
+
+            /**
+             * Inserts the point in order of distance, dropping the furthest point if the buffer is full.
+             * Distances are squared until the search finishes.
+             */
+            bool addPoint(const float squared_distance, const std::uint32_t stop_index) noexcept {
+                if (squared_distance > worstDist()) {
+                    return true;
+                }
+                auto position = std::min(count, results.size() - 1);
+                for (; position > 0 && results[position - 1].distance_km > squared_distance; --position) {
+                    results[position] = results[position - 1];
+                }
+                results[position] = {stop_index, squared_distance};
+                count = std::min(count + 1, results.size());
+                return true;
+            }
+
+            /**
+             * Converts the distances of the found points to kilometres.
+             * @return Number of points found.
+             */
+            std::size_t finish() noexcept {
+                for (auto& result : results.first(count)) {
+                    result.distance_km = std::sqrt(result.distance_km);
+                }
+                return count;
+            }
+        };
+    }
+
+    std::size_t StopKDTree::nearest_stops(const double latitude, const double longitude,
+                                          const std::span<StopSearchResult> results) const {
+        return nearest_stops_in_radius(latitude, longitude, std::numeric_limits<double>::infinity(), results);
+    }
+
+    std::size_t StopKDTree::nearest_stops_in_radius(const double latitude, const double longitude,
+                                                    const double radius_km,
+                                                    const std::span<StopSearchResult> results) const {
+        if (results.empty()) {
+            return 0;
+        }
+        const auto point = to_point({latitude, longitude});
+        auto result_set = NearestStopsResultSet(results, static_cast<float>(radius_km * radius_km));
+        index->findNeighbors(result_set, point.data());
+        return result_set.finish();
+    }
 }
@@ -1,24 +1,17 @@
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <stdexcept>
 
 #include "transfers/linear_walk_calculator.h"
 
 namespace raptor {
     double LinearWalkTimeCalculator::calculate_distance(double latitude_1, double longitude_1,
                                                         double latitude_2, double longitude_2) {
-        const double R = 6371;
-        // Use the Haversine formula
-        double delta_lambda = (longitude_2 - longitude_1) * M_PI / 180;
-
-        double phi_1 = latitude_1 * M_PI / 180;
-        double phi_2 = latitude_2 * M_PI / 180;
-
-        auto delta_phi = phi_2 - phi_1;
-
-        double a = std::pow(std::sin(delta_phi / 2), 2) + std::cos(phi_1) * std::cos(phi_2) *
-                std::pow(std::sin(delta_lambda / 2), 2);
-        double c = 2 * std::atan2(std::sqrt(a), std::sqrt(1 - a));
-
-        return R * c;
+        const auto delta_lambda = (longitude_2 - longitude_1) * M_PI / 180;
+        const auto phi_1 = latitude_1 * M_PI / 180;
+        const auto phi_2 = latitude_2 * M_PI / 180;
+        return haversine_distance(phi_2 - phi_1, delta_lambda, std::cos(phi_1), std::cos(phi_2));
     }
 
     LinearWalkTimeCalculator::LinearWalkTimeCalculator(const double walking_speed_km_h,
@@ -39,8 +32,57 @@ namespace raptor {
     }
 
     std::chrono::seconds LinearWalkTimeCalculator::calculate_walking_time(const double distance) {
-        auto time = 3600 * distance / walking_speed;
-        time *= scaling_factor;
-        return std::chrono::seconds{static_cast<int>(std::ceil(time))};
+        return to_walking_time(distance);
+    }
+
+    void LinearWalkTimeCalculator::to_walking_times(const std::span<const double> distances_km,
+                                                    const std::span<std::chrono::seconds> walking_times) const noexcept {
+        // Same operations as to_walking_time, so that both give the same results
+        for (std::size_t i = 0; i < distances_km.size(); ++i) {
+            auto time = 3600 * distances_km[i] / walking_speed;
+            time *= scaling_factor;
+            walking_times[i] = std::chrono::seconds{static_cast<int>(std::ceil(time))};
+        }
+    }
+
+    void LinearWalkTimeCalculator::calculate_walking_times(const double latitude, const double longitude,
+                                                           const std::span<const double> latitudes,
+                                                           const std::span<const double> longitudes,
+                                                           const std::span<std::chrono::seconds> walking_times) {
+        if (latitudes.size() != longitudes.size() || latitudes.size() != walking_times.size()) {
+            throw std::invalid_argument("Coordinates and walking times must have the same size");
+        }
+        const auto phi_1 = latitude * M_PI / 180;
+        const auto cos_phi_1 = std::cos(phi_1);
+        const auto sin_phi_1 = std::sin(phi_1);
+        // Distances are computed in chunks on the stack, in a loop without branches or calls, and then converted to
+        // walking times in a second loop, so that both loops can be vectorised
+        auto distances = std::array<double, chunk_size>{};
+        for (std::size_t offset = 0; offset < latitudes.size(); offset += chunk_size) {
+            const auto n = std::min(chunk_size, latitudes.size() - offset);
+            const auto* chunk_latitudes = latitudes.data() + offset;
+            const auto* chunk_longitudes = longitudes.data() + offset;
+            for (std::size_t i = 0; i < n; ++i) {
+                const auto delta_phi = (chunk_latitudes[i] - latitude) * M_PI / 180;
+                auto delta_longitude = chunk_longitudes[i] - longitude;
+                // Take the short way around the antimeridian
+                delta_longitude -= 360 * std::nearbyint(delta_longitude / 360);
+                const auto delta_lambda = delta_longitude * M_PI / 180;
+                // First order approximation of the cosine of the destination's latitude
+                const auto cos_phi_2 = cos_phi_1 - sin_phi_1 * delta_phi;
+                // Haversine formula, with sin(x) ~ x and asin(x) ~ x for small distances
+                const auto a = delta_phi * delta_phi / 4 + cos_phi_1 * cos_phi_2 * delta_lambda * delta_lambda / 4;
+                distances[i] = 2 * earth_radius_km * std::sqrt(a);
+            }
+            to_walking_times(std::span{distances}.first(n), walking_times.subspan(offset, n));
+        }
+    }
+
+    void LinearWalkTimeCalculator::calculate_walking_times(const std::span<const double> distances_km,
+                                                           const std::span<std::chrono::seconds> walking_times) {
+        if (distances_km.size() != walking_times.size()) {
+            throw std::invalid_argument("Distances and walking times must have the same size");
+        }
+        to_walking_times(distances_km, walking_times);
     }
 }
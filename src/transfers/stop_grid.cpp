@@ -0,0 +1,163 @@
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include <limits>
+#include <numeric>
+#include <thread>
+
+#include "schedule/Schedule.h"
+#include "transfers/linear_walk_calculator.h"
+#include "transfers/stop_grid.h"
+
+namespace raptor {
+    constexpr auto earth_radius_km = LinearWalkTimeCalculator::earth_radius_km;
+    constexpr auto degrees_to_radians = M_PI / 180.0;
+    /**
+     * Longitude cells are sized for latitudes up to this value, so that they do not become infinitely wide.
+     */
+    constexpr auto max_cell_latitude = 89.0 * degrees_to_radians;
+
+    StopGrid::StopGrid(const std::deque<Stop>& stops, const double cell_size_km) :
+        stops(stops) {
+        if (!(cell_size_km > 0)) {
+            throw std::invalid_argument("Cell size must be positive");
+        }
+        auto max_latitude = 0.0;
+        for (const auto& stop : stops) {
+            max_latitude = std::max(max_latitude, std::abs(stop.get_coordinates().first) * degrees_to_radians);
+        }
+        cell_latitude = cell_size_km / earth_radius_km;
+        cell_longitude = cell_latitude / std::cos(std::min(max_latitude, max_cell_latitude));
+
+        // Order the stops by their cell, so that each cell is a range of positions
+        auto keys = std::vector<std::uint64_t>{};
+        keys.reserve(stops.size());
+        for (const auto& stop : stops) {
+            const auto [latitude, longitude] = stop.get_coordinates();
+            keys.push_back(cell_key(cell_x(longitude * degrees_to_radians), cell_y(latitude * degrees_to_radians)));
+        }
+        stop_indices.resize(stops.size());
+        std::iota(stop_indices.begin(), stop_indices.end(), 0);
+        std::ranges::stable_sort(stop_indices, {}, [&keys](const std::uint32_t i) {
+            return keys[i];
+        });
+
+        latitudes.reserve(stops.size());
+        longitudes.reserve(stops.size());
+        cos_latitudes.reserve(stops.size());
+        for (std::uint32_t position = 0; position < stop_indices.size(); ++position) {
+            const auto i = stop_indices[position];
+            const auto [latitude, longitude] = stops[i].get_coordinates();
+            latitudes.push_back(latitude * degrees_to_radians);
+            longitudes.push_back(longitude * degrees_to_radians);
+            cos_latitudes.push_back(std::cos(latitudes.back()));
+            auto [cell, inserted] = cells.try_emplace(keys[i], Cell{position, position});
+            ++cell->second.end;
+        }
+    }
+
+    NearbyStopsFinder::Factory StopGrid::create_factory(const double cell_size_km) {
+        return [cell_size_km](const std::deque<Stop>& stops) {
+            return std::make_unique<StopGrid>(stops, cell_size_km);
+        };
+    }
+
+    template <typename F>
+    void StopGrid::for_each_stop_in_radius(const double latitude, const double longitude, const double radius_km,
+                                           F&& function) const {
+        const auto cos_latitude = std::cos(latitude);
+        const auto visit_cell = [&](const Cell& cell) {
+            for (auto position = cell.begin; position < cell.end; ++position) {
+                const auto distance = LinearWalkTimeCalculator::haversine_distance(
+                        latitudes[position] - latitude, longitudes[position] - longitude,
+                        cos_latitude, cos_latitudes[position]);
+                if (distance <= radius_km) {
+                    function(position, distance);
+                }
+            }
+        };
+
+        // Points in the radius are at most this many radians of latitude away
+        const auto radius = radius_km / earth_radius_km;
+        const auto n_y = static_cast<std::int64_t>(std::ceil(radius / cell_latitude));
+        // The longitude difference is largest at the latitude of the radius furthest from the equator. Searches
+        // reaching a pole can find points at any longitude, so they check every cell.
+        const auto furthest_latitude = std::abs(latitude) + radius;
+        const auto n_x = furthest_latitude < M_PI / 2
+                             ? static_cast<std::int64_t>(std::ceil(
+                                     radius / std::cos(furthest_latitude) / cell_longitude))
+                             : std::numeric_limits<std::int64_t>::max();
+        // Scanning all cells is faster than looking up more cells than there are
+        if (n_x >= static_cast<std::int64_t>(cells.size()) || n_y >= static_cast<std::int64_t>(cells.size()) ||
+            (2 * n_x + 1) * (2 * n_y + 1) >= static_cast<std::int64_t>(cells.size())) {
+            for (const auto& [key, cell] : cells) {
+                visit_cell(cell);
+            }
+            return;
+        }
+
+        const auto x = cell_x(longitude);
+        const auto y = cell_y(latitude);
+        for (auto dx = -n_x; dx <= n_x; ++dx) {
+            for (auto dy = -n_y; dy <= n_y; ++dy) {
+                const auto cell = cells.find(cell_key(static_cast<std::int32_t>(x + dx),
+                                                      static_cast<std::int32_t>(y + dy)));
+                if (cell != cells.end()) {
+                    visit_cell(cell->second);
+                }
+            }
+        }
+    }
+
+    std::vector<StopWithDistance> StopGrid::stops_in_radius(const double latitude, const double longitude,
+                                                            const double radius_km) {
+        auto results = std::vector<StopWithDistance>{};
+        for_each_stop_in_radius(latitude * degrees_to_radians, longitude * degrees_to_radians, radius_km,
+                                [this, &results](const std::uint32_t position, const double distance) {
+                                    results.push_back({stops[stop_indices[position]], distance});
+                                });
+        return results;
+    }
+
+    std::optional<std::vector<StopPairWithDistance>> StopGrid::stop_pairs_in_radius(const double radius_km) const {
+        const auto n_stops = stop_indices.size();
+        const auto n_tasks = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+        const auto chunk_size = std::max<std::size_t>(1, (n_stops + n_tasks - 1) / n_tasks);
+
+        // Each task searches around a contiguous range of positions, which are close to each other in the grid
+        auto tasks = std::vector<std::future<std::vector<StopPairWithDistance>>>{};
+        for (std::size_t begin = 0; begin < n_stops; begin += chunk_size) {
+            const auto end = std::min(n_stops, begin + chunk_size);
+            tasks.emplace_back(std::async(std::launch::async, [this, begin, end, radius_km] {
+                auto pairs = std::vector<StopPairWithDistance>{};
+                for (auto position = begin; position < end; ++position) {
+                    const auto i = stop_indices[position];
+                    for_each_stop_in_radius(latitudes[position], longitudes[position], radius_km,
+                                            [this, i, &pairs](const std::uint32_t other, const double distance) {
+                                                const auto j = stop_indices[other];
+                                                if (j > i) {
+                                                    pairs.push_back({i, j, distance});
+                                                }
+                                            });
+                }
+                return pairs;
+            }));
+        }
+
+        auto pairs = std::vector<StopPairWithDistance>{};
+        for (auto& task : tasks) {
+            auto task_pairs = task.get();
+            pairs.insert(pairs.end(), task_pairs.begin(), task_pairs.end());
+        }
+        return pairs;
+    }
+
+    MemoryUsage StopGrid::memory_usage() const {
+        auto usage = MemoryUsage{"stop grid", sizeof(StopGrid)};
+        usage.add("stop indices", memory::heap_bytes(stop_indices));
+        usage.add("coordinates", memory::heap_bytes(latitudes) + memory::heap_bytes(longitudes) +
+                                 memory::heap_bytes(cos_latitudes));
+        usage.add("cells", memory::heap_bytes(cells));
+        return usage;
+    }
+}
@@ -0,0 +1,426 @@
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <future>
+#include <limits>
+#include <ranges>
+#include <sstream>
+#include <thread>
+
+#include <boost/graph/dijkstra_shortest_paths_no_color_map.hpp>
+
+#include "transfers/kd_tree.h"
+#include "transfers/street_network_calculator.h"
+
+namespace raptor {
+
+    namespace {
+        /**
+         * Values of the highway tag which pedestrians are not allowed or not able to use.
+         */
+        constexpr auto non_walkable_highways = std::array<std::string_view, 12>{
+                "abandoned", "bus_guideway", "busway", "construction", "escape", "motorway", "motorway_link",
+                "proposed", "raceway", "razed", "trunk", "trunk_link"};
+
+        using Tags = std::unordered_map<std::string, std::string>;
+
+        /**
+         * Decodes the escape sequences of an OPL string, in which special characters are written as their hexadecimal
+         * Unicode code point between two % signs.
+         */
+        std::string decode_opl_string(const std::string_view string) {
+            auto decoded = std::string{};
+            decoded.reserve(string.size());
+            for (std::size_t i = 0; i < string.size(); ++i) {
+                if (string[i] != '%') {
+                    decoded.push_back(string[i]);
+                    continue;
+                }
+                const auto end = string.find('%', i + 1);
+                if (end == std::string_view::npos) {
+                    throw std::runtime_error("Unterminated escape sequence");
+                }
+                auto code_point = std::uint32_t{};
+                const auto digits = string.substr(i + 1, end - i - 1);
+                if (std::from_chars(digits.data(), digits.data() + digits.size(), code_point, 16).ptr !=
+                    digits.data() + digits.size()) {
+                    throw std::runtime_error("Invalid escape sequence");
+                }
+                // Encode the code point as UTF-8
+                if (code_point < 0x80) {
+                    decoded.push_back(static_cast<char>(code_point));
+                } else if (code_point < 0x800) {
+                    decoded.push_back(static_cast<char>(0xC0 | code_point >> 6));
+                    decoded.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+                } else if (code_point < 0x10000) {
+                    decoded.push_back(static_cast<char>(0xE0 | code_point >> 12));
+                    decoded.push_back(static_cast<char>(0x80 | (code_point >> 6 & 0x3F)));
+                    decoded.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+                } else {
+                    decoded.push_back(static_cast<char>(0xF0 | code_point >> 18));
+                    decoded.push_back(static_cast<char>(0x80 | (code_point >> 12 & 0x3F)));
+                    decoded.push_back(static_cast<char>(0x80 | (code_point >> 6 & 0x3F)));
+                    decoded.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+                }
+                i = end;
+            }
+            return decoded;
+        }
+
+        /**
+         * Splits an OPL line into its fields, which are separated by spaces, or a field into the items of its list,
+         * which are separated by commas.
+         */
+        std::vector<std::string_view> split(const std::string_view text, const char separator) {
+            auto items = std::vector<std::string_view>{};
+            for (std::size_t start = 0; start < text.size();) {
+                const auto end = std::min(text.find(separator, start), text.size());
+                items.push_back(text.substr(start, end - start));
+                start = end + 1;
+            }
+            return items;
+        }
+
+        Tags parse_opl_tags(const std::string_view field) {
+            auto tags = Tags{};
+            for (const auto tag : split(field, ',')) {
+                const auto separator = tag.find('=');
+                if (separator == std::string_view::npos) {
+                    throw std::runtime_error("Invalid tag");
+                }
+                tags.insert_or_assign(decode_opl_string(tag.substr(0, separator)),
+                                      decode_opl_string(tag.substr(separator + 1)));
+            }
+            return tags;
+        }
+
+        template <typename T>
+        T parse_opl_number(const std::string_view text) {
+            auto value = T{};
+            if (text.empty() || std::from_chars(text.data(), text.data() + text.size(), value).ptr !=
+                text.data() + text.size()) {
+                throw std::runtime_error("Invalid number " + std::string{text});
+            }
+            return value;
+        }
+
+        /**
+         * Checks whether pedestrians can walk along a way with the given tags. Ways without a highway tag, such as
+         * buildings and boundaries, are not walkable.
+         */
+        bool is_walkable(const Tags& tags) {
+            const auto value = [&tags](const std::string& key) {
+                const auto tag = tags.find(key);
+                return tag != tags.end() ? std::string_view{tag->second} : std::string_view{};
+            };
+            const auto highway = value("highway");
+            if (highway.empty()) {
+                return false;
+            }
+            const auto foot = value("foot");
+            if (foot == "no" || foot == "private" || foot == "use_sidepath") {
+                return false;
+            }
+            if (foot == "yes" || foot == "designated" || foot == "permissive" || foot == "destination") {
+                return true;
+            }
+            const auto access = value("access");
+            if (access == "no" || access == "private") {
+                return false;
+            }
+            return std::ranges::find(non_walkable_highways, highway) == non_walkable_highways.end();
+        }
+
+        /**
+         * Thrown by the visitor to stop a search early.
+         */
+        struct SearchFinished {
+        };
+
+        /**
+         * Records the vertices reached by a search and calls the given function when the distance of a vertex is
+         * final.
+         */
+        template <typename Vertex, typename OnSettled>
+        struct BoundedSearchVisitor : boost::default_dijkstra_visitor {
+            std::vector<Vertex>& reached;
+            OnSettled& on_settled;
+
+            template <typename Graph>
+            void discover_vertex(const Vertex vertex, const Graph&) const {
+                reached.push_back(vertex);
+            }
+
+            template <typename Graph>
+            void examine_vertex(const Vertex vertex, const Graph&) const {
+                on_settled(vertex);
+            }
+        };
+    }
+
+    StreetNetwork StreetNetwork::read(std::istream& input) {
+        auto nodes = std::vector<Node>{};
+        auto node_positions = std::unordered_map<std::int64_t, std::uint32_t>{};
+        auto ways = std::vector<std::vector<std::uint32_t>>{};
+        auto line = std::string{};
+        for (std::size_t line_number = 1; std::getline(input, line); ++line_number) {
+            if (line.empty()) {
+                continue;
+            }
+            const auto fields = split(line, ' ');
+            // The first field is the type and ID of the object, and every other field starts with a key letter
+            const auto field = [&fields](const char key) -> std::optional<std::string_view> {
+                for (const auto value : fields | std::views::drop(1)) {
+                    if (!value.empty() && value.front() == key) {
+                        return value.substr(1);
+                    }
+                }
+                return std::nullopt;
+            };
+            try {
+                if (fields.front().size() < 2) {
+                    throw std::runtime_error("Invalid object");
+                }
+                const auto type = fields.front().front();
+                if (type == 'n') {
+                    const auto id = parse_opl_number<std::int64_t>(fields.front().substr(1));
+                    const auto longitude = field('x');
+                    const auto latitude = field('y');
+                    // Nodes of deleted or incomplete data have no location and cannot be used
+                    if (!longitude || !latitude || longitude->empty() || latitude->empty()) {
+                        continue;
+                    }
+                    node_positions.emplace(id, static_cast<std::uint32_t>(nodes.size()));
+                    nodes.push_back({parse_opl_number<double>(*latitude), parse_opl_number<double>(*longitude)});
+                } else if (type == 'w') {
+                    const auto tags = field('T');
+                    if (!is_walkable(parse_opl_tags(tags.value_or("")))) {
+                        continue;
+                    }
+                    auto& way = ways.emplace_back();
+                    for (const auto reference : split(field('N').value_or(""), ',')) {
+                        if (reference.size() < 2 || reference.front() != 'n') {
+                            throw std::runtime_error("Invalid node reference");
+                        }
+                        const auto id = parse_opl_number<std::int64_t>(reference.substr(1));
+                        const auto position = node_positions.find(id);
+                        if (position == node_positions.end()) {
+                            throw std::runtime_error("Unknown node " + std::to_string(id));
+                        }
+                        way.push_back(position->second);
+                    }
+                }
+                // Relations and changesets are not part of the walkable network
+            } catch (const std::runtime_error& e) {
+                throw std::runtime_error("Line " + std::to_string(line_number) + ": " + e.what());
+            }
+        }
+
+        // Only nodes of walkable ways are kept, so that points are never snapped to roads which cannot be walked
+        constexpr auto unused = std::numeric_limits<std::uint32_t>::max();
+        auto new_positions = std::vector<std::uint32_t>(nodes.size(), unused);
+        for (const auto& way : ways) {
+            for (const auto position : way) {
+                new_positions[position] = 0;
+            }
+        }
+        auto network = StreetNetwork{};
+        for (std::size_t position = 0; position < nodes.size(); ++position) {
+            if (new_positions[position] != unused) {
+                new_positions[position] = static_cast<std::uint32_t>(network.nodes.size());
+                network.nodes.push_back(nodes[position]);
+            }
+        }
+        for (const auto& way : ways) {
+            for (std::size_t i = 1; i < way.size(); ++i) {
+                network.segments.push_back({new_positions[way[i - 1]], new_positions[way[i]]});
+            }
+        }
+        return network;
+    }
+
+    StreetNetwork StreetNetwork::read(const std::string& path) {
+        auto input = std::ifstream(path);
+        if (!input) {
+            throw std::runtime_error("Cannot open street network " + path);
+        }
+        return read(input);
+    }
+
+    StreetNetworkWalkTimeCalculator::StreetNetworkWalkTimeCalculator(const StreetNetwork& network,
+                                                                     const double walking_speed_km_h,
+                                                                     const double max_walking_distance_km,
+                                                                     const double max_snapping_distance_km) :
+        walking_speed_m_s(walking_speed_km_h / 3.6), max_walking_distance_m(max_walking_distance_km * 1000),
+        max_snapping_distance_m(max_snapping_distance_km * 1000) {
+        if (walking_speed_m_s <= 0) {
+            throw std::invalid_argument("Walking speed must be positive");
+        }
+        if (max_walking_distance_m <= 0 || max_snapping_distance_m <= 0) {
+            throw std::invalid_argument("Maximum distances must be positive");
+        }
+        nodes_with_cartesian_coords.reserve(network.nodes.size());
+        std::ranges::transform(network.nodes, std::back_inserter(nodes_with_cartesian_coords),
+                               [](const StreetNetwork::Node& node) {
+                                   return StopKDTree::to_cartesian({node.latitude, node.longitude});
+                               });
+
+        // Segments can be walked in both directions, so each one creates two edges
+        auto edges = std::vector<std::pair<Vertex, Vertex>>{};
+        auto edge_properties = std::vector<Edge>{};
+        edges.reserve(network.segments.size() * 2);
+        edge_properties.reserve(network.segments.size() * 2);
+        for (const auto& [from, to] : network.segments) {
+            if (from >= network.nodes.size() || to >= network.nodes.size()) {
+                throw std::invalid_argument("Segment refers to a node not in the network");
+            }
+            const auto& from_coords = nodes_with_cartesian_coords[from];
+            const auto& to_coords = nodes_with_cartesian_coords[to];
+            // Segments are short, so the straight line between the points approximates the distance on the surface
+            const auto length_m = 1000 * std::hypot(from_coords[0] - to_coords[0], from_coords[1] - to_coords[1],
+                                                    from_coords[2] - to_coords[2]);
+            edges.emplace_back(from, to);
+            edges.emplace_back(to, from);
+            edge_properties.push_back({length_m});
+            edge_properties.push_back({length_m});
+        }
+        graph = Graph(boost::edges_are_unsorted_multi_pass, edges.begin(), edges.end(), edge_properties.begin(),
+                      network.nodes.size());
+        index = std::make_unique<AdaptorType>(3, *this);
+        state = create_search_state();
+    }
+
+    StreetNetworkWalkTimeCalculator::SearchState StreetNetworkWalkTimeCalculator::create_search_state() const {
+        return {std::vector(boost::num_vertices(graph), std::numeric_limits<double>::infinity()), {}};
+    }
+
+    std::optional<StreetNetworkWalkTimeCalculator::SnappedPoint> StreetNetworkWalkTimeCalculator::snap(
+            const double latitude, const double longitude) const {
+        const auto coordinates = StopKDTree::to_cartesian({latitude, longitude});
+        auto closest = std::uint32_t{};
+        auto squared_distance = 0.0;
+        if (index->knnSearch(coordinates.data(), 1, &closest, &squared_distance) == 0) {
+            return std::nullopt;
+        }
+        const auto distance_m = 1000 * std::sqrt(squared_distance);
+        if (distance_m > max_snapping_distance_m) {
+            return std::nullopt;
+        }
+        return SnappedPoint{closest, distance_m};
+    }
+
+    void StreetNetworkWalkTimeCalculator::search(const WalkingTimeQuery& query, SearchState& search_state) const {
+        const auto& [latitude, longitude, latitudes, longitudes, walking_times] = query;
+        if (latitudes.size() != longitudes.size() || latitudes.size() != walking_times.size()) {
+            throw std::invalid_argument("Coordinates and walking times must have the same size");
+        }
+        std::ranges::fill(walking_times, unreachable);
+        const auto origin = snap(latitude, longitude);
+        if (!origin) {
+            return;
+        }
+
+        // Destinations are sorted by their vertex, so that they can be found when the vertex is reached
+        auto destinations = std::vector<std::pair<Vertex, std::size_t>>{};
+        auto destination_distances_m = std::vector<double>(latitudes.size());
+        for (std::size_t i = 0; i < latitudes.size(); ++i) {
+            if (const auto destination = snap(latitudes[i], longitudes[i])) {
+                destinations.emplace_back(destination->vertex, i);
+                destination_distances_m[i] = destination->distance_m;
+            }
+        }
+        if (destinations.empty()) {
+            return;
+        }
+        std::ranges::sort(destinations);
+
+        auto& distances_m = search_state.distances_m;
+        const auto max_path_distance_m = max_walking_distance_m - origin->distance_m;
+        auto remaining = destinations.size();
+        auto on_vertex_settled = [&](const Vertex vertex) {
+            const auto path_distance_m = distances_m[vertex];
+            if (path_distance_m > max_path_distance_m) {
+                throw SearchFinished{};
+            }
+            auto reached = std::ranges::equal_range(destinations, vertex, std::less{},
+                                                    &std::pair<Vertex, std::size_t>::first);
+            for (const auto i : reached | std::views::values) {
+                const auto distance_m = origin->distance_m + path_distance_m + destination_distances_m[i];
+                if (distance_m <= max_walking_distance_m) {
+                    walking_times[i] = to_walking_time(distance_m);
+                }
+            }
+            remaining -= reached.size();
+            if (remaining == 0) {
+                throw SearchFinished{};
+            }
+        };
+
+        auto visitor = BoundedSearchVisitor<Vertex, decltype(on_vertex_settled)>{
+            {}, search_state.reached, on_vertex_settled
+        };
+        distances_m[origin->vertex] = 0;
+        try {
+            boost::dijkstra_shortest_paths_no_color_map_no_init(
+                    graph, origin->vertex, boost::dummy_property_map(),
+                    boost::make_iterator_property_map(distances_m.begin(), boost::get(boost::vertex_index, graph)),
+                    boost::get(&Edge::length_m, graph), boost::get(boost::vertex_index, graph), std::less<double>(),
+                    std::plus<double>(), std::numeric_limits<double>::infinity(), 0.0,
+                    visitor);
+        } catch (const SearchFinished&) {
+        }
+
+        // Only the reached vertices are reset, so that the cost of a search does not depend on the network size
+        for (const auto vertex : search_state.reached) {
+            distances_m[vertex] = std::numeric_limits<double>::infinity();
+        }
+        search_state.reached.clear();
+    }
+
+    std::chrono::seconds StreetNetworkWalkTimeCalculator::calculate_walking_time(
+            const double latitude_1, const double longitude_1, const double latitude_2, const double longitude_2) {
+        auto walking_time = unreachable;
+        search({latitude_1, longitude_1, std::span{&latitude_2, 1}, std::span{&longitude_2, 1},
+                std::span{&walking_time, 1}}, state);
+        return walking_time;
+    }
+
+    std::chrono::seconds StreetNetworkWalkTimeCalculator::calculate_walking_time(const double distance_km) {
+        return to_walking_time(distance_km * 1000);
+    }
+
+    void StreetNetworkWalkTimeCalculator::calculate_walking_times(const double latitude, const double longitude,
+                                                                  const std::span<const double> latitudes,
+                                                                  const std::span<const double> longitudes,
+                                                                  const std::span<std::chrono::seconds>
+                                                                  walking_times) {
+        search({latitude, longitude, latitudes, longitudes, walking_times}, state);
+    }
+
+    void StreetNetworkWalkTimeCalculator::calculate_walking_times(const std::span<const WalkingTimeQuery> queries) {
+        for (const auto& query : queries) {
+            if (query.latitudes.size() != query.longitudes.size() ||
+                query.latitudes.size() != query.walking_times.size()) {
+                throw std::invalid_argument("Coordinates and walking times must have the same size");
+            }
+        }
+        const auto n_queries = queries.size();
+        const auto n_tasks = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+        const auto chunk_size = std::max<std::size_t>(1, (n_queries + n_tasks - 1) / n_tasks);
+
+        // Each task searches from a contiguous range of origins, using its own search state
+        auto tasks = std::vector<std::future<void>>{};
+        for (std::size_t begin = 0; begin < n_queries; begin += chunk_size) {
+            const auto end = std::min(n_queries, begin + chunk_size);
+            tasks.emplace_back(std::async(std::launch::async, [this, queries, begin, end] {
+                auto search_state = create_search_state();
+                for (const auto& query : queries.subspan(begin, end - begin)) {
+                    search(query, search_state);
+                }
+            }));
+        }
+        for (auto& task : tasks) {
+            task.get();
+        }
+    }
+}
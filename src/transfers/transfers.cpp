@@ -1,61 +1,393 @@
+#include <future>
+#include <limits>
+#include <queue>
 #include <ranges>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <boost/container_hash/hash.hpp>
 #include <transfers/transfers.h>
 
 namespace raptor {
-    void TransferManager::build_same_station_transfers() {
+    void WalkTimeCalculator::calculate_walking_times(const double latitude, const double longitude,
+                                                     const std::span<const double> latitudes,
+                                                     const std::span<const double> longitudes,
+                                                     const std::span<std::chrono::seconds> walking_times) {
+        if (latitudes.size() != longitudes.size() || latitudes.size() != walking_times.size()) {
+            throw std::invalid_argument("Coordinates and walking times must have the same size");
+        }
+        for (std::size_t i = 0; i < latitudes.size(); ++i) {
+            walking_times[i] = calculate_walking_time(latitude, longitude, latitudes[i], longitudes[i]);
+        }
+    }
+
+    void WalkTimeCalculator::calculate_walking_times(const std::span<const double> distances_km,
+                                                     const std::span<std::chrono::seconds> walking_times) {
+        if (distances_km.size() != walking_times.size()) {
+            throw std::invalid_argument("Distances and walking times must have the same size");
+        }
+        for (std::size_t i = 0; i < distances_km.size(); ++i) {
+            walking_times[i] = calculate_walking_time(distances_km[i]);
+        }
+    }
+
+    void WalkTimeCalculator::calculate_walking_times(const std::span<const WalkingTimeQuery> queries) {
+        for (const auto& [latitude, longitude, latitudes, longitudes, walking_times] : queries) {
+            calculate_walking_times(latitude, longitude, latitudes, longitudes, walking_times);
+        }
+    }
+
+    TransferManager::TransferManager(const std::deque<Stop>& stops,
+                                     const NearbyStopsFinder::Factory& nearby_stops_finder_factory,
+                                     std::unique_ptr<WalkTimeCalculator> walk_time_calculator,
+                                     const TransferManagerParameters parameters,
+                                     const std::span<const StopTransfer> given_transfers) :
+        stops(stops), parameters(parameters),
+        nearby_stops_finder(nearby_stops_finder_factory(stops)),
+        walk_time_calculator(std::move(walk_time_calculator)) {
+        // Footpaths are looked up by stop index, so it must match the position of each stop
+        for (std::size_t position = 0; const auto& stop : stops) {
+            if (stop.get_index() != position++) {
+                throw std::invalid_argument("The index of every stop must be equal to its position");
+            }
+        }
+        if (stops.size() > std::numeric_limits<std::uint32_t>::max()) {
+            throw std::invalid_argument("Too many stops for creating transfers");
+        }
+        build_transfers(given_transfers);
+    }
+
+    namespace {
+        /**
+         * Checks whether a transfer between the given stops has been defined.
+         * @param covered Defined transfers, sorted for each stop.
+         */
+        bool is_covered(const std::vector<std::vector<std::uint32_t>>& covered, const std::size_t from,
+                        const std::size_t to) {
+            return std::ranges::binary_search(covered[from], to);
+        }
+    }
+
+    void TransferManager::build_given_transfers(const std::span<const StopTransfer> given_transfers,
+                                                AdjacencyLists& adjacency, CoveredTargets& covered) const {
+        auto index_of = [this](const Stop& stop) {
+            const auto index = stop.get_index();
+            if (index >= stops.size() || &stops[index] != &stop) {
+                throw std::invalid_argument("Transfer refers to a stop not managed by the transfer manager");
+            }
+            return static_cast<std::uint32_t>(index);
+        };
+        auto defined_pairs = std::set<std::pair<std::uint32_t, std::uint32_t>>{};
+        for (const auto& [from_stop, to_stop, type, min_transfer_time] : given_transfers) {
+            const auto from = index_of(from_stop);
+            const auto to = index_of(to_stop);
+            if (!defined_pairs.emplace(from, to).second) {
+                continue;
+            }
+            covered[from].push_back(to);
+            auto duration = std::chrono::seconds{0};
+            switch (type) {
+                case StopTransfer::Type::Recommended: {
+                    auto [from_latitude, from_longitude] = from_stop.get().get_coordinates();
+                    auto [to_latitude, to_longitude] = to_stop.get().get_coordinates();
+                    const auto walking_time = walk_time_calculator->calculate_walking_time(
+                            from_latitude, from_longitude, to_latitude, to_longitude);
+                    if (walking_time == WalkTimeCalculator::unreachable) {
+                        continue;
+                    }
+                    duration = walking_time + parameters.exit_station_duration;
+                    break;
+                }
+                case StopTransfer::Type::Timed:
+                    break;
+                case StopTransfer::Type::MinimumTime:
+                    duration = min_transfer_time;
+                    break;
+                case StopTransfer::Type::NotPossible:
+                    continue;
+            }
+            adjacency[from].push_back({to, std::chrono::duration_cast<Footpath::Duration>(duration)});
+        }
+        for (auto& stop_covered : covered) {
+            std::ranges::sort(stop_covered);
+        }
+    }
+
+    void TransferManager::build_same_station_transfers(AdjacencyLists& adjacency, CoveredTargets& covered) const {
         // Create a transfer between all stops in the same parent station.
         for (const auto& from_stop : stops) {
             if (auto parent_station = from_stop.get_parent_station()) {
-                auto stops_in_station = parent_station->get().get_stops();
-                auto is_not_this_stop = [&from_stop](const Stop& other_stop) {
-                    return from_stop != other_stop;
+                const auto from = from_stop.get_index();
+                // Only the given transfers are searched, since each pair of stops is visited once
+                const auto n_given = covered[from].size();
+                auto is_given = [&covered, from, n_given](const std::size_t to) {
+                    return std::ranges::binary_search(std::span{covered[from]}.first(n_given), to);
                 };
-
-                auto transfers_with_times = std::vector<std::pair<std::reference_wrapper<const Stop>,
-                                                                  std::chrono::seconds>>{};
-                std::ranges::transform(stops_in_station | std::views::filter(is_not_this_stop),
-                                       std::back_inserter(transfers_with_times),
-                                       [this](const Stop& to_stop) {
-                                           return std::make_pair(std::cref(to_stop), parameters.in_station_transfer_duration);
-                                       });
-                this->transfers.emplace(from_stop, std::move(transfers_with_times));
+                for (const Stop& to_stop : parent_station->get().get_stops()) {
+                    const auto to = static_cast<std::uint32_t>(to_stop.get_index());
+                    if (from_stop != to_stop && !is_given(to)) {
+                        covered[from].push_back(to);
+                        adjacency[from].push_back({to, std::chrono::duration_cast<Footpath::Duration>(
+                                                           parameters.in_station_transfer_duration)});
+                    }
+                }
             }
         }
     }
 
-    void TransferManager::build_on_foot_transfers() {
+    void TransferManager::build_on_foot_transfers(AdjacencyLists& adjacency, CoveredTargets& covered) const {
+        // On-foot transfers are appended after the existing ones, which are kept in the order of their targets
+        for (auto& stop_footpaths : adjacency) {
+            std::ranges::sort(stop_footpaths, std::less{}, &Footpath::target_stop_index);
+        }
+        for (auto& stop_covered : covered) {
+            std::ranges::sort(stop_covered);
+        }
+        if (walk_time_calculator->requires_coordinates()) {
+            build_on_foot_transfers_from_coordinates(adjacency, covered);
+            return;
+        }
+        auto has_existing_transfer = [&covered](const std::size_t from, const std::size_t to) {
+            return is_covered(covered, from, to);
+        };
+        // Walking times are calculated in batches, so that the calculator can process many distances at once
+        auto distances = std::vector<double>{};
+        auto walking_times = std::vector<std::chrono::seconds>{};
+        auto calculate_transfer_times = [this, &distances, &walking_times] {
+            walking_times.resize(distances.size());
+            walk_time_calculator->calculate_walking_times(distances, walking_times);
+        };
+        auto transfer_time = [this](const std::chrono::seconds walking_time) {
+            return std::chrono::duration_cast<Footpath::Duration>(walking_time + parameters.exit_station_duration);
+        };
+
+        if (auto stop_pairs = nearby_stops_finder->stop_pairs_in_radius(parameters.max_radius_km)) {
+            // Transfers given by the feed are not necessarily symmetric, so each direction is checked separately
+            std::erase_if(*stop_pairs, [&has_existing_transfer](const StopPairWithDistance& pair) {
+                return has_existing_transfer(pair.first, pair.second) && has_existing_transfer(pair.second,
+                    pair.first);
+            });
+            std::ranges::transform(*stop_pairs, std::back_inserter(distances), &StopPairWithDistance::distance_km);
+            calculate_transfer_times();
+            for (std::size_t i = 0; i < stop_pairs->size(); ++i) {
+                const auto& [first, second, distance_km] = (*stop_pairs)[i];
+                const auto duration = transfer_time(walking_times[i]);
+                if (!has_existing_transfer(first, second)) {
+                    adjacency[first].push_back({second, duration});
+                }
+                if (!has_existing_transfer(second, first)) {
+                    adjacency[second].push_back({first, duration});
+                }
+            }
+            return;
+        }
+
         for (const auto& origin_stop : stops) {
             auto [latitude, longitude] = origin_stop.get_coordinates();
             auto nearby_stops = nearby_stops_finder->stops_in_radius(latitude, longitude, parameters.max_radius_km);
 
-            auto& existing_transfers = transfers[origin_stop];
+            const auto origin_index = origin_stop.get_index();
             // Given a destination stop, it checks that there is no existing transfer defined between it and the
             // origin stop.
-            auto no_existing_transfer = [&existing_transfers](const StopWithDistance& to_stop) {
-                return std::ranges::all_of(existing_transfers,
-                                           [&to_stop](const Stop& existing_stop) {
-                                               return existing_stop != to_stop.stop;
-                                           }, &StopWithDuration::first);
+            auto no_existing_transfer = [&has_existing_transfer, origin_index](const StopWithDistance& to_stop) {
+                return !has_existing_transfer(origin_index, to_stop.stop.get_index());
             };
+            auto new_transfers = nearby_stops | std::views::filter(no_existing_transfer);
+
+            distances.clear();
+            std::ranges::transform(new_transfers, std::back_inserter(distances), &StopWithDistance::distance_km);
+            calculate_transfer_times();
+            for (std::size_t i = 0; const auto& to_stop : new_transfers) {
+                adjacency[origin_index].push_back({static_cast<std::uint32_t>(to_stop.stop.get_index()),
+                                                   transfer_time(walking_times[i++])});
+            }
+        }
+    }
+
+    void TransferManager::build_on_foot_transfers_from_coordinates(AdjacencyLists& adjacency,
+                                                                   const CoveredTargets& covered) const {
+        auto targets = std::vector<std::vector<std::uint32_t>>(stops.size());
+        if (auto stop_pairs = nearby_stops_finder->stop_pairs_in_radius(parameters.max_radius_km)) {
+            for (const auto& [first, second, distance_km] : *stop_pairs) {
+                if (!is_covered(covered, first, second)) {
+                    targets[first].push_back(second);
+                }
+                if (!is_covered(covered, second, first)) {
+                    targets[second].push_back(first);
+                }
+            }
+        } else {
+            for (const auto& origin_stop : stops) {
+                auto [latitude, longitude] = origin_stop.get_coordinates();
+                const auto origin_index = origin_stop.get_index();
+                for (const auto& [to_stop, distance_km] : nearby_stops_finder->stops_in_radius(
+                             latitude, longitude, parameters.max_radius_km)) {
+                    if (!is_covered(covered, origin_index, to_stop.get_index())) {
+                        targets[origin_index].push_back(static_cast<std::uint32_t>(to_stop.get_index()));
+                    }
+                }
+            }
+        }
 
-            std::ranges::transform(nearby_stops | std::views::filter(no_existing_transfer),
-                                   std::back_inserter(existing_transfers),
-                                   [this](const StopWithDistance& to_stop) {
-                                       auto walk_time =
-                                               walk_time_calculator->calculate_walking_time(to_stop.distance_km);
-                                       auto transfer_time = walk_time + parameters.exit_station_duration;
-                                       return std::make_pair(std::cref(to_stop.stop), transfer_time);
-                                   });
+        // The coordinates of all targets are stored contiguously, with the targets of each stop in a separate range
+        auto n_targets = std::size_t{0};
+        for (const auto& stop_targets : targets) {
+            n_targets += stop_targets.size();
+        }
+        auto latitudes = std::vector<double>{};
+        auto longitudes = std::vector<double>{};
+        latitudes.reserve(n_targets);
+        longitudes.reserve(n_targets);
+        auto walking_times = std::vector<std::chrono::seconds>(n_targets);
+        auto queries = std::vector<WalkingTimeQuery>{};
+        for (std::size_t origin = 0; origin < stops.size(); ++origin) {
+            if (targets[origin].empty()) {
+                continue;
+            }
+            const auto begin = latitudes.size();
+            for (const auto target : targets[origin]) {
+                auto [latitude, longitude] = stops[target].get_coordinates();
+                latitudes.push_back(latitude);
+                longitudes.push_back(longitude);
+            }
+            auto [latitude, longitude] = stops[origin].get_coordinates();
+            const auto size = targets[origin].size();
+            queries.push_back({latitude, longitude, std::span{latitudes}.subspan(begin, size),
+                               std::span{longitudes}.subspan(begin, size),
+                               std::span{walking_times}.subspan(begin, size)});
         }
+        walk_time_calculator->calculate_walking_times(queries);
+
+        for (std::size_t origin = 0, position = 0; origin < stops.size(); ++origin) {
+            for (const auto target : targets[origin]) {
+                const auto walking_time = walking_times[position++];
+                if (walking_time != WalkTimeCalculator::unreachable) {
+                    adjacency[origin].push_back({target, std::chrono::duration_cast<Footpath::Duration>(
+                                                         walking_time + parameters.exit_station_duration)});
+                }
+            }
+        }
+    }
+
+    void TransferManager::close_footpaths(AdjacencyLists& adjacency, const CoveredTargets& covered) const {
+        const auto max_duration = std::chrono::duration_cast<Footpath::Duration>(parameters.max_closure_duration);
+        const auto exit_duration = std::chrono::duration_cast<Footpath::Duration>(parameters.exit_station_duration);
+        constexpr auto not_reached = Footpath::Duration::max();
+        const auto n_stops = adjacency.size();
+        const auto n_tasks = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+        const auto chunk_size = std::max<std::size_t>(1, (n_stops + n_tasks - 1) / n_tasks);
+
+        // Each task searches from a contiguous range of stops, writing only the footpaths of those stops
+        auto closed = AdjacencyLists(n_stops);
+        auto tasks = std::vector<std::future<void>>{};
+        for (std::size_t begin = 0; begin < n_stops; begin += chunk_size) {
+            const auto end = std::min(n_stops, begin + chunk_size);
+            tasks.emplace_back(std::async(std::launch::async, [&, begin, end] {
+                // The search runs over two copies of the stops. Stop i is state i before any footpath on foot is
+                // taken and state n_stops + i after, so that the exit duration is paid only by the first of them.
+                // Only the durations of the reached states are reset after each search.
+                auto durations = std::vector<Footpath::Duration>(2 * n_stops, not_reached);
+                auto reached = std::vector<std::size_t>{};
+                using QueueItem = std::pair<Footpath::Duration, std::size_t>;
+                auto queue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<>>{};
+                auto try_improve = [&durations, &reached, not_reached](const std::size_t state,
+                                                                       const Footpath::Duration duration) {
+                    if (duration >= durations[state]) {
+                        return false;
+                    }
+                    if (durations[state] == not_reached) {
+                        reached.push_back(state);
+                    }
+                    durations[state] = duration;
+                    return true;
+                };
+
+                for (auto origin = static_cast<std::uint32_t>(begin); origin < end; ++origin) {
+                    try_improve(origin, Footpath::Duration{0});
+                    queue.emplace(Footpath::Duration{0}, origin);
+                    while (!queue.empty()) {
+                        const auto [duration, state] = queue.top();
+                        queue.pop();
+                        if (duration > durations[state]) {
+                            continue;
+                        }
+                        const auto walked = state >= n_stops;
+                        const auto stop = walked ? state - n_stops : state;
+                        for (const auto& [target, footpath_duration] : adjacency[stop]) {
+                            const auto on_foot = !is_covered(covered, stop, target);
+                            // Footpaths on foot include the exit duration, which only the first of them pays
+                            const auto target_state = walked || on_foot ? n_stops + target : std::size_t{target};
+                            const auto target_duration = walked && on_foot
+                                                             ? duration + footpath_duration - exit_duration
+                                                             : duration + footpath_duration;
+                            if (target_duration <= max_duration && try_improve(target_state, target_duration)) {
+                                queue.emplace(target_duration, target_state);
+                            }
+                        }
+                    }
+
+                    // Direct footpaths are kept even if they are longer than the maximum duration
+                    auto& origin_footpaths = closed[origin];
+                    for (const auto& footpath : adjacency[origin]) {
+                        if (is_covered(covered, origin, footpath.target_stop_index)) {
+                            origin_footpaths.push_back(footpath);
+                        } else {
+                            try_improve(n_stops + footpath.target_stop_index, footpath.duration);
+                        }
+                    }
+                    // Each stop gets the shorter duration of its two states
+                    for (const auto state : reached) {
+                        const auto walked = state >= n_stops;
+                        const auto target = walked ? state - n_stops : state;
+                        const auto other_duration = durations[walked ? target : n_stops + target];
+                        const auto shortest = durations[state] < other_duration ||
+                                (durations[state] == other_duration && !walked);
+                        if (shortest && target != origin && !is_covered(covered, origin, target)) {
+                            origin_footpaths.push_back({static_cast<std::uint32_t>(target), durations[state]});
+                        }
+                    }
+                    for (const auto state : reached) {
+                        durations[state] = not_reached;
+                    }
+                    reached.clear();
+                    std::ranges::sort(origin_footpaths, std::less{}, &Footpath::target_stop_index);
+                }
+            }));
+        }
+        for (auto& task : tasks) {
+            task.get();
+        }
+        adjacency = std::move(closed);
+    }
+
+    void TransferManager::compile_footpaths(const AdjacencyLists& adjacency) {
+        footpath_offsets.clear();
+        footpath_offsets.reserve(adjacency.size() + 1);
+        footpath_offsets.push_back(0);
+        for (const auto& stop_footpaths : adjacency) {
+            footpath_offsets.push_back(footpath_offsets.back() + stop_footpaths.size());
+        }
+        footpaths.clear();
+        footpaths.reserve(footpath_offsets.back());
+        for (const auto& stop_footpaths : adjacency) {
+            footpaths.insert(footpaths.end(), stop_footpaths.begin(), stop_footpaths.end());
+        }
+    }
+
+    MemoryUsage TransferManager::memory_usage() const {
+        auto usage = MemoryUsage{"transfer manager", sizeof(TransferManager)};
+        usage.add("footpath offsets", memory::heap_bytes(footpath_offsets));
+        usage.add("footpaths", memory::heap_bytes(footpaths));
+        usage.add(nearby_stops_finder->memory_usage());
+        return usage;
     }
 
-    const std::vector<TransferManager::StopWithDuration>&
-    TransferManager::get_transfers_from_stop(const Stop& stop) const {
-        const auto stop_transfers = transfers.find(stop);
-        if (stop_transfers == transfers.end()) {
-            // TODO: This seems a bit meh
-            return empty;
+    std::uint64_t TransferManager::fingerprint() const {
+        auto seed = boost::hash_range(footpath_offsets.begin(), footpath_offsets.end());
+        for (const auto& [target_stop_index, duration] : footpaths) {
+            boost::hash_combine(seed, target_stop_index);
+            boost::hash_combine(seed, duration.count());
         }
-        return stop_transfers->second;
+        return seed;
     }
 }
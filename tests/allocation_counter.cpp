@@ -0,0 +1,107 @@
+#include <cstdlib>
+#include <new>
+
+#include "allocation_counter.h"
+
+namespace {
+    thread_local auto thread_allocations = raptor::AllocationCount{};
+    /**
+     * Number of counters alive on the thread. Allocations are only counted while it is not 0.
+     */
+    thread_local auto active_counters = 0;
+
+    void* allocate(const std::size_t size, const std::size_t alignment = 0) noexcept {
+        if (active_counters > 0) {
+            ++thread_allocations.allocations;
+            thread_allocations.bytes += size;
+        }
+        const auto requested = size == 0 ? 1 : size;
+        if (alignment > alignof(std::max_align_t)) {
+            // The size given to aligned_alloc must be a multiple of the alignment
+            return std::aligned_alloc(alignment, (requested + alignment - 1) / alignment * alignment);
+        }
+        return std::malloc(requested);
+    }
+
+    void* allocate_or_throw(const std::size_t size, const std::size_t alignment = 0) {
+        if (auto* pointer = allocate(size, alignment)) {
+            return pointer;
+        }
+        throw std::bad_alloc();
+    }
+}
+
+namespace raptor {
+    AllocationCounter::AllocationCounter() :
+        start(thread_allocations) {
+        ++active_counters;
+    }
+
+    AllocationCounter::~AllocationCounter() {
+        --active_counters;
+    }
+
+    AllocationCount AllocationCounter::count() const noexcept {
+        return {thread_allocations.allocations - start.allocations, thread_allocations.bytes - start.bytes};
+    }
+}
+
+/*
+ * Replacements of the global allocation functions, which count the allocations of the thread.
+ */
+
+void* operator new(const std::size_t size) {
+    return allocate_or_throw(size);
+}
+
+void* operator new[](const std::size_t size) {
+    return allocate_or_throw(size);
+}
+
+void* operator new(const std::size_t size, const std::align_val_t alignment) {
+    return allocate_or_throw(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new[](const std::size_t size, const std::align_val_t alignment) {
+    return allocate_or_throw(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new(const std::size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size);
+}
+
+void* operator new[](const std::size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size);
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept {
+    std::free(pointer);
+}
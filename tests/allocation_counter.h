@@ -0,0 +1,32 @@
+#ifndef PT_ROUTING_ALLOCATION_COUNTER_H
+#define PT_ROUTING_ALLOCATION_COUNTER_H
+#include <cstddef>
+
+namespace raptor {
+    struct AllocationCount {
+        std::size_t allocations = 0;
+        std::size_t bytes = 0;
+    };
+
+    /**
+     * Counts the heap allocations made by the current thread while the object exists, through the global operator
+     * new replaced by the test executable. Allocations of other threads are not counted.
+     */
+    class AllocationCounter {
+        AllocationCount start;
+
+    public:
+        AllocationCounter();
+        ~AllocationCounter();
+
+        AllocationCounter(const AllocationCounter&) = delete;
+        AllocationCounter& operator=(const AllocationCounter&) = delete;
+
+        /**
+         * Allocations made since the object was created.
+         */
+        [[nodiscard]] AllocationCount count() const noexcept;
+    };
+}
+
+#endif //PT_ROUTING_ALLOCATION_COUNTER_H
@@ -0,0 +1,82 @@
+/**
+ * Audits the heap allocations made by queries, so that new allocations in the query code are noticed.
+ */
+#include <random>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include <raptor/raptor.h>
+#include <schedule/synthetic.h>
+#include <transfers/kd_tree.h>
+#include <transfers/linear_walk_calculator.h>
+
+#include "../allocation_counter.h"
+
+using namespace raptor;
+using namespace std::chrono_literals;
+
+/**
+ * Most allocations a single query may make after warming up. Lower it whenever allocations are removed from the
+ * query code, until queries do not allocate at all. The remaining allocations are those of the returned journey.
+ */
+constexpr auto allocation_budget = std::size_t{3};
+
+TEST(AllocationCounter, CountsAllocationsOfThread) {
+    auto counter = AllocationCounter{};
+    auto vector = std::vector<int>(100);
+    const auto count = counter.count();
+    EXPECT_EQ(count.allocations, 1);
+    EXPECT_EQ(count.bytes, 100 * sizeof(int));
+}
+
+TEST(AllocationCounter, IgnoresAllocationsOutsideCounter) {
+    auto counter = AllocationCounter{};
+    {
+        auto vector = std::vector<int>(100);
+    }
+    const auto before = counter.count();
+    std::thread([] {
+        auto vector = std::vector<int>(100);
+    }).join();
+    // The thread itself might allocate on this thread, but the vector of the other thread is not counted
+    EXPECT_LT(counter.count().bytes - before.bytes, 100 * sizeof(int));
+}
+
+TEST(QueryAllocations, QueriesStayWithinBudget) {
+    const auto schedule = synthetic::generate_schedule({.n_routes = 10, .stops_per_route = 12, .service_days = 1});
+    auto router = Raptor(schedule, TransferManager(schedule, StopKDTree::create_factory(),
+                                                   std::make_unique<LinearWalkTimeCalculator>(5.0)));
+    const auto& stops = schedule.get_stops();
+    const auto* time_zone = std::chrono::locate_zone("Europe/Stockholm");
+
+    auto generator = std::mt19937{1};
+    auto stop = std::uniform_int_distribution<std::size_t>{0, stops.size() - 1};
+    struct Query {
+        const Stop& origin;
+        const Stop& destination;
+        Time departure_time;
+    };
+    auto queries = std::vector<Query>{};
+    for (auto i = 0; i < 50; ++i) {
+        const auto departure = std::chrono::local_days{std::chrono::September / 1 / 2025} + 7h + i * 5min;
+        queries.push_back({stops[stop(generator)], stops[stop(generator)], Time{time_zone, departure}});
+    }
+    // Warm up, so that one-off allocations, for example of the time zone database, are not counted
+    for (const auto& [origin, destination, departure_time] : queries) {
+        router.route(origin, destination, departure_time);
+    }
+
+    auto max_allocations = std::size_t{0};
+    auto total_bytes = std::size_t{0};
+    for (const auto& [origin, destination, departure_time] : queries) {
+        const auto counter = AllocationCounter{};
+        router.route(origin, destination, departure_time);
+        const auto count = counter.count();
+        max_allocations = std::max(max_allocations, count.allocations);
+        total_bytes += count.bytes;
+    }
+    EXPECT_LE(max_allocations, allocation_budget);
+    RecordProperty("max_allocations_per_query", static_cast<int>(max_allocations));
+    RecordProperty("bytes_per_query", static_cast<int>(total_bytes / queries.size()));
+}
@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+
+#include <raptor/query_log.h>
+
+#include "../routing_fixture.h"
+
+using namespace raptor;
+using namespace std::chrono_literals;
+
+class QueryLogTest : public RoutingTest {
+protected:
+    std::string path = (std::filesystem::temp_directory_path() / "pt_routing_query_log_test.bin").string();
+
+    QueryLogTest() :
+        RoutingTest({.n_routes = 4, .stops_per_route = 6, .service_days = 1}) {
+    }
+
+    void TearDown() override {
+        std::filesystem::remove(path);
+    }
+
+    /**
+     * Runs the same query the given number of times through a new log, and reads the log back.
+     */
+    QueryLog::Contents run_queries(const QueryLogParameters& parameters, const int n_queries) {
+        const auto& stops = schedule.get_stops();
+        {
+            auto log = QueryLog(path, router, parameters);
+            for (auto i = 0; i < n_queries; ++i) {
+                log.route(router, stops.front(), stops.back(), departure_time());
+            }
+        }
+        return QueryLog::read(path);
+    }
+};
+
+TEST_F(QueryLogTest, LogsQueriesOverThreshold) {
+    const auto contents = run_queries({.latency_threshold = 0ns}, 3);
+    EXPECT_EQ(contents.schedule_fingerprint, schedule.fingerprint());
+    EXPECT_EQ(contents.transfers_fingerprint, router.get_transfer_manager().fingerprint());
+    ASSERT_EQ(contents.queries.size(), 3);
+    const auto& query = contents.queries.front();
+    EXPECT_EQ(query.origin, schedule.get_stops().front().get_index());
+    EXPECT_EQ(query.destination, schedule.get_stops().back().get_index());
+    EXPECT_EQ(query.departure_time, departure_time().get_sys_time());
+    EXPECT_GT(query.latency, 0ns);
+    if (QueryStats::enabled) {
+        EXPECT_GE(query.rounds, 1);
+        EXPECT_GT(query.work.routes_scanned, 0);
+    }
+}
+
+TEST_F(QueryLogTest, SkipsFastQueries) {
+    const auto contents = run_queries({.latency_threshold = 1h}, 10);
+    EXPECT_TRUE(contents.queries.empty());
+}
+
+TEST_F(QueryLogTest, SamplesFastQueries) {
+    const auto contents = run_queries({.latency_threshold = 1h, .sample_fraction = 0.5}, 200);
+    EXPECT_GT(contents.queries.size(), 60);
+    EXPECT_LT(contents.queries.size(), 140);
+    EXPECT_EQ(run_queries({.latency_threshold = 1h, .sample_fraction = 1.0}, 20).queries.size(), 20);
+}
+
+TEST_F(QueryLogTest, FingerprintDependsOnSchedule) {
+    EXPECT_EQ(schedule.fingerprint(), schedule.fingerprint());
+    const auto other = synthetic::generate_schedule({.n_routes = 4, .stops_per_route = 7, .service_days = 1});
+    EXPECT_NE(schedule.fingerprint(), other.fingerprint());
+}
+
+TEST_F(QueryLogTest, ThrowsOnInvalidFile) {
+    EXPECT_THROW(QueryLog::read(path), std::runtime_error);
+    {
+        auto file = std::ofstream(path);
+        file << "not a query log";
+    }
+    EXPECT_THROW(QueryLog::read(path), std::runtime_error);
+}
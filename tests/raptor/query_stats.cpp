@@ -0,0 +1,57 @@
+#include <gtest/gtest.h>
+
+#include "../routing_fixture.h"
+
+using namespace raptor;
+using namespace std::chrono_literals;
+
+using QueryStatsTest = RoutingTest;
+
+TEST_F(QueryStatsTest, StatsDoNotChangeJourney) {
+    const auto& stops = schedule.get_stops();
+    auto stats = QueryStats{};
+    const auto with_stats = router.route(stops.front(), stops.back(), departure_time(), &stats);
+    const auto without_stats = router.route(stops.front(), stops.back(), departure_time());
+    ASSERT_FALSE(without_stats.empty());
+    expect_same_journey(with_stats, without_stats);
+}
+
+TEST_F(QueryStatsTest, CountsWorkOfEachRound) {
+    if (!QueryStats::enabled) {
+        GTEST_SKIP() << "Built without PT_ROUTING_QUERY_STATS";
+    }
+    const auto& stops = schedule.get_stops();
+    auto stats = QueryStats{};
+    const auto journey = router.route(stops.front(), stops.back(), departure_time(), &stats);
+    ASSERT_FALSE(journey.empty());
+
+    EXPECT_GE(stats.rounds_executed(), 1);
+    EXPECT_EQ(stats.rounds.size(), stats.rounds_executed() + 1);
+    // The origin and the stops reached on foot from it are the stops marked for the first round
+    ASSERT_GE(stats.rounds.size(), 2);
+    EXPECT_EQ(stats.rounds[0].routes_scanned, 0);
+    EXPECT_EQ(stats.rounds[1].stops_marked, 1 + stats.rounds[0].labels_improved);
+    EXPECT_GT(stats.rounds[1].routes_scanned, 0);
+    // Each scanned route searches for a trip at least once
+    const auto total = stats.total();
+    EXPECT_GE(total.trips_searched, total.routes_scanned);
+    EXPECT_GT(total.stop_events_visited, 0);
+    EXPECT_GT(total.labels_improved, 0);
+    EXPECT_GT(stats.route_scanning, 0ns);
+
+    // Statistics are reset by every query
+    auto second_stats = stats;
+    router.route(stops.front(), stops.back(), departure_time(), &second_stats);
+    EXPECT_EQ(second_stats.rounds.size(), stats.rounds.size());
+    EXPECT_EQ(second_stats.total().stop_events_visited, total.stop_events_visited);
+}
+
+TEST(QueryStats, RecorderIgnoresMissingStats) {
+    const auto recorder = QueryStatsRecorder{nullptr};
+    EXPECT_FALSE(recorder.recording());
+    recorder.new_round();
+    recorder.add(&RoundStats::routes_scanned);
+    EXPECT_EQ(recorder.time(&QueryStats::transfers, [] {
+        return 1;
+    }), 1);
+}
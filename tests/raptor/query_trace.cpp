@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include "../routing_fixture.h"
+
+using namespace raptor;
+using namespace std::chrono_literals;
+
+class QueryTraceTest : public RoutingTest {
+protected:
+    std::string path = (std::filesystem::temp_directory_path() / "pt_routing_query_trace_test.bin").string();
+
+    void TearDown() override {
+        std::filesystem::remove(path);
+    }
+
+    /**
+     * A small trace with a trip and a transfer, which does not depend on the trace being recorded.
+     */
+    QueryTrace example_trace() const {
+        const auto departure = departure_time().get_sys_time();
+        const auto& route = schedule.get_routes().front();
+        const auto first_stop = static_cast<std::uint32_t>(route.stop_sequence()[0].get().get_index());
+        const auto second_stop = static_cast<std::uint32_t>(route.stop_sequence()[1].get().get_index());
+        auto trace = QueryTrace{first_stop, second_stop, departure, {}};
+        trace.rounds.push_back({{first_stop}, {}, {}});
+        trace.rounds.push_back({{first_stop}, {{static_cast<std::uint32_t>(route.get_index()), 0}},
+                                {{second_stop, first_stop, departure + 5min, LabelReason::Trip,
+                                  static_cast<std::uint32_t>(route.get_index())},
+                                 {first_stop, second_stop, departure + 9min, LabelReason::Transfer}}});
+        return trace;
+    }
+};
+
+TEST_F(QueryTraceTest, TraceMatchesStats) {
+    const auto& stops = schedule.get_stops();
+    auto stats = QueryStats{};
+    auto trace = QueryTrace{};
+    const auto journey = router.route(stops.front(), stops.back(), departure_time(), &stats, &trace);
+    ASSERT_FALSE(journey.empty());
+    if (!QueryStats::enabled) {
+        EXPECT_TRUE(trace.rounds.empty());
+        return;
+    }
+    EXPECT_EQ(trace.origin, stops.front().get_index());
+    EXPECT_EQ(trace.destination, stops.back().get_index());
+    ASSERT_EQ(trace.rounds.size(), stats.rounds.size());
+    EXPECT_EQ(trace.rounds[0].marked_stops, std::vector{trace.origin});
+    for (std::size_t round = 0; round < trace.rounds.size(); ++round) {
+        if (round > 0) {
+            EXPECT_EQ(trace.rounds[round].marked_stops.size(), stats.rounds[round].stops_marked);
+        }
+        EXPECT_EQ(trace.rounds[round].routes.size(), stats.rounds[round].routes_scanned);
+        EXPECT_EQ(trace.rounds[round].labels.size(), stats.rounds[round].labels_improved);
+        EXPECT_TRUE(std::ranges::is_sorted(trace.rounds[round].marked_stops));
+    }
+    // The destination is reached by one of the traced labels
+    const auto reaches_destination = std::ranges::any_of(trace.rounds, [&trace](const TracedRound& round) {
+        return std::ranges::any_of(round.labels, [&trace](const TracedLabel& label) {
+            return label.stop == trace.destination;
+        });
+    });
+    EXPECT_TRUE(reaches_destination);
+}
+
+TEST_F(QueryTraceTest, WritesAndReadsTrace) {
+    const auto trace = example_trace();
+    trace.write(path, schedule);
+    const auto read = QueryTrace::read(path, schedule);
+    EXPECT_EQ(read.origin, trace.origin);
+    EXPECT_EQ(read.destination, trace.destination);
+    EXPECT_EQ(read.departure_time, trace.departure_time);
+    ASSERT_EQ(read.rounds.size(), 2);
+    EXPECT_EQ(read.rounds[1].marked_stops, trace.rounds[1].marked_stops);
+    ASSERT_EQ(read.rounds[1].routes.size(), 1);
+    EXPECT_EQ(read.rounds[1].routes[0].route, trace.rounds[1].routes[0].route);
+    ASSERT_EQ(read.rounds[1].labels.size(), 2);
+    const auto& transfer = read.rounds[1].labels[1];
+    EXPECT_EQ(transfer.reason, LabelReason::Transfer);
+    EXPECT_EQ(transfer.route, TracedLabel::no_route);
+    EXPECT_EQ(transfer.arrival_time, trace.departure_time + 9min);
+}
+
+TEST_F(QueryTraceTest, RejectsOtherSchedules) {
+    example_trace().write(path, schedule);
+    const auto other = synthetic::generate_schedule({.n_routes = 6, .stops_per_route = 9, .service_days = 1});
+    EXPECT_THROW(QueryTrace::read(path, other), std::runtime_error);
+    {
+        auto file = std::ofstream(path);
+        file << "not a trace";
+    }
+    EXPECT_THROW(QueryTrace::read(path, schedule), std::runtime_error);
+}
+
+TEST_F(QueryTraceTest, WritesGeoJson) {
+    auto output = std::ostringstream{};
+    example_trace().write_geojson(output, schedule);
+    const auto geojson = output.str();
+    EXPECT_TRUE(geojson.starts_with(R"({"type":"FeatureCollection","features":[)"));
+    EXPECT_TRUE(geojson.ends_with("]}\n"));
+    const auto count = [&geojson](const std::string& text) {
+        auto n = 0;
+        for (auto position = geojson.find(text); position != std::string::npos;
+             position = geojson.find(text, position + 1)) {
+            ++n;
+        }
+        return n;
+    };
+    EXPECT_EQ(count(R"("type":"Feature",)"), 7);
+    EXPECT_EQ(count(R"("kind":"marked_stop")"), 2);
+    EXPECT_EQ(count(R"("kind":"scanned_route")"), 1);
+    EXPECT_EQ(count(R"("reason":"trip")"), 1);
+    EXPECT_EQ(count(R"("reason":"transfer")"), 1);
+    EXPECT_EQ(count(R"("arrival_seconds":300)"), 1);
+    // GeoJSON positions have the longitude first
+    const auto [latitude, longitude] = schedule.get_stops()[example_trace().origin].get_coordinates();
+    auto position = std::ostringstream{};
+    position.precision(10);
+    position << '[' << longitude << ',' << latitude << ']';
+    EXPECT_NE(geojson.find(position.str()), std::string::npos);
+}
@@ -0,0 +1,21 @@
+#include <gtest/gtest.h>
+
+#include "../routing_fixture.h"
+
+using namespace raptor;
+
+using RaptorTest = RoutingTest;
+
+TEST_F(RaptorTest, RoutesBetweenStopIndices) {
+    const auto& stops = schedule.get_stops();
+    const auto by_stop = router.route(stops.front(), stops.back(), departure_time());
+    const auto by_index = router.route(stops.front().get_index(), stops.back().get_index(), departure_time());
+    ASSERT_FALSE(by_stop.empty());
+    expect_same_journey(by_index, by_stop);
+}
+
+TEST_F(RaptorTest, ThrowsOnInvalidStopIndex) {
+    const auto n_stops = schedule.get_stops().size();
+    EXPECT_THROW(router.route(0, n_stops, departure_time()), std::out_of_range);
+    EXPECT_THROW(router.route(n_stops, 0, departure_time()), std::out_of_range);
+}
@@ -0,0 +1,55 @@
+#ifndef PT_ROUTING_ROUTING_FIXTURE_H
+#define PT_ROUTING_ROUTING_FIXTURE_H
+#include <gtest/gtest.h>
+
+#include <raptor/raptor.h>
+#include <schedule/synthetic.h>
+#include <transfers/kd_tree.h>
+#include <transfers/linear_walk_calculator.h>
+
+namespace raptor {
+    /**
+     * Fixture with a router for a synthetic schedule. By default, routes run along the rows and columns of a grid, so
+     * that most queries need a transfer.
+     */
+    class RoutingTest : public testing::Test {
+    protected:
+        Schedule schedule;
+        Raptor router{schedule, TransferManager(schedule, StopKDTree::create_factory(),
+                                                std::make_unique<LinearWalkTimeCalculator>(5.0))};
+        const std::chrono::time_zone* time_zone = std::chrono::locate_zone("Europe/Stockholm");
+
+        explicit RoutingTest(const synthetic::NetworkParameters& parameters = {
+                                     .n_routes = 6, .stops_per_route = 8, .service_days = 1}) :
+            schedule(synthetic::generate_schedule(parameters)) {
+        }
+
+        /**
+         * Departure time during the service of the schedule.
+         */
+        Time departure_time() const {
+            using namespace std::chrono_literals;
+            return Time{time_zone, std::chrono::local_days{std::chrono::September / 1 / 2025} + 8h};
+        }
+
+        /**
+         * Expects two journeys to have the same movements, arriving at the same times and, for movements with public
+         * transport, using the same routes.
+         */
+        static void expect_same_journey(const std::vector<Movement>& actual, const std::vector<Movement>& expected) {
+            ASSERT_EQ(actual.size(), expected.size());
+            const auto arrival_time = [](const auto& movement) {
+                return movement.get_arrival_time().get_sys_time();
+            };
+            for (std::size_t i = 0; i < expected.size(); ++i) {
+                ASSERT_EQ(actual[i].index(), expected[i].index());
+                EXPECT_EQ(std::visit(arrival_time, actual[i]), std::visit(arrival_time, expected[i]));
+                if (const auto* movement = std::get_if<PTMovement>(&expected[i])) {
+                    EXPECT_EQ(std::get<PTMovement>(actual[i]).get_route(), movement->get_route());
+                }
+            }
+        }
+    };
+}
+
+#endif //PT_ROUTING_ROUTING_FIXTURE_H
@@ -0,0 +1,225 @@
+#include <gtest/gtest.h>
+
+#include <schedule/gtfs.h>
+
+using namespace raptor;
+using namespace std::chrono_literals;
+
+constexpr auto service_day = 16d / std::chrono::September / 2025;
+
+/**
+ * Creates a feed with a single trip from stop A to stop B, departing at 08:00 on the service day. All feeds use the
+ * same IDs.
+ */
+::gtfs::Feed create_feed(const std::string& time_zone) {
+    auto feed = ::gtfs::Feed{};
+
+    auto agency = ::gtfs::Agency{};
+    agency.agency_id = "1";
+    agency.agency_name = "Agency";
+    agency.agency_timezone = time_zone;
+    feed.add_agency(agency);
+
+    for (const auto& stop_id : {"A", "B"}) {
+        auto stop = ::gtfs::Stop{};
+        stop.stop_id = stop_id;
+        stop.stop_name = stop_id;
+        feed.add_stop(stop);
+    }
+
+    auto route = ::gtfs::Route{};
+    route.route_id = "R";
+    route.agency_id = "1";
+    feed.add_route(route);
+
+    auto trip = ::gtfs::Trip{};
+    trip.route_id = "R";
+    trip.service_id = "S";
+    trip.trip_id = "T";
+    feed.add_trip(trip);
+
+    auto calendar = ::gtfs::CalendarItem{};
+    calendar.service_id = "S";
+    calendar.start_date = ::gtfs::Date(2025, 9, 1);
+    calendar.end_date = ::gtfs::Date(2025, 9, 30);
+    feed.add_calendar_item(calendar);
+
+    auto calendar_date = ::gtfs::CalendarDate{};
+    calendar_date.service_id = "S";
+    calendar_date.date = ::gtfs::Date(2025, 9, 16);
+    calendar_date.exception_type = ::gtfs::CalendarDateException::Added;
+    feed.add_calendar_date(calendar_date);
+
+    auto sequence = 0U;
+    for (const auto& [stop_id, minutes] : {std::pair{"A", 0}, std::pair{"B", 10}}) {
+        auto stop_time = ::gtfs::StopTime{};
+        stop_time.trip_id = "T";
+        stop_time.stop_id = stop_id;
+        stop_time.stop_sequence = sequence++;
+        stop_time.arrival_time = ::gtfs::Time(8, minutes, 0);
+        stop_time.departure_time = ::gtfs::Time(8, minutes, 0);
+        feed.add_stop_time(stop_time);
+    }
+    return feed;
+}
+
+const Route& find_route(const Schedule& schedule, std::string_view gtfs_id) {
+    auto route = std::ranges::find_if(schedule.get_routes(), [gtfs_id](const Route& r) {
+        return r.get_gtfs_id() == gtfs_id;
+    });
+    EXPECT_NE(route, schedule.get_routes().end());
+    return *route;
+}
+
+TEST(MergeFeeds, IdsAreNamespaced) {
+    const auto stockholm = create_feed("Europe/Stockholm");
+    const auto athens = create_feed("Europe/Athens");
+    const auto schedule = raptor::gtfs::from_gtfs(std::vector<raptor::gtfs::NamespacedFeed>{
+                                                      {std::cref(stockholm), "sl:"}, {std::cref(athens), "oasa:"}});
+
+    auto stop_ids = std::vector<std::string_view>{};
+    std::ranges::transform(schedule.get_stops(), std::back_inserter(stop_ids), [](const Stop& stop) {
+        return stop.get_gtfs_id().view();
+    });
+    std::ranges::sort(stop_ids);
+    EXPECT_EQ(stop_ids, (std::vector<std::string_view>{"oasa:A", "oasa:B", "sl:A", "sl:B"}));
+
+    ASSERT_EQ(schedule.get_routes().size(), 2);
+    const auto& route = find_route(schedule, "sl:R");
+    ASSERT_EQ(route.get_trips().size(), 1);
+    EXPECT_EQ(route.get_trips()[0].get_trip_gtfs_id(), std::string_view("sl:T"));
+    EXPECT_EQ(route.stop_sequence()[0].get().get_gtfs_id(), std::string_view("sl:A"));
+}
+
+TEST(MergeFeeds, ScheduleOwnsItsStrings) {
+    const auto stockholm = create_feed("Europe/Stockholm");
+    const auto athens = create_feed("Europe/Athens");
+    const auto schedule = raptor::gtfs::from_gtfs(std::vector<raptor::gtfs::NamespacedFeed>{
+                                                      {std::cref(stockholm), "sl:"}, {std::cref(athens), "oasa:"}});
+    const auto& string_pool = schedule.get_string_pool();
+    ASSERT_NE(string_pool, nullptr);
+    // Strings interned by the threads of both feeds end up in the pool of the schedule
+    for (const auto& route : schedule.get_routes()) {
+        const auto trip_id = route.get_trips()[0].get_trip_gtfs_id();
+        EXPECT_TRUE(string_pool->owns(trip_id));
+        EXPECT_FALSE(StringPool::shared().owns(trip_id));
+    }
+    EXPECT_EQ(&StringPool::current(), &StringPool::shared());
+}
+
+TEST(MergeFeeds, TripsUseTimeZoneOfTheirFeed) {
+    const auto stockholm = create_feed("Europe/Stockholm");
+    const auto athens = create_feed("Europe/Athens");
+    const auto schedule = raptor::gtfs::from_gtfs(std::vector<raptor::gtfs::NamespacedFeed>{
+                                                      {std::cref(stockholm), "sl:"}, {std::cref(athens), "oasa:"}});
+
+    for (const auto& [route_id, time_zone] : {std::pair{"sl:R", "Europe/Stockholm"},
+                                              std::pair{"oasa:R", "Europe/Athens"}}) {
+        const auto& route = find_route(schedule, route_id);
+        const auto expected = Time(std::chrono::locate_zone(time_zone), std::chrono::local_days(service_day) + 8h);
+        const auto& departure = route.get_trips()[0].get_stop_times()[0].get_departure_time();
+        EXPECT_EQ(departure.get_sys_time(), expected.get_sys_time()) << route_id;
+    }
+}
+
+TEST(MergeFeeds, RequiresAtLeastOneFeed) {
+    EXPECT_THROW(raptor::gtfs::from_gtfs(std::vector<raptor::gtfs::NamespacedFeed>{}), std::invalid_argument);
+}
+
+/**
+ * Creates a station S with the platforms P1 and P2 and an entrance E, and a stop C outside the station.
+ */
+StopManager create_station_stops() {
+    auto gtfs_stops = ::gtfs::Stops{};
+    auto add_stop = [&gtfs_stops](const std::string& stop_id, const ::gtfs::StopLocationType location_type,
+                                  const std::string& parent_station) {
+        auto stop = ::gtfs::Stop{};
+        stop.stop_id = stop_id;
+        stop.stop_name = stop_id;
+        stop.location_type = location_type;
+        stop.parent_station = parent_station;
+        gtfs_stops.push_back(stop);
+    };
+    add_stop("S", ::gtfs::StopLocationType::Station, "");
+    add_stop("P1", ::gtfs::StopLocationType::StopOrPlatform, "S");
+    add_stop("P2", ::gtfs::StopLocationType::StopOrPlatform, "S");
+    add_stop("E", ::gtfs::StopLocationType::EntranceExit, "S");
+    add_stop("C", ::gtfs::StopLocationType::StopOrPlatform, "");
+    return raptor::gtfs::from_gtfs(std::move(gtfs_stops));
+}
+
+::gtfs::Transfer create_transfer(const std::string& from, const std::string& to, const int type,
+                                 const std::size_t min_transfer_time = 0) {
+    auto transfer = ::gtfs::Transfer{};
+    transfer.from_stop_id = from;
+    transfer.to_stop_id = to;
+    transfer.transfer_type = static_cast<::gtfs::TransferType>(type);
+    transfer.min_transfer_time = min_transfer_time;
+    return transfer;
+}
+
+::gtfs::Pathway create_pathway(const std::string& from, const std::string& to, const bool bidirectional,
+                               const std::size_t traversal_time, const double length = 0) {
+    auto pathway = ::gtfs::Pathway{};
+    pathway.pathway_id = from + to;
+    pathway.from_stop_id = from;
+    pathway.to_stop_id = to;
+    pathway.is_bidirectional = static_cast<::gtfs::PathwayDirection>(bidirectional ? 1 : 0);
+    pathway.traversal_time = traversal_time;
+    pathway.length = length;
+    return pathway;
+}
+
+/**
+ * Finds the transfer between the stops with the given GTFS IDs.
+ */
+std::optional<StopTransfer> find_transfer(const std::vector<StopTransfer>& transfers, const std::string_view from,
+                                          const std::string_view to) {
+    auto transfer = std::ranges::find_if(transfers, [from, to](const StopTransfer& candidate) {
+        return candidate.from.get().get_gtfs_id().view() == from && candidate.to.get().get_gtfs_id().view() == to;
+    });
+    return transfer != transfers.end() ? std::optional{*transfer} : std::nullopt;
+}
+
+TEST(GtfsTransfers, StationTransfersApplyToChildStops) {
+    const auto stop_manager = create_station_stops();
+    const auto stop_index = raptor::gtfs::create_index(stop_manager.get_stops(), [](const Stop& stop) {
+        return stop.get_gtfs_id().view();
+    });
+    const auto station_index = raptor::gtfs::create_index(stop_manager.get_stations(), [](const Station& station) {
+        return station.get_gtfs_id().view();
+    });
+    // The transfer between the stops is more specific, so it takes precedence even if it is defined later
+    const auto gtfs_transfers = ::gtfs::Transfers{create_transfer("S", "C", 2, 90), create_transfer("P1", "C", 3),
+                                                  create_transfer("E", "C", 0)};
+
+    const auto transfers = raptor::gtfs::from_gtfs(gtfs_transfers, {}, stop_index, station_index);
+    ASSERT_EQ(transfers.size(), 2);
+    const auto from_p1 = find_transfer(transfers, "P1", "C");
+    ASSERT_TRUE(from_p1.has_value());
+    EXPECT_EQ(from_p1->type, StopTransfer::Type::NotPossible);
+    const auto from_p2 = find_transfer(transfers, "P2", "C");
+    ASSERT_TRUE(from_p2.has_value());
+    EXPECT_EQ(from_p2->type, StopTransfer::Type::MinimumTime);
+    EXPECT_EQ(from_p2->min_transfer_time, 90s);
+}
+
+TEST(GtfsTransfers, PathwaysUseFastestConnection) {
+    const auto stop_manager = create_station_stops();
+    const auto stop_index = raptor::gtfs::create_index(stop_manager.get_stops(), [](const Stop& stop) {
+        return stop.get_gtfs_id().view();
+    });
+    const auto station_index = raptor::gtfs::create_index(stop_manager.get_stations(), [](const Station& station) {
+        return station.get_gtfs_id().view();
+    });
+    // The pathway from E to P2 only has a length, so its traversal time is estimated
+    const auto pathways = ::gtfs::Pathways{create_pathway("P1", "E", true, 30), create_pathway("E", "P2", false, 0, 13),
+                                           create_pathway("P1", "P2", false, 120), create_pathway("P2", "C", true, 0)};
+
+    const auto transfers = raptor::gtfs::from_gtfs({}, pathways, stop_index, station_index);
+    ASSERT_EQ(transfers.size(), 1);
+    const auto from_p1 = find_transfer(transfers, "P1", "P2");
+    ASSERT_TRUE(from_p1.has_value());
+    EXPECT_EQ(from_p1->type, StopTransfer::Type::MinimumTime);
+    EXPECT_EQ(from_p1->min_transfer_time, 40s);
+}
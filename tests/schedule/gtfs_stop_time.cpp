@@ -0,0 +1,61 @@
+#include <gtest/gtest.h>
+
+#include <schedule/gtfs.h>
+
+using namespace raptor;
+
+/**
+ * Checks that the converter gives the same results as a time zone database lookup for every 5 minutes of the given
+ * service day, including times past midnight.
+ */
+void expect_same_as_time_zone_lookup(const std::chrono::year_month_day& service_day,
+                                     const std::chrono::time_zone* time_zone) {
+    using namespace std::chrono_literals;
+    const auto converter = raptor::gtfs::ServiceDayTimeConverter(service_day, time_zone);
+    for (auto since_start = 0s; since_start < 30h; since_start += 5min) {
+        const auto expected = Time(time_zone, std::chrono::local_days(service_day) + since_start,
+                                   std::chrono::choose::earliest);
+        const auto converted = converter.to_time(since_start);
+        EXPECT_EQ(converted.get_sys_time(), expected.get_sys_time()) << "Time since start: " << since_start.count();
+        EXPECT_EQ(converted.get_time_zone(), time_zone);
+    }
+}
+
+TEST(ServiceDayTimeConverter, SameAsLookupWithoutTransition) {
+    using namespace std::chrono_literals;
+    expect_same_as_time_zone_lookup(16d / std::chrono::September / 2025, std::chrono::locate_zone("Europe/Stockholm"));
+}
+
+TEST(ServiceDayTimeConverter, SameAsLookupOnSpringTransition) {
+    // Clocks move from 02:00 to 03:00, so some local times do not exist
+    using namespace std::chrono_literals;
+    expect_same_as_time_zone_lookup(30d / std::chrono::March / 2025, std::chrono::locate_zone("Europe/Stockholm"));
+}
+
+TEST(ServiceDayTimeConverter, SameAsLookupOnAutumnTransition) {
+    // Clocks move from 03:00 to 02:00, so some local times are ambiguous
+    using namespace std::chrono_literals;
+    expect_same_as_time_zone_lookup(26d / std::chrono::October / 2025, std::chrono::locate_zone("Europe/Stockholm"));
+}
+
+TEST(ServiceDayTimeConverter, SameAsLookupBeforeTransition) {
+    // Times after midnight of a service day can fall on the day of the transition
+    using namespace std::chrono_literals;
+    expect_same_as_time_zone_lookup(25d / std::chrono::October / 2025, std::chrono::locate_zone("Europe/Stockholm"));
+}
+
+TEST(ServiceDayTimeConverter, StopTimeUsesConverter) {
+    using namespace std::chrono_literals;
+    const auto service_day = 16d / std::chrono::September / 2025;
+    const auto time_zone = std::chrono::locate_zone("Europe/Stockholm");
+    const auto stop = Stop{"stop", "stop", 1.0, 2.0, "", {}};
+    auto gtfs_stop_time = ::gtfs::StopTime{};
+    gtfs_stop_time.arrival_time = ::gtfs::Time(25, 10, 0);
+    gtfs_stop_time.departure_time = ::gtfs::Time(25, 12, 0);
+
+    const auto converter = raptor::gtfs::ServiceDayTimeConverter(service_day, time_zone);
+    const auto cached = raptor::gtfs::from_gtfs(gtfs_stop_time, converter, stop);
+    const auto looked_up = raptor::gtfs::from_gtfs(gtfs_stop_time, service_day, time_zone, stop);
+    EXPECT_EQ(cached.get_arrival_time().get_sys_time(), looked_up.get_arrival_time().get_sys_time());
+    EXPECT_EQ(cached.get_departure_time().get_sys_time(), looked_up.get_departure_time().get_sys_time());
+}
@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+
+#include <set>
+#include <sstream>
+
+#include <schedule/gtfs.h>
+#include <schedule/synthetic.h>
+
+using namespace raptor;
+using namespace std::chrono_literals;
+
+class ImportStatsTest : public testing::Test {
+protected:
+    synthetic::NetworkParameters parameters{.n_routes = 4, .stops_per_route = 6, .service_days = 2};
+    ::gtfs::Feed feed = synthetic::generate_feed(parameters);
+    std::chrono::year_month_day from_date = parameters.start_date;
+    std::chrono::year_month_day to_date{std::chrono::sys_days{parameters.start_date} + std::chrono::days{1}};
+
+    static std::vector<std::string> phase_names(const ImportStats& stats) {
+        auto names = std::vector<std::string>{};
+        for (const auto& phase : stats.phases) {
+            names.push_back(phase.name);
+        }
+        return names;
+    }
+};
+
+TEST_F(ImportStatsTest, RecordsPhases) {
+    auto stats = ImportStats{};
+    const auto schedule = raptor::gtfs::from_gtfs(feed, from_date, to_date, &stats);
+    EXPECT_EQ(phase_names(stats), (std::vector<std::string>{
+                  "agencies", "stops and stations", "calendars", "stop time grouping", "trip instantiation",
+                  "transfers", "route grouping", "route construction", "schedule"}));
+    for (const auto& phase : stats.phases) {
+        EXPECT_GE(phase.wall_time, 0ns) << phase.name;
+    }
+    EXPECT_GT(stats.total_wall_time(), 0ns);
+#ifdef __linux__
+    EXPECT_GT(stats.peak_resident_bytes, 0);
+#endif
+}
+
+TEST_F(ImportStatsTest, CountsObjects) {
+    auto stats = ImportStats{};
+    const auto schedule = raptor::gtfs::from_gtfs(feed, from_date, to_date, &stats);
+    EXPECT_EQ(stats.agencies, 1);
+    EXPECT_EQ(stats.stops, schedule.get_stops().size());
+    EXPECT_EQ(stats.services, 1);
+    EXPECT_EQ(stats.routes, schedule.get_routes().size());
+    EXPECT_GT(stats.stop_patterns, 0);
+    EXPECT_LE(stats.stop_patterns, stats.routes);
+    EXPECT_EQ(stats.transfers, schedule.get_transfers().size());
+    auto n_trips = std::size_t{0};
+    auto n_stop_times = std::size_t{0};
+    for (const auto& route : schedule.get_routes()) {
+        for (const auto& trip : route.get_trips()) {
+            ++n_trips;
+            n_stop_times += trip.get_stop_times().size();
+        }
+    }
+    EXPECT_EQ(stats.trips, n_trips);
+    EXPECT_EQ(stats.stop_times, n_stop_times);
+    // Two service days are imported, so every GTFS trip is instantiated twice
+    EXPECT_EQ(stats.trips, 2 * feed.get_trips().size());
+}
+
+TEST_F(ImportStatsTest, StatsDoNotChangeSchedule) {
+    auto stats = ImportStats{};
+    const auto with_stats = raptor::gtfs::from_gtfs(feed, from_date, to_date, &stats);
+    const auto without_stats = raptor::gtfs::from_gtfs(feed, from_date, to_date);
+    EXPECT_EQ(with_stats.fingerprint(), without_stats.fingerprint());
+}
+
+TEST_F(ImportStatsTest, SumsPhasesOfAllFeeds) {
+    auto other_parameters = parameters;
+    other_parameters.seed = 2;
+    const auto other_feed = synthetic::generate_feed(other_parameters);
+    auto stats = ImportStats{};
+    const auto feeds = std::vector<raptor::gtfs::NamespacedFeed>{{feed, "a:"}, {other_feed, "b:"}};
+    const auto schedule = raptor::gtfs::from_gtfs(feeds, from_date, to_date, &stats);
+    const auto names = phase_names(stats);
+    EXPECT_EQ(std::set(names.begin(), names.end()).size(), names.size());
+    EXPECT_EQ(stats.agencies, 2);
+    EXPECT_EQ(stats.services, 2);
+    EXPECT_EQ(stats.trips, 2 * (feed.get_trips().size() + other_feed.get_trips().size()));
+}
+
+TEST_F(ImportStatsTest, PrintsReport) {
+    auto stats = ImportStats{};
+    raptor::gtfs::from_gtfs(feed, from_date, to_date, &stats);
+    auto output = std::ostringstream{};
+    output << stats;
+    const auto report = output.str();
+    for (const auto& phase : stats.phases) {
+        EXPECT_NE(report.find(phase.name), std::string::npos) << phase.name;
+    }
+    EXPECT_NE(report.find("trips " + std::to_string(stats.trips)), std::string::npos);
+    EXPECT_NE(report.find("peak resident memory"), std::string::npos);
+}
@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+
+#include <schedule/components/interned_string.h>
+
+using namespace raptor;
+
+TEST(InternedString, EqualStringsShareHandle) {
+    const auto string1 = InternedString("stop1");
+    const auto string2 = InternedString(std::string("stop1"));
+    EXPECT_EQ(string1, string2);
+    EXPECT_EQ(string1.id(), string2.id());
+    EXPECT_EQ(std::hash<InternedString>{}(string1), std::hash<InternedString>{}(string2));
+}
+
+TEST(InternedString, DifferentStringsHaveDifferentHandles) {
+    const auto string1 = InternedString("stop1");
+    const auto string2 = InternedString("stop2");
+    EXPECT_NE(string1, string2);
+    EXPECT_NE(string1.id(), string2.id());
+}
+
+TEST(InternedString, ViewReturnsContents) {
+    const auto original = std::string("Stockholm Central");
+    const auto string = InternedString(original);
+    EXPECT_EQ(string.view(), original);
+    EXPECT_TRUE(string == "Stockholm Central");
+    // The contents are copied to the pool
+    EXPECT_NE(string.view().data(), original.data());
+}
+
+TEST(InternedString, DefaultIsEmptyString) {
+    const auto string = InternedString();
+    EXPECT_TRUE(string.empty());
+    EXPECT_EQ(string, InternedString(""));
+    EXPECT_TRUE(string.view().empty());
+}
+
+TEST(InternedString, OrderingUsesContents) {
+    // Intern in reverse order, so that the order of the handles is different from the order of the contents
+    const auto string_b = InternedString("ordering b");
+    const auto string_a = InternedString("ordering a");
+    EXPECT_LT(string_a, string_b);
+    EXPECT_GT(string_b, string_a);
+}
+
+TEST(StringPool, StoresEachStringOnce) {
+    auto& pool = StringPool::shared();
+    pool.intern("stored once");
+    const auto size = pool.size();
+    pool.intern("stored once");
+    pool.intern(std::string("stored once"));
+    EXPECT_EQ(pool.size(), size);
+}
+
+TEST(StringPool, LongStringsAreStored) {
+    const auto long_string = std::string(200 * 1024, 'a');
+    const auto string = InternedString(long_string);
+    EXPECT_EQ(string.view(), long_string);
+}
+
+TEST(StringPool, ScopeInstallsPool) {
+    auto pool = StringPool{};
+    {
+        const auto scope = StringPool::Scope{pool};
+        EXPECT_EQ(&StringPool::current(), &pool);
+        const auto string = InternedString("scoped string");
+        EXPECT_EQ(pool.size(), 1);
+    }
+    EXPECT_EQ(&StringPool::current(), &StringPool::shared());
+}
+
+TEST(InternedString, HandlesOfDifferentPoolsCompareContents) {
+    auto pool = StringPool{};
+    const auto shared = InternedString("in two pools");
+    const auto other = pool.intern("in two pools");
+    EXPECT_NE(shared.id(), other.id());
+    EXPECT_EQ(shared, other);
+    EXPECT_EQ(std::hash<InternedString>{}(shared), std::hash<InternedString>{}(other));
+    EXPECT_NE(shared, pool.intern("in one pool"));
+}
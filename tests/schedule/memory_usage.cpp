@@ -0,0 +1,53 @@
+#include <sstream>
+
+#include <gtest/gtest.h>
+
+#include <schedule/memory_usage.h>
+
+using namespace raptor;
+
+TEST(MemoryUsage, TotalIncludesParts) {
+    auto usage = MemoryUsage{"root", 10};
+    auto& child = usage.add("child", 20);
+    child.add("grandchild", 30);
+    usage.add("other", 5);
+    EXPECT_EQ(usage.total_bytes(), 65);
+}
+
+TEST(MemoryUsage, SumMergesPartsWithSameName) {
+    auto first = MemoryUsage{"routes"};
+    first.add("trips", 10);
+    first.add("stop times", 20);
+    auto second = MemoryUsage{"routes"};
+    second.add("stop times", 5);
+    second.add("extra", 1);
+
+    first += second;
+    ASSERT_EQ(first.parts.size(), 3);
+    EXPECT_EQ(first.parts[0].bytes, 10);
+    EXPECT_EQ(first.parts[1].bytes, 25);
+    EXPECT_EQ(first.parts[2].name, "extra");
+    EXPECT_EQ(first.total_bytes(), 36);
+}
+
+TEST(MemoryUsage, VectorUsesCapacity) {
+    auto vector = std::vector<int>{};
+    vector.reserve(100);
+    vector.push_back(1);
+    EXPECT_EQ(memory::heap_bytes(vector), 100 * sizeof(int));
+}
+
+TEST(MemoryUsage, ShortStringUsesNoHeap) {
+    const auto short_string = std::string("a");
+    EXPECT_EQ(memory::heap_bytes(short_string), 0);
+    const auto long_string = std::string(100, 'a');
+    EXPECT_GE(memory::heap_bytes(long_string), 101);
+}
+
+TEST(MemoryUsage, PrintingKeepsStreamFormat) {
+    auto usage = MemoryUsage{"root", 1024 * 1024};
+    usage.add("child", 512 * 1024);
+    auto output = std::ostringstream{};
+    output << usage << 1.5;
+    EXPECT_EQ(output.str(), "root: 1572864 bytes (1.50 MiB)\n  child: 524288 bytes (0.50 MiB)\n1.5");
+}
@@ -8,19 +8,24 @@ TEST(Route, HashUsesTrips) {
     using namespace std::literals::chrono_literals;
     auto time1 = Time{"Europe/Stockholm",
                      std::chrono::local_days{16d / std::chrono::September / 2025} + 9h + 24min};
-    auto stop1 = Stop{"stop", "stop", 1.0, 2.0, "", {}};
+    // Stops are hashed by their index, so they must be owned by a StopManager to be told apart
+    const auto manager = StopManager({Stop{"stop", "stop", 1.0, 2.0, "", {}}, Stop{"stop", "stop2", 1.0, 2.0, "", {}}},
+                                     {}, {});
+    const auto& stop1 = manager.get_stops()[0];
     auto stop_time1 = StopTime{time1, time1, stop1};
     const auto trip1 = Trip{{stop_time1}, "trip1", "shape1"};
 
     const auto time2 = Time{"Europe/Stockholm",
                  std::chrono::local_days{17d / std::chrono::September / 2025} + 9h + 24min};
-    auto stop2 = Stop{"stop", "stop2", 1.0, 2.0, "", {}};
+    const auto& stop2 = manager.get_stops()[1];
     auto stop_time2 = StopTime{time2, time2, stop2};
     const auto trip2 = Trip{{stop_time2}, "trip1", "shape1"};
+    const auto stops1 = std::vector{std::cref(stop1)};
+    const auto stops2 = std::vector{std::cref(stop2)};
     const auto agency = Agency{"agency1", "agency", "", time1.get_time_zone()};
 
-    const auto route1 = Route{{trip1}, "route1", "route1", "route1", agency};
-    const auto route2 = Route{{trip2}, "route1", "route1", "route1", agency};
+    const auto route1 = Route{{trip1}, stops1, "route1", "route1", "route1", agency};
+    const auto route2 = Route{{trip2}, stops2, "route1", "route1", "route1", agency};
     ASSERT_NE(route1.hash(), route2.hash());
 }
 
@@ -37,10 +42,12 @@ TEST(Route, HashUsesGtfsId) {
     auto stop2 = Stop{"stop", "stop2", 1.0, 2.0, "", {}};
     auto stop_time2 = StopTime{time2, time2, stop2};
     const auto trip2 = Trip{{stop_time2}, "trip1", "shape1"};
+    const auto stops1 = std::vector{std::cref(stop1)};
+    const auto stops2 = std::vector{std::cref(stop2)};
     const auto agency = Agency{"agency1", "agency", "", time1.get_time_zone()};
 
-    const auto route1 = Route{{trip1}, "route1", "route1", "route1", agency};
-    const auto route2 = Route{{trip1}, "route1", "route1", "route2", agency};
+    const auto route1 = Route{{trip1}, stops1, "route1", "route1", "route1", agency};
+    const auto route2 = Route{{trip1}, stops1, "route1", "route1", "route2", agency};
     ASSERT_NE(route1.hash(), route2.hash());
 }
 
@@ -57,12 +64,14 @@ TEST(Route, HashUsesOnlyGtfsIdAndTrips) {
     auto stop2 = Stop{"stop", "stop2", 1.0, 2.0, "", {}};
     auto stop_time2 = StopTime{time2, time2, stop2};
     const auto trip2 = Trip{{stop_time2}, "trip1", "shape1"};
+    const auto stops1 = std::vector{std::cref(stop1)};
+    const auto stops2 = std::vector{std::cref(stop2)};
 
     const auto agency1 = Agency{"agency1", "agency", "", time1.get_time_zone()};
     const auto agency2 = Agency{"agency2", "agency2", "", time1.get_time_zone()};
 
-    const auto route1 = Route{{trip1}, "route1", "route1", "route1", agency1};
-    const auto route2 = Route{{trip1}, "route2", "route2", "route1", agency2};
+    const auto route1 = Route{{trip1}, stops1, "route1", "route1", "route1", agency1};
+    const auto route2 = Route{{trip1}, stops1, "route2", "route2", "route1", agency2};
     ASSERT_EQ(route1.hash(), route2.hash());
 }
 
@@ -79,10 +88,12 @@ TEST(Route, EqualsUsesTrips) {
     auto stop2 = Stop{"stop", "stop2", 1.0, 2.0, "", {}};
     auto stop_time2 = StopTime{time2, time2, stop2};
     const auto trip2 = Trip{{stop_time2}, "trip1", "shape1"};
+    const auto stops1 = std::vector{std::cref(stop1)};
+    const auto stops2 = std::vector{std::cref(stop2)};
     const auto agency = Agency{"agency1", "agency", "", time1.get_time_zone()};
 
-    const auto route1 = Route{{trip1}, "route1", "route1", "route1", agency};
-    const auto route2 = Route{{trip2}, "route1", "route1", "route1", agency};
+    const auto route1 = Route{{trip1}, stops1, "route1", "route1", "route1", agency};
+    const auto route2 = Route{{trip2}, stops2, "route1", "route1", "route1", agency};
     ASSERT_NE(route1, route2);
 }
 
@@ -99,10 +110,12 @@ TEST(Route, EqualsUsesGtfsId) {
     auto stop2 = Stop{"stop", "stop2", 1.0, 2.0, "", {}};
     auto stop_time2 = StopTime{time2, time2, stop2};
     const auto trip2 = Trip{{stop_time2}, "trip1", "shape1"};
+    const auto stops1 = std::vector{std::cref(stop1)};
+    const auto stops2 = std::vector{std::cref(stop2)};
     const auto agency = Agency{"agency1", "agency", "", time1.get_time_zone()};
 
-    const auto route1 = Route{{trip1}, "route1", "route1", "route1", agency};
-    const auto route2 = Route{{trip1}, "route1", "route1", "route2", agency};
+    const auto route1 = Route{{trip1}, stops1, "route1", "route1", "route1", agency};
+    const auto route2 = Route{{trip1}, stops1, "route1", "route1", "route2", agency};
     ASSERT_NE(route1, route2);
 }
 
@@ -119,11 +132,111 @@ TEST(Route, EqualsUsesOnlyGtfsIdAndTrips) {
     auto stop2 = Stop{"stop", "stop2", 1.0, 2.0, "", {}};
     auto stop_time2 = StopTime{time2, time2, stop2};
     const auto trip2 = Trip{{stop_time2}, "trip1", "shape1"};
+    const auto stops1 = std::vector{std::cref(stop1)};
+    const auto stops2 = std::vector{std::cref(stop2)};
 
     const auto agency1 = Agency{"agency1", "agency", "", time1.get_time_zone()};
     const auto agency2 = Agency{"agency2", "agency2", "", time1.get_time_zone()};
 
-    const auto route1 = Route{{trip1}, "route1", "route1", "route1", agency1};
-    const auto route2 = Route{{trip1}, "route2", "route2", "route1", agency2};
+    const auto route1 = Route{{trip1}, stops1, "route1", "route1", "route1", agency1};
+    const auto route2 = Route{{trip1}, stops1, "route2", "route2", "route1", agency2};
     ASSERT_EQ(route1, route2);
-}
\ No newline at end of file
+}
+
+TEST(Route, StopSequenceMustMatchTrips) {
+    using namespace std::literals::chrono_literals;
+    auto time1 = Time{"Europe/Stockholm",
+                     std::chrono::local_days{16d / std::chrono::September / 2025} + 9h + 24min};
+    auto stop1 = Stop{"stop", "stop", 1.0, 2.0, "", {}};
+    auto stop2 = Stop{"stop", "stop2", 1.0, 2.0, "", {}};
+    auto stop_time1 = StopTime{time1, time1, stop1};
+    const auto trip1 = Trip{{stop_time1}, "trip1", "shape1"};
+    const auto agency = Agency{"agency1", "agency", "", time1.get_time_zone()};
+
+    const auto stops = std::vector{std::cref(stop1), std::cref(stop2)};
+    EXPECT_THROW((Route{{trip1}, stops, "route1", "route1", "route1", agency}), std::invalid_argument);
+}
+
+TEST(StopPatternStore, IdenticalSequencesStoredOnce) {
+    auto stop1 = Stop{"stop", "stop", 1.0, 2.0, "", {}};
+    auto stop2 = Stop{"stop", "stop2", 1.0, 2.0, "", {}};
+    auto store = StopPatternStore{};
+    const auto pattern1 = store.add(std::vector{std::cref(stop1), std::cref(stop2)});
+    const auto pattern2 = store.add(std::vector{std::cref(stop2), std::cref(stop1)});
+    const auto pattern3 = store.add(std::vector{std::cref(stop1), std::cref(stop2)});
+    EXPECT_EQ(pattern1, pattern3);
+    EXPECT_NE(pattern1, pattern2);
+    EXPECT_EQ(store.size(), 2);
+}
+
+TEST(StopPatternStore, ViewsRemainValidAfterMove) {
+    auto stop1 = Stop{"stop", "stop", 1.0, 2.0, "", {}};
+    auto stop2 = Stop{"stop", "stop2", 1.0, 2.0, "", {}};
+    auto store = StopPatternStore{};
+    const auto pattern = store.add(std::vector{std::cref(stop1), std::cref(stop2)});
+    const auto sequence = store.get(pattern);
+    const auto moved_store = std::move(store);
+    EXPECT_EQ(moved_store.get(pattern).data(), sequence.data());
+    ASSERT_EQ(sequence.size(), 2);
+    EXPECT_EQ(sequence[1].get(), stop2);
+}
+
+/**
+ * Creates a trip visiting the two given stops, departing at the given times.
+ */
+Trip two_stop_trip(const Stop& stop1, const Stop& stop2, const std::chrono::minutes departure1,
+                   const std::chrono::minutes departure2) {
+    using namespace std::literals::chrono_literals;
+    const auto day = std::chrono::local_days{16d / std::chrono::September / 2025};
+    auto time1 = Time{"Europe/Stockholm", day + departure1};
+    auto time2 = Time{"Europe/Stockholm", day + departure2};
+    return Trip{{StopTime{time1, time1, stop1}, StopTime{time2, time2, stop2}}, "trip", "shape"};
+}
+
+TEST(Route, DetectsOvertakingTrips) {
+    using namespace std::literals::chrono_literals;
+    auto stop1 = Stop{"stop", "stop", 1.0, 2.0, "", {}};
+    auto stop2 = Stop{"stop", "stop2", 1.0, 2.0, "", {}};
+    const auto stops = std::vector{std::cref(stop1), std::cref(stop2)};
+    const auto agency = Agency{"agency1", "agency", "", std::chrono::locate_zone("Europe/Stockholm")};
+    // Local service departing first, express departing later and arriving earlier
+    const auto local = two_stop_trip(stop1, stop2, 600min, 660min);
+    const auto express = two_stop_trip(stop1, stop2, 610min, 640min);
+    const auto next_local = two_stop_trip(stop1, stop2, 620min, 680min);
+
+    const auto fifo_route = Route{{local, next_local}, stops, "route1", "route1", "route1", agency};
+    EXPECT_TRUE(fifo_route.is_fifo());
+    const auto overtaking_route = Route{{local, express}, stops, "route1", "route1", "route1", agency};
+    EXPECT_FALSE(overtaking_route.is_fifo());
+}
+
+TEST(Route, SplitIntoFifoGroups) {
+    using namespace std::literals::chrono_literals;
+    auto stop1 = Stop{"stop", "stop", 1.0, 2.0, "", {}};
+    auto stop2 = Stop{"stop", "stop2", 1.0, 2.0, "", {}};
+    const auto stops = std::vector{std::cref(stop1), std::cref(stop2)};
+    const auto agency = Agency{"agency1", "agency", "", std::chrono::locate_zone("Europe/Stockholm")};
+    const auto local = two_stop_trip(stop1, stop2, 600min, 660min);
+    const auto express = two_stop_trip(stop1, stop2, 610min, 640min);
+    const auto next_local = two_stop_trip(stop1, stop2, 620min, 680min);
+
+    auto groups = split_into_fifo_groups({local, express, next_local});
+    ASSERT_EQ(groups.size(), 2);
+    EXPECT_EQ(groups[0].size(), 2);
+    EXPECT_EQ(groups[1].size(), 1);
+    for (auto& group : groups) {
+        EXPECT_TRUE((Route{std::move(group), stops, "route1", "route1", "route1", agency}.is_fifo()));
+    }
+}
+
+TEST(Route, SplitKeepsFifoTripsTogether) {
+    using namespace std::literals::chrono_literals;
+    auto stop1 = Stop{"stop", "stop", 1.0, 2.0, "", {}};
+    auto stop2 = Stop{"stop", "stop2", 1.0, 2.0, "", {}};
+    const auto local = two_stop_trip(stop1, stop2, 600min, 660min);
+    const auto next_local = two_stop_trip(stop1, stop2, 620min, 680min);
+
+    const auto groups = split_into_fifo_groups({local, next_local});
+    ASSERT_EQ(groups.size(), 1);
+    EXPECT_EQ(groups[0].size(), 2);
+}
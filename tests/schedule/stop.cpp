@@ -101,6 +101,26 @@ TEST(StopManager, InitialiseInvalidStationID) {
     EXPECT_THROW(StopManager({stop1}, {station1}, stops_per_station), std::out_of_range);
 }
 
+TEST(StopManager, IndicesMatchPositions) {
+    auto manager = StopManager({Stop("a", "a", 59.3, 18.0, "", {}), Stop("b", "b", 59.4, 18.1, "", {}),
+                                Stop("c", "c", 59.5, 18.2, "", {})}, {}, {});
+    for (std::size_t position = 0; const auto& stop : manager.get_stops()) {
+        EXPECT_EQ(stop.get_index(), position++);
+    }
+}
+
+TEST(StopManager, NearbyStopsAreAdjacent) {
+    // Stops of two distant clusters are given interleaved
+    auto manager = StopManager({Stop("north1", "north1", 60.0, 18.0, "", {}),
+                                Stop("south1", "south1", 55.0, 13.0, "", {}),
+                                Stop("north2", "north2", 60.001, 18.001, "", {}),
+                                Stop("south2", "south2", 55.001, 13.001, "", {})}, {}, {});
+    const auto& stops = manager.get_stops();
+    ASSERT_EQ(stops.size(), 4);
+    EXPECT_EQ(stops[0].get_name().view().substr(0, 5), stops[1].get_name().view().substr(0, 5));
+    EXPECT_EQ(stops[2].get_name().view().substr(0, 5), stops[3].get_name().view().substr(0, 5));
+}
+
 TEST(Station, HashUsesOnlyGtfsId) {
     using namespace std::string_literals;
     const auto station1 = Station{"station"s, "station1"s, {}, {}};
@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+
+#include <unordered_set>
+
+#include <schedule/synthetic.h>
+
+using namespace raptor;
+using namespace std::chrono_literals;
+
+/**
+ * Four routes on a 5x5 grid: two along rows 0 and 2, and two along columns 0 and 2, crossing at four locations.
+ * Trips run every hour from 06:00 to 08:00.
+ */
+synthetic::NetworkParameters small_grid() {
+    return {.n_routes = 4, .stops_per_route = 5, .headway = 60min, .first_departure = 6h, .last_departure = 8h,
+            .service_days = 2};
+}
+
+TEST(SyntheticNetwork, GridRoutesCross) {
+    const auto feed = synthetic::generate_feed(small_grid());
+    EXPECT_EQ(feed.get_stops().size(), 4 * 5 - 4);
+    EXPECT_EQ(feed.get_routes().size(), 4);
+    // Each route has two or three trips in each direction, depending on the time of its first trip
+    EXPECT_GE(feed.get_trips().size(), 4 * 2 * 2);
+    EXPECT_LE(feed.get_trips().size(), 4 * 2 * 3);
+    EXPECT_EQ(feed.get_stop_times().size(), feed.get_trips().size() * 5);
+}
+
+TEST(SyntheticNetwork, RadialRoutesShareHub) {
+    auto parameters = small_grid();
+    parameters.topology = synthetic::Topology::Radial;
+    const auto feed = synthetic::generate_feed(parameters);
+    EXPECT_EQ(feed.get_stops().size(), 4 * 4 + 1);
+}
+
+TEST(SyntheticNetwork, StationsHaveOneStopPerPlatform) {
+    auto parameters = small_grid();
+    parameters.stops_per_station = 3;
+    const auto feed = synthetic::generate_feed(parameters);
+    const auto n_stations = std::ranges::count(feed.get_stops(), ::gtfs::StopLocationType::Station,
+                                               &::gtfs::Stop::location_type);
+    EXPECT_EQ(n_stations, 4 * 5 - 4);
+    EXPECT_EQ(feed.get_stops().size(), n_stations * 4);
+}
+
+TEST(SyntheticNetwork, SameSeedGivesSameNetwork) {
+    auto parameters = small_grid();
+    parameters.grid_size = 20;
+    const auto departures = [](const ::gtfs::Feed& feed) {
+        auto result = std::vector<std::size_t>{};
+        for (const auto& stop_time : feed.get_stop_times()) {
+            result.push_back(stop_time.departure_time.get_total_seconds());
+        }
+        return result;
+    };
+    const auto stop_ids = [](const ::gtfs::Feed& feed) {
+        auto result = std::vector<std::string>{};
+        for (const auto& stop_time : feed.get_stop_times()) {
+            result.push_back(stop_time.stop_id);
+        }
+        return result;
+    };
+    const auto feed = synthetic::generate_feed(parameters);
+    EXPECT_EQ(departures(feed), departures(synthetic::generate_feed(parameters)));
+    EXPECT_EQ(stop_ids(feed), stop_ids(synthetic::generate_feed(parameters)));
+}
+
+TEST(SyntheticNetwork, ScheduleContainsAllServiceDays) {
+    const auto parameters = small_grid();
+    const auto feed = synthetic::generate_feed(parameters);
+    const auto schedule = synthetic::generate_schedule(parameters);
+    // Each direction of a route has a different stop sequence, so it becomes a separate route
+    EXPECT_EQ(schedule.get_routes().size(), 4 * 2);
+    auto n_trips = std::size_t{0};
+    for (const auto& route : schedule.get_routes()) {
+        n_trips += route.get_trips().size();
+    }
+    EXPECT_EQ(n_trips, feed.get_trips().size() * parameters.service_days);
+}
+
+TEST(SyntheticNetwork, ScheduleAssignsDenseIndices) {
+    const auto schedule = synthetic::generate_schedule(small_grid());
+    auto trips = std::vector<std::reference_wrapper<const Trip>>{};
+    for (std::size_t position = 0; const auto& route : schedule.get_routes()) {
+        EXPECT_EQ(route.get_index(), position++);
+        for (const auto& trip : route.get_trips()) {
+            EXPECT_EQ(trip.get_index(), trips.size());
+            trips.emplace_back(trip);
+        }
+    }
+    // Instances of the same GTFS trip on different days are told apart by their index
+    const auto unique_trips = std::unordered_set(trips.begin(), trips.end());
+    EXPECT_EQ(unique_trips.size(), trips.size());
+    EXPECT_EQ(schedule.get_routes().front(), schedule.get_routes().front());
+    EXPECT_NE(schedule.get_routes().front(), schedule.get_routes().back());
+}
+
+TEST(SyntheticNetwork, ThrowsOnInvalidParameters) {
+    auto parameters = small_grid();
+    parameters.stops_per_route = 1;
+    EXPECT_THROW(synthetic::generate_feed(parameters), std::invalid_argument);
+    parameters = small_grid();
+    parameters.grid_size = 3;
+    EXPECT_THROW(synthetic::generate_feed(parameters), std::invalid_argument);
+    parameters = small_grid();
+    parameters.stop_spacing_km = 5000;
+    EXPECT_THROW(synthetic::generate_feed(parameters), std::invalid_argument);
+}
@@ -0,0 +1,131 @@
+#include <filesystem>
+#include <fstream>
+
+#include <gtest/gtest.h>
+
+#include <transfers/footpath_cache.h>
+#include <transfers/kd_tree.h>
+
+using namespace raptor;
+
+/**
+ * Returns a walking time of one minute for each 0.001 degrees of longitude and counts the calculated pairs.
+ */
+class CountingCalculator final : public WalkTimeCalculator {
+    std::size_t& n_calculated;
+
+public:
+    explicit CountingCalculator(std::size_t& n_calculated) :
+        n_calculated(n_calculated) {
+    }
+
+    std::chrono::seconds calculate_walking_time(double latitude_1, double longitude_1, double latitude_2,
+                                                double longitude_2) override {
+        ++n_calculated;
+        return std::chrono::minutes{std::lround(std::abs(longitude_2 - longitude_1) * 1000)};
+    }
+
+    std::chrono::seconds calculate_walking_time(double distance_km) override {
+        return std::chrono::seconds{0};
+    }
+};
+
+std::string cache_path() {
+    return (std::filesystem::temp_directory_path() / "pt_routing_footpath_cache_test.bin").string();
+}
+
+std::deque<Stop> create_stops(const double last_longitude) {
+    return {Stop("test", "stop1", 59.0, 18.000, "", {}), Stop("test", "stop2", 59.0, 18.002, "", {}),
+            Stop("test", "stop3", 59.0, last_longitude, "", {})};
+}
+
+/**
+ * Builds the transfers of the given stops using the cache.
+ * @return Number of pairs calculated without the cache.
+ */
+std::size_t build_transfers(std::deque<Stop>&& stops, FootpathCache& cache) {
+    const auto manager = StopManager(std::move(stops), {}, {});
+    auto n_calculated = std::size_t{0};
+    const auto tm = TransferManager{
+        manager.get_stops(), StopKDTree::create_factory(),
+        std::make_unique<CachedWalkTimeCalculator>(std::make_unique<CountingCalculator>(n_calculated), cache)
+    };
+    for (const auto& stop : manager.get_stops()) {
+        EXPECT_EQ(tm.get_transfers_from_stop(stop).size(), 2);
+    }
+    return n_calculated;
+}
+
+TEST(FootpathCache, SavedWalkingTimesAreReused) {
+    auto cache = FootpathCache("test");
+    EXPECT_EQ(build_transfers(create_stops(18.004), cache), 6);
+    cache.save(cache_path());
+
+    auto loaded_cache = FootpathCache::load(cache_path(), "test");
+    EXPECT_EQ(build_transfers(create_stops(18.004), loaded_cache), 0);
+    EXPECT_EQ(loaded_cache.size(), 6);
+    std::filesystem::remove(cache_path());
+}
+
+TEST(FootpathCache, MovedStopsAreRecalculated) {
+    auto cache = FootpathCache("test");
+    build_transfers(create_stops(18.004), cache);
+    cache.save(cache_path());
+
+    auto loaded_cache = FootpathCache::load(cache_path(), "test");
+    // Only the pairs including the moved stop are calculated again
+    EXPECT_EQ(build_transfers(create_stops(18.005), loaded_cache), 4);
+    const auto walking_time = loaded_cache.find(59.0, 18.005, 59.0, 18.000);
+    ASSERT_TRUE(walking_time.has_value());
+    EXPECT_EQ(*walking_time, std::chrono::minutes{5});
+    // Pairs of the old location are not saved again
+    EXPECT_EQ(loaded_cache.size(), 6);
+    loaded_cache.save(cache_path());
+    EXPECT_FALSE(FootpathCache::load(cache_path(), "test").find(59.0, 18.004, 59.0, 18.000).has_value());
+    std::filesystem::remove(cache_path());
+}
+
+TEST(FootpathCache, CacheOfOtherCalculatorIsNotLoaded) {
+    auto cache = FootpathCache("test");
+    cache.insert(59.0, 18.0, 59.0, 18.1, std::chrono::minutes{1});
+    cache.save(cache_path());
+
+    EXPECT_EQ(FootpathCache::load(cache_path(), "other").size(), 0);
+    EXPECT_FALSE(FootpathCache::load(cache_path(), "other").find(59.0, 18.0, 59.0, 18.1).has_value());
+    EXPECT_TRUE(FootpathCache::load(cache_path(), "test").find(59.0, 18.0, 59.0, 18.1).has_value());
+    std::filesystem::remove(cache_path());
+}
+
+TEST(FootpathCache, EntriesAreIdentifiedByAllCoordinates) {
+    auto cache = FootpathCache("test");
+    cache.insert(59.0, 18.0, 59.0, 18.1, std::chrono::minutes{1});
+    cache.insert(59.0, 18.1, 59.0, 18.0, std::chrono::minutes{2});
+    cache.save(cache_path());
+
+    auto loaded_cache = FootpathCache::load(cache_path(), "test");
+    EXPECT_EQ(loaded_cache.find(59.0, 18.0, 59.0, 18.1), std::chrono::minutes{1});
+    EXPECT_EQ(loaded_cache.find(59.0, 18.1, 59.0, 18.0), std::chrono::minutes{2});
+    EXPECT_FALSE(loaded_cache.find(18.0, 59.0, 18.1, 59.0).has_value());
+    std::filesystem::remove(cache_path());
+}
+
+TEST(FootpathCache, CorruptCacheIsRejected) {
+    auto cache = FootpathCache("test");
+    cache.insert(59.0, 18.0, 59.0, 18.1, std::chrono::minutes{1});
+    cache.save(cache_path());
+    const auto file_size = std::filesystem::file_size(cache_path());
+
+    // Truncated in the middle of the entry
+    std::filesystem::resize_file(cache_path(), file_size - 1);
+    EXPECT_THROW(FootpathCache::load(cache_path(), "test"), std::runtime_error);
+
+    // The length of the calculator key is larger than the file
+    {
+        auto output = std::fstream(cache_path(), std::ios::binary | std::ios::in | std::ios::out);
+        output.seekp(8);
+        const auto key_size = std::numeric_limits<std::uint64_t>::max();
+        output.write(reinterpret_cast<const char*>(&key_size), sizeof(key_size));
+    }
+    EXPECT_THROW(FootpathCache::load(cache_path(), "test"), std::runtime_error);
+    std::filesystem::remove(cache_path());
+}
@@ -56,3 +56,63 @@ TEST(KDTree, CalculateAllDistancePairs) {
         ASSERT_EQ(stop.nearby_stops.size(), all_nearby_stops.size() - 1);
     }
 }
+
+TEST(KDTree, StopPairsAreReturnedOnce) {
+    auto stops = std::deque{stop1, stop2, stop3};
+    auto kd_tree = StopKDTree{stops};
+    auto pairs = kd_tree.stop_pairs_in_radius(1.3);
+    ASSERT_TRUE(pairs.has_value());
+    // Only stop1 - stop2 and stop2 - stop3 are close enough
+    ASSERT_EQ(pairs->size(), 2);
+    for (const auto& [first, second, distance_km] : *pairs) {
+        EXPECT_LT(first, second);
+        EXPECT_LT(distance_km, 1.3);
+    }
+}
+
+TEST(KDTree, StopPairsMatchSingleSearches) {
+    auto stops = std::deque{stop1, stop2, stop3};
+    auto kd_tree = StopKDTree{stops};
+    auto pairs = kd_tree.stop_pairs_in_radius(99);
+    ASSERT_TRUE(pairs.has_value());
+    ASSERT_EQ(pairs->size(), 3);
+    for (const auto& [first, second, distance_km] : *pairs) {
+        auto nearby_stops = kd_tree.stops_in_radius(stops[first], 99);
+        auto match = std::ranges::find_if(nearby_stops, [&](const StopWithDistance& nearby_stop) {
+            return nearby_stop.stop == stops[second];
+        });
+        ASSERT_NE(match, nearby_stops.end());
+        EXPECT_DOUBLE_EQ(match->distance_km, distance_km);
+    }
+}
+
+TEST(KDTree, NearestStopsAreSortedByDistance) {
+    auto stops = std::deque{stop3, stop1, stop2};
+    auto kd_tree = StopKDTree{stops};
+    auto results = std::array<StopSearchResult, 2>{};
+    const auto [latitude, longitude] = stop1.get_coordinates();
+    ASSERT_EQ(kd_tree.nearest_stops(latitude, longitude, results), 2);
+    EXPECT_EQ(stops[results[0].stop_index], stop1);
+    EXPECT_EQ(stops[results[1].stop_index], stop2);
+    EXPECT_NEAR(results[1].distance_km, 0.882, 0.01);
+}
+
+TEST(KDTree, NearestStopsFillsOnlyFoundStops) {
+    auto stops = std::deque{stop1, stop2};
+    auto kd_tree = StopKDTree{stops};
+    auto results = std::array<StopSearchResult, 5>{};
+    const auto [latitude, longitude] = stop1.get_coordinates();
+    EXPECT_EQ(kd_tree.nearest_stops(latitude, longitude, results), 2);
+}
+
+TEST(KDTree, NearestStopsInRadiusUsesRadius) {
+    auto stops = std::deque{stop1, stop2, stop3};
+    auto kd_tree = StopKDTree{stops};
+    auto results = std::array<StopSearchResult, 10>{};
+    const auto [latitude, longitude] = stop1.get_coordinates();
+    ASSERT_EQ(kd_tree.nearest_stops_in_radius(latitude, longitude, 1.3, results), 2);
+    EXPECT_EQ(stops[results[1].stop_index], stop2);
+    // The number of results is capped by the buffer size
+    EXPECT_EQ(kd_tree.nearest_stops_in_radius(latitude, longitude, 99, std::span{results}.first(1)), 1);
+    EXPECT_EQ(stops[results[0].stop_index], stop1);
+}
@@ -52,3 +52,33 @@ TEST(LinearWalkTimeCalculator, ScalingFactorMustBePositive) {
     walking_speed_kmh = -5.0;
     EXPECT_THROW(LinearWalkTimeCalculator(walking_speed_kmh, scaling_factor), std::invalid_argument);
 }
+
+TEST(LinearWalkTimeCalculator, BatchDistancesMatchSingle) {
+    auto calculator = LinearWalkTimeCalculator{5.0, 1.3};
+    const auto distances = std::vector{0.0, 0.1234, 1.0, 5.0, 9.87};
+    auto walking_times = std::vector<std::chrono::seconds>(distances.size());
+    calculator.calculate_walking_times(distances, walking_times);
+    for (std::size_t i = 0; i < distances.size(); ++i) {
+        EXPECT_EQ(walking_times[i], calculator.calculate_walking_time(distances[i]));
+    }
+}
+
+TEST(LinearWalkTimeCalculator, BatchCoordinatesWithinOneSecond) {
+    auto calculator = LinearWalkTimeCalculator{5.0};
+    const auto latitudes = std::vector{point_1.first, point_2.first, 59.16, 59.2, 59.1};
+    const auto longitudes = std::vector{point_1.second, point_2.second, 18.39, 18.4, 18.3};
+    auto walking_times = std::vector<std::chrono::seconds>(latitudes.size());
+    calculator.calculate_walking_times(point_1.first, point_1.second, latitudes, longitudes, walking_times);
+    for (std::size_t i = 0; i < latitudes.size(); ++i) {
+        const auto expected = calculator.calculate_walking_time(point_1.first, point_1.second, latitudes[i],
+                                                                longitudes[i]);
+        EXPECT_NEAR(walking_times[i].count(), expected.count(), 1);
+    }
+}
+
+TEST(LinearWalkTimeCalculator, BatchSizesMustMatch) {
+    auto calculator = LinearWalkTimeCalculator{5.0};
+    const auto distances = std::vector{1.0, 2.0};
+    auto walking_times = std::vector<std::chrono::seconds>(1);
+    EXPECT_THROW(calculator.calculate_walking_times(distances, walking_times), std::invalid_argument);
+}
@@ -0,0 +1,107 @@
+/**
+ * Tests for the grid-based NearbyStopsFinder.
+ */
+#include <random>
+
+#include <gtest/gtest.h>
+
+#include <transfers/kd_tree.h>
+#include <transfers/stop_grid.h>
+
+using namespace raptor;
+
+namespace {
+    auto stop1 = Stop{"stop1", "stop1", 59.15225526334754, 18.246309647687365, "", {}};
+    // Stop1 - Stop2 real-world distance 882m
+    auto stop2 = Stop{"stop2", "stop2", 59.15627986037491, 18.259634253669688, "", {}};
+    // Stop1 - Stop3 real-world distance 1.5km
+    auto stop3 = Stop{"stop3", "stop3", 59.15969531957956, 18.268264633334773, "", {}};
+
+    /**
+     * Creates stops spread randomly over an area of about 10 by 10 kilometres.
+     */
+    std::deque<Stop> create_random_stops(const std::size_t n_stops) {
+        auto generator = std::mt19937{42};
+        auto latitude = std::uniform_real_distribution{59.30, 59.39};
+        auto longitude = std::uniform_real_distribution{18.00, 18.18};
+        auto stops = std::deque<Stop>{};
+        for (std::size_t i = 0; i < n_stops; ++i) {
+            const auto id = "stop" + std::to_string(i);
+            stops.push_back(Stop(id, id, latitude(generator), longitude(generator), "", {}));
+        }
+        return stops;
+    }
+}
+
+TEST(StopGrid, CannotCreateWithRValueStops) {
+    constexpr auto can_construct = std::is_constructible_v<StopGrid, std::deque<Stop>&&, double>;
+    EXPECT_FALSE(can_construct);
+}
+
+TEST(StopGrid, ThrowsOnInvalidCellSize) {
+    const auto stops = std::deque{stop1};
+    EXPECT_THROW(StopGrid(stops, 0), std::invalid_argument);
+}
+
+TEST(StopGrid, CalculatesExactDistances) {
+    const auto stops = std::deque{stop1, stop2, stop3};
+    auto grid = StopGrid{stops, 0.5};
+    const auto nearby_stops = grid.stops_in_radius(stop1.get_coordinates().first, stop1.get_coordinates().second,
+                                                   1.0);
+    ASSERT_EQ(nearby_stops.size(), 2);
+    for (const auto& [stop, distance_km] : nearby_stops) {
+        if (stop == stop1) {
+            EXPECT_DOUBLE_EQ(distance_km, 0);
+        } else {
+            EXPECT_EQ(stop, stop2);
+            EXPECT_NEAR(distance_km, 0.882, 0.002);
+        }
+    }
+}
+
+TEST(StopGrid, SearchesBeyondNeighbouringCells) {
+    const auto stops = std::deque{stop1, stop2, stop3};
+    auto grid = StopGrid{stops, 0.1};
+    EXPECT_EQ(grid.stops_in_radius(stop1.get_coordinates().first, stop1.get_coordinates().second, 2.0).size(), 3);
+}
+
+TEST(StopGrid, StopPairsMatchKDTree) {
+    const auto stops = create_random_stops(500);
+    const auto radius_km = 0.8;
+    const auto grid = StopGrid{stops, radius_km};
+    const auto kd_tree = StopKDTree{stops};
+    auto grid_pairs = *grid.stop_pairs_in_radius(radius_km);
+    auto tree_pairs = *kd_tree.stop_pairs_in_radius(radius_km);
+
+    const auto by_stops = [](const StopPairWithDistance& pair) {
+        return std::pair{pair.first, pair.second};
+    };
+    std::ranges::sort(grid_pairs, {}, by_stops);
+    std::ranges::sort(tree_pairs, {}, by_stops);
+    // The tree uses straight-line distances, so pairs right at the radius can differ
+    auto n_matching = std::size_t{0};
+    for (const auto& pair : grid_pairs) {
+        EXPECT_LT(pair.first, pair.second);
+        EXPECT_LE(pair.distance_km, radius_km);
+        const auto match = std::ranges::lower_bound(tree_pairs, by_stops(pair), {}, by_stops);
+        if (match != tree_pairs.end() && by_stops(*match) == by_stops(pair)) {
+            EXPECT_NEAR(match->distance_km, pair.distance_km, 0.001);
+            ++n_matching;
+        }
+    }
+    EXPECT_GT(grid_pairs.size(), 0);
+    EXPECT_GE(n_matching + 2, std::max(grid_pairs.size(), tree_pairs.size()));
+}
+
+TEST(StopGrid, StopPairsMatchSingleSearches) {
+    const auto stops = create_random_stops(200);
+    auto grid = StopGrid{stops, 0.5};
+    const auto pairs = *grid.stop_pairs_in_radius(1.0);
+    auto n_pairs = std::size_t{0};
+    for (const auto& stop : stops) {
+        const auto [latitude, longitude] = stop.get_coordinates();
+        // Includes the stop itself, which is not a pair
+        n_pairs += grid.stops_in_radius(latitude, longitude, 1.0).size() - 1;
+    }
+    EXPECT_EQ(pairs.size() * 2, n_pairs);
+}
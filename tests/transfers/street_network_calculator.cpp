@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+
+#include <transfers/kd_tree.h>
+#include <transfers/street_network_calculator.h>
+
+using namespace raptor;
+
+/**
+ * Nodes 1, 2 and 3 form an L-shaped footway of about 226m. Nodes 4 and 5 form a path which is not connected to it.
+ * The other ways cannot be walked, so nodes 6 and 7 are dropped.
+ */
+constexpr auto network_extract = R"(n1 v1 dV c0 t2025-01-01T00:00:00Z i0 u T x18.000 y59.000
+n2 v1 dV c0 t2025-01-01T00:00:00Z i0 u T x18.000 y59.001
+n6 v1 dV c0 t2025-01-01T00:00:00Z i0 u T x18.001 y59.0005
+n3 v1 dV c0 t2025-01-01T00:00:00Z i0 u T x18.002 y59.001
+n4 v1 dV c0 t2025-01-01T00:00:00Z i0 u T x18.002 y59.000
+n5 v1 dV c0 t2025-01-01T00:00:00Z i0 u T x18.004 y59.000
+n7 v1 dV c0 t2025-01-01T00:00:00Z i0 u T x18.003 y59.002
+w1 v1 dV c0 t2025-01-01T00:00:00Z i0 u Thighway=footway,name=Main%20%street Nn1,n2,n3
+w2 v1 dV c0 t2025-01-01T00:00:00Z i0 u Thighway=path Nn4,n5
+w3 v1 dV c0 t2025-01-01T00:00:00Z i0 u Thighway=motorway Nn1,n6,n3
+w4 v1 dV c0 t2025-01-01T00:00:00Z i0 u Thighway=footway,foot=n%6f% Nn3,n7
+w5 v1 dV c0 t2025-01-01T00:00:00Z i0 u Tbuilding=yes Nn1,n2,n4,n1
+r1 v1 dV c0 t2025-01-01T00:00:00Z i0 u Tamenity=parking Mw5@
+)";
+
+StreetNetwork read_network() {
+    auto input = std::istringstream(network_extract);
+    return StreetNetwork::read(input);
+}
+
+TEST(StreetNetwork, ReadsNodesAndWays) {
+    const auto network = read_network();
+    ASSERT_EQ(network.nodes.size(), 5);
+    EXPECT_DOUBLE_EQ(network.nodes[2].latitude, 59.001);
+    EXPECT_DOUBLE_EQ(network.nodes[2].longitude, 18.002);
+    ASSERT_EQ(network.segments.size(), 3);
+    EXPECT_EQ(network.segments[1].from, 1);
+    EXPECT_EQ(network.segments[1].to, 2);
+    EXPECT_EQ(network.segments[2].from, 3);
+    EXPECT_EQ(network.segments[2].to, 4);
+}
+
+TEST(StreetNetwork, SkipsWaysWhichCannotBeWalked) {
+    auto input = std::istringstream("n1 x18.0 y59.0\nn2 x18.1 y59.0\nn3 x18.2 y59.0\n"
+                                    "w1 Thighway=trunk Nn1,n2\nw2 Thighway=trunk,foot=yes Nn2,n3\n"
+                                    "w3 Thighway=service,access=private Nn1,n3\nw4 Thighway=motorway Nn1,n4\n");
+    const auto network = StreetNetwork::read(input);
+    ASSERT_EQ(network.nodes.size(), 2);
+    EXPECT_DOUBLE_EQ(network.nodes[0].longitude, 18.1);
+    ASSERT_EQ(network.segments.size(), 1);
+}
+
+TEST(StreetNetwork, ThrowsOnUnknownNode) {
+    auto input = std::istringstream("n1 x18.0 y59.0\nw1 Thighway=footway Nn1,n2\n");
+    EXPECT_THROW(StreetNetwork::read(input), std::runtime_error);
+}
+
+TEST(StreetNetwork, ThrowsOnInvalidLine) {
+    auto input = std::istringstream("n1 x18.0 yabc\n");
+    EXPECT_THROW(StreetNetwork::read(input), std::runtime_error);
+    input = std::istringstream("n1 x18.0 y59.0\nw1 Thighway=footway,foot=%6e Nn1\n");
+    EXPECT_THROW(StreetNetwork::read(input), std::runtime_error);
+}
+
+TEST(StreetNetworkWalkTimeCalculator, WalksAlongNetwork) {
+    // Walk at 1 m/s, so that times are equal to distances
+    auto calculator = StreetNetworkWalkTimeCalculator(read_network(), 3.6);
+    const auto walking_time = calculator.calculate_walking_time(59.000, 18.000, 59.001, 18.002);
+    EXPECT_GE(walking_time.count(), 224);
+    EXPECT_LE(walking_time.count(), 228);
+    // The straight line is shorter than the path
+    EXPECT_LT(calculator.calculate_walking_time(0.161).count(), walking_time.count());
+}
+
+TEST(StreetNetworkWalkTimeCalculator, DisconnectedPointsAreUnreachable) {
+    auto calculator = StreetNetworkWalkTimeCalculator(read_network(), 3.6);
+    EXPECT_EQ(calculator.calculate_walking_time(59.000, 18.000, 59.000, 18.002), WalkTimeCalculator::unreachable);
+    // Too far from any node
+    EXPECT_EQ(calculator.calculate_walking_time(59.000, 18.000, 60.000, 18.000), WalkTimeCalculator::unreachable);
+}
+
+TEST(StreetNetworkWalkTimeCalculator, UsesMaximumWalkingDistance) {
+    auto calculator = StreetNetworkWalkTimeCalculator(read_network(), 3.6, 0.2);
+    EXPECT_NE(calculator.calculate_walking_time(59.000, 18.000, 59.001, 18.000), WalkTimeCalculator::unreachable);
+    EXPECT_EQ(calculator.calculate_walking_time(59.000, 18.000, 59.001, 18.002), WalkTimeCalculator::unreachable);
+}
+
+TEST(StreetNetworkWalkTimeCalculator, QueriesMatchSingleCalculations) {
+    const auto network = read_network();
+    auto calculator = StreetNetworkWalkTimeCalculator(network, 5.0);
+    auto latitudes = std::vector<double>{};
+    auto longitudes = std::vector<double>{};
+    for (const auto& [latitude, longitude] : network.nodes) {
+        latitudes.push_back(latitude);
+        longitudes.push_back(longitude);
+    }
+
+    const auto n_nodes = network.nodes.size();
+    auto walking_times = std::vector<std::chrono::seconds>(n_nodes * n_nodes);
+    auto queries = std::vector<WalkingTimeQuery>{};
+    for (std::size_t i = 0; i < n_nodes; ++i) {
+        queries.push_back({latitudes[i], longitudes[i], latitudes, longitudes,
+                           std::span{walking_times}.subspan(i * n_nodes, n_nodes)});
+    }
+    calculator.calculate_walking_times(queries);
+
+    for (std::size_t i = 0; i < n_nodes; ++i) {
+        for (std::size_t j = 0; j < n_nodes; ++j) {
+            EXPECT_EQ(walking_times[i * n_nodes + j],
+                      calculator.calculate_walking_time(latitudes[i], longitudes[i], latitudes[j], longitudes[j]))
+                    << i << " " << j;
+        }
+    }
+}
+
+TEST(StreetNetworkWalkTimeCalculator, UnreachableStopsHaveNoTransfers) {
+    using namespace std::chrono_literals;
+    auto manager = StopManager({Stop("test", "stop1", 59.000, 18.000, "", {}),
+                                Stop("test", "stop3", 59.001, 18.002, "", {}),
+                                Stop("test", "stop4", 59.000, 18.002, "", {})}, {}, {});
+    const auto& stops = manager.get_stops();
+    auto tm = TransferManager{stops, StopKDTree::create_factory(),
+                              std::make_unique<StreetNetworkWalkTimeCalculator>(read_network(), 3.6),
+                              {.max_radius_km = 1.0, .exit_station_duration = 0s}};
+
+    for (const auto& stop : stops) {
+        const auto transfers = tm.get_transfers_from_stop(stop);
+        if (stop.get_gtfs_id().view() == "stop4") {
+            EXPECT_TRUE(transfers.empty());
+        } else {
+            ASSERT_EQ(transfers.size(), 1);
+            EXPECT_GE(transfers[0].duration.count(), 224);
+        }
+    }
+}
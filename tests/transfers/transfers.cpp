@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 
+#include <transfers/kd_tree.h>
 #include <transfers/transfers.h>
 
 using namespace raptor;
@@ -23,20 +24,33 @@ public:
 
 auto nearby_stop = Stop("nearby stop 1", "nearby", 2.0, 4.0, "platform 1", {});
 
+/**
+ * Finds the stop with the same GTFS ID as the given stop in the given stops.
+ */
+const Stop& find_stop(const std::deque<Stop>& stops, const Stop& stop) {
+    return *std::ranges::find(stops, stop.get_gtfs_id(), &Stop::get_gtfs_id);
+}
+
 /**
  * Always returns one nearby stop 500m away.
  */
 class SingleNearbyStopFinder final : public NearbyStopsFinder {
+    const std::deque<Stop>& stops;
+
 public:
+    explicit SingleNearbyStopFinder(const std::deque<Stop>& stops) :
+        stops(stops) {
+    }
+
     std::vector<StopWithDistance> stops_in_radius(double latitude, double longitude, double radius_km) override {
         if (radius_km >= 0.5)
-            return {StopWithDistance{nearby_stop, 0.5}};
+            return {StopWithDistance{find_stop(stops, nearby_stop), 0.5}};
         return {};
     }
 
     static Factory create_factory() {
-        return [](const std::deque<Stop>&) {
-            return std::make_unique<SingleNearbyStopFinder>();
+        return [](const std::deque<Stop>& stops) {
+            return std::make_unique<SingleNearbyStopFinder>(stops);
         };
     }
 };
@@ -66,14 +80,44 @@ TEST(TransferManager, CannotConstructWithRValueStops) {
     EXPECT_FALSE(can_construct);
 }
 
+TEST(TransferManager, RequiresIndexedStops) {
+    // Stops which are not owned by a StopManager all have the same index
+    const auto stops = std::deque{Stop("test", "stop1", 1.1, 2.2, "", {}), Stop("test", "stop2", 1.1, 2.2, "", {})};
+    EXPECT_THROW(TransferManager(stops, NoNearbyStopsFinder::create_factory(), std::make_unique<FiveMinCalculator>()),
+                 std::invalid_argument);
+}
+
+TEST(TransferManager, FootpathsOfEachStopAreSeparate) {
+    using namespace std::literals;
+    auto stop1 = Stop("test", "stop1", 1.1, 2.2, "", {});
+    auto stop2 = Stop("test", "stop2", 1.1, 2.2, "", {});
+    auto stop3 = Stop("test", "stop3", 1.1, 2.2, "", {});
+    auto station1 = Station("station", "station1", {});
+    const auto stops_per_station = StopManager::StationToChildStopsMap{
+            {"station1"s, std::vector{"stop1"s, "stop2"s}}
+    };
+    auto manager = StopManager({stop1, stop2, stop3}, {station1}, stops_per_station);
+    const auto& stops = manager.get_stops();
+    auto tm = TransferManager{stops, NoNearbyStopsFinder::create_factory(), std::make_unique<FiveMinCalculator>()};
+
+    const auto from_stop1 = tm.get_transfers_from_stop(find_stop(stops, stop1));
+    ASSERT_EQ(from_stop1.size(), 1);
+    EXPECT_EQ(stops[from_stop1[0].target_stop_index], find_stop(stops, stop2));
+    const auto from_stop2 = tm.get_transfers_from_stop(find_stop(stops, stop2));
+    ASSERT_EQ(from_stop2.size(), 1);
+    EXPECT_EQ(stops[from_stop2[0].target_stop_index], find_stop(stops, stop1));
+    EXPECT_TRUE(tm.get_transfers_from_stop(find_stop(stops, stop3)).empty());
+}
+
 TEST(TransferManager, ExitDurationAddedOnce) {
     using namespace std::chrono_literals;
     const auto stops = std::deque{nearby_stop};
     auto tm = TransferManager{stops, SingleNearbyStopFinder::create_factory(),
                               std::make_unique<FiveMinCalculator>(),
                               {.exit_station_duration = 2min}};
-    const auto& transfers = tm.get_transfers_from_stop(nearby_stop);
-    EXPECT_EQ(transfers.at(0).second, 5min + 2min);
+    const auto transfers = tm.get_transfers_from_stop(stops.front());
+    ASSERT_EQ(transfers.size(), 1);
+    EXPECT_EQ(transfers[0].duration, 5min + 2min);
 }
 
 TEST(TransferManager, UsesRadiusParameter) {
@@ -82,7 +126,7 @@ TEST(TransferManager, UsesRadiusParameter) {
     auto tm = TransferManager{stops, SingleNearbyStopFinder::create_factory(),
                               std::make_unique<FiveMinCalculator>(),
                               {.max_radius_km = 0.2}};
-    const auto& transfers = tm.get_transfers_from_stop(nearby_stop);
+    const auto transfers = tm.get_transfers_from_stop(stops.front());
     EXPECT_TRUE(transfers.empty());
 }
 
@@ -99,9 +143,9 @@ TEST(TransferManager, ExitDurationIsNotAddedInSameStationTransfers) {
     auto tm = TransferManager{stops, NoNearbyStopsFinder::create_factory(),
         std::make_unique<FiveMinCalculator>(), {.in_station_transfer_duration = 60s}};
 
-    const auto& transfers = tm.get_transfers_from_stop(stop1);
-    EXPECT_EQ(transfers.size(), 1);
-    EXPECT_EQ(transfers.at(0).second, 60s);
+    const auto transfers = tm.get_transfers_from_stop(find_stop(stops, stop1));
+    ASSERT_EQ(transfers.size(), 1);
+    EXPECT_EQ(transfers[0].duration, 60s);
 }
 
 TEST(TransferManager, OnFootDoesNotOverrideSameStation) {
@@ -109,7 +153,7 @@ TEST(TransferManager, OnFootDoesNotOverrideSameStation) {
     auto stop1 = Stop("test", "stop1", 1.1, 2.2, "hello", {});
     auto station1 = Station("station", "station1", {});
     const auto stops_per_station = StopManager::StationToChildStopsMap{
-                {"station1"s, std::vector{"stop1"s, nearby_stop.get_gtfs_id()}}
+                {"station1"s, std::vector{"stop1"s, std::string(nearby_stop.get_gtfs_id())}}
     };
     auto manager = StopManager({stop1, nearby_stop}, {station1}, stops_per_station);
     auto& stops = manager.get_stops();
@@ -117,7 +161,154 @@ TEST(TransferManager, OnFootDoesNotOverrideSameStation) {
     auto tm = TransferManager{stops, SingleNearbyStopFinder::create_factory(),
         std::make_unique<FiveMinCalculator>(), {.in_station_transfer_duration = 60s}};
 
-    const auto& transfers = tm.get_transfers_from_stop(stop1);
-    EXPECT_EQ(transfers.size(), 1);
-    EXPECT_EQ(transfers.at(0).second, 60s);
+    const auto transfers = tm.get_transfers_from_stop(find_stop(stops, stop1));
+    ASSERT_EQ(transfers.size(), 1);
+    EXPECT_EQ(transfers[0].duration, 60s);
+}
+
+TEST(TransferManager, BulkSearchCreatesSymmetricFootpaths) {
+    using namespace std::literals;
+    auto stop1 = Stop("test", "stop1", 59.1522, 18.2463, "", {});
+    auto stop2 = Stop("test", "stop2", 59.1562, 18.2596, "", {});
+    auto manager = StopManager({stop1, stop2}, {}, {});
+    const auto& stops = manager.get_stops();
+    auto tm = TransferManager{stops, StopKDTree::create_factory(), std::make_unique<FiveMinCalculator>(),
+                              {.max_radius_km = 2.0, .exit_station_duration = 2min}};
+
+    for (const auto& stop : stops) {
+        const auto transfers = tm.get_transfers_from_stop(stop);
+        ASSERT_EQ(transfers.size(), 1);
+        EXPECT_NE(stops[transfers[0].target_stop_index], stop);
+        EXPECT_EQ(transfers[0].duration, 5min + 2min);
+    }
+}
+
+TEST(TransferManager, GivenTransfersTakePrecedence) {
+    using namespace std::literals;
+    auto stop1 = Stop("test", "stop1", 1.1, 2.2, "", {});
+    auto stop2 = Stop("test", "stop2", 1.1, 2.2, "", {});
+    auto station1 = Station("station", "station1", {});
+    const auto stops_per_station = StopManager::StationToChildStopsMap{
+            {"station1"s, std::vector{"stop1"s, "stop2"s}}
+    };
+    auto manager = StopManager({stop1, stop2}, {station1}, stops_per_station);
+    const auto& stops = manager.get_stops();
+    const auto& from = find_stop(stops, stop1);
+    const auto& to = find_stop(stops, stop2);
+    const auto given_transfers = std::vector{
+            StopTransfer{from, to, StopTransfer::Type::MinimumTime, 3min},
+            StopTransfer{from, to, StopTransfer::Type::Timed}
+    };
+    auto tm = TransferManager{stops, NoNearbyStopsFinder::create_factory(), std::make_unique<FiveMinCalculator>(),
+                              {.in_station_transfer_duration = 60s}, given_transfers};
+
+    const auto from_stop1 = tm.get_transfers_from_stop(from);
+    ASSERT_EQ(from_stop1.size(), 1);
+    EXPECT_EQ(from_stop1[0].duration, 3min);
+    // The given transfer is only for one direction
+    const auto from_stop2 = tm.get_transfers_from_stop(to);
+    ASSERT_EQ(from_stop2.size(), 1);
+    EXPECT_EQ(from_stop2[0].duration, 60s);
+}
+
+TEST(TransferManager, NotPossibleTransfersAreNotCalculated) {
+    using namespace std::literals;
+    auto stop1 = Stop("test", "stop1", 59.1522, 18.2463, "", {});
+    auto stop2 = Stop("test", "stop2", 59.1562, 18.2596, "", {});
+    auto manager = StopManager({stop1, stop2}, {}, {});
+    const auto& stops = manager.get_stops();
+    const auto& from = find_stop(stops, stop1);
+    const auto& to = find_stop(stops, stop2);
+    const auto given_transfers = std::vector{StopTransfer{from, to, StopTransfer::Type::NotPossible}};
+    auto tm = TransferManager{stops, StopKDTree::create_factory(), std::make_unique<FiveMinCalculator>(),
+                              {.max_radius_km = 2.0}, given_transfers};
+
+    EXPECT_TRUE(tm.get_transfers_from_stop(from).empty());
+    EXPECT_EQ(tm.get_transfers_from_stop(to).size(), 1);
+}
+
+/**
+ * Takes five minutes to walk up to 1km and 30 minutes to walk further.
+ */
+class StepCalculator final : public WalkTimeCalculator {
+public:
+    std::chrono::seconds calculate_walking_time(double latitude_1, double longitude_1, double latitude_2,
+                                                double longitude_2) override {
+        return std::chrono::minutes{5};
+    }
+
+    std::chrono::seconds calculate_walking_time(const double distance_km) override {
+        return distance_km <= 1.0 ? std::chrono::minutes{5} : std::chrono::minutes{30};
+    }
+};
+
+/**
+ * Creates three stops in a line, with about 750m between consecutive stops.
+ */
+StopManager create_stops_in_line() {
+    return StopManager({Stop("test", "stop1", 59.0, 18.000, "", {}), Stop("test", "stop2", 59.0, 18.013, "", {}),
+                        Stop("test", "stop3", 59.0, 18.026, "", {})}, {}, {});
+}
+
+TEST(TransferManager, ClosureAddsChainedFootpaths) {
+    using namespace std::chrono_literals;
+    const auto manager = create_stops_in_line();
+    const auto& stops = manager.get_stops();
+    auto tm = TransferManager{stops, StopKDTree::create_factory(), std::make_unique<StepCalculator>(),
+                              {.max_radius_km = 1.0, .exit_station_duration = 2min, .max_closure_duration = 1h}};
+
+    const auto& first = find_stop(stops, Stop("test", "stop1", 0, 0, "", {}));
+    const auto& last = find_stop(stops, Stop("test", "stop3", 0, 0, "", {}));
+    const auto transfers = tm.get_transfers_from_stop(first);
+    ASSERT_EQ(transfers.size(), 2);
+    const auto to_last = std::ranges::find(transfers, last.get_index(), &Footpath::target_stop_index);
+    ASSERT_NE(to_last, transfers.end());
+    // The exit duration is added once for the whole chain, not for each footpath
+    EXPECT_EQ(to_last->duration, 2 * 5min + 2min);
+    const auto from_last = tm.get_transfers_from_stop(last);
+    const auto to_first = std::ranges::find(from_last, first.get_index(), &Footpath::target_stop_index);
+    ASSERT_NE(to_first, from_last.end());
+    EXPECT_EQ(to_first->duration, 2 * 5min + 2min);
+}
+
+TEST(TransferManager, ClosureReplacesDominatedFootpaths) {
+    using namespace std::chrono_literals;
+    const auto manager = create_stops_in_line();
+    const auto& stops = manager.get_stops();
+    // Walking directly between the first and the last stop takes longer than walking through the middle stop
+    auto tm = TransferManager{stops, StopKDTree::create_factory(), std::make_unique<StepCalculator>(),
+                              {.max_radius_km = 2.0, .exit_station_duration = 2min, .max_closure_duration = 20min}};
+
+    for (const auto& stop : stops) {
+        for (const auto& [target, duration] : tm.get_transfers_from_stop(stop)) {
+            EXPECT_LE(duration, 2 * 5min + 2min);
+        }
+    }
+}
+
+TEST(TransferManager, ClosureDoesNotCreateImpossibleTransfers) {
+    using namespace std::chrono_literals;
+    const auto manager = create_stops_in_line();
+    const auto& stops = manager.get_stops();
+    const auto& first = find_stop(stops, Stop("test", "stop1", 0, 0, "", {}));
+    const auto& last = find_stop(stops, Stop("test", "stop3", 0, 0, "", {}));
+    const auto given_transfers = std::vector{StopTransfer{first, last, StopTransfer::Type::NotPossible}};
+    auto tm = TransferManager{stops, StopKDTree::create_factory(), std::make_unique<StepCalculator>(),
+                              {.max_radius_km = 1.0, .max_closure_duration = 1h}, given_transfers};
+
+    const auto transfers = tm.get_transfers_from_stop(first);
+    EXPECT_EQ(std::ranges::find(transfers, last.get_index(), &Footpath::target_stop_index), transfers.end());
+    EXPECT_EQ(tm.get_transfers_from_stop(last).size(), 2);
+}
+
+TEST(TransferManager, FingerprintDependsOnFootpaths) {
+    using namespace std::chrono_literals;
+    const auto manager = create_stops_in_line();
+    const auto& stops = manager.get_stops();
+    auto create = [&stops](const std::chrono::seconds exit_station_duration) {
+        return TransferManager{stops, StopKDTree::create_factory(), std::make_unique<StepCalculator>(),
+                               {.max_radius_km = 1.0, .exit_station_duration = exit_station_duration}};
+    };
+    EXPECT_EQ(create(2min).fingerprint(), create(2min).fingerprint());
+    EXPECT_NE(create(2min).fingerprint(), create(3min).fingerprint());
 }
@@ -0,0 +1,41 @@
+#ifndef PT_ROUTING_COMMAND_LINE_H
+#define PT_ROUTING_COMMAND_LINE_H
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+
+#include "schedule/gtfs.h"
+
+/**
+ * Parses a date in the YYYY-MM-DD format.
+ * @throw std::invalid_argument If the date is not valid.
+ */
+inline std::chrono::year_month_day parse_date(const std::string& date) {
+    auto year = 0;
+    auto month = 0U;
+    auto day = 0U;
+    if (std::sscanf(date.c_str(), "%d-%u-%u", &year, &month, &day) != 3) {
+        throw std::invalid_argument("Invalid date " + date);
+    }
+    auto parsed = std::chrono::year_month_day{std::chrono::year{year}, std::chrono::month{month},
+                                              std::chrono::day{day}};
+    if (!parsed.ok()) {
+        throw std::invalid_argument("Invalid date " + date);
+    }
+    return parsed;
+}
+
+/**
+ * Parses a feed given as <feed directory>[:<prefix>]. The prefix is added to the IDs of the feed, so that several
+ * feeds can be merged into one schedule. The directory ends at the last colon.
+ */
+inline raptor::gtfs::FeedSource parse_feed_source(const std::string& argument) {
+    const auto separator = argument.rfind(':');
+    if (separator == std::string::npos) {
+        return {argument, ""};
+    }
+    return {argument.substr(0, separator), argument.substr(separator + 1)};
+}
+
+#endif //PT_ROUTING_COMMAND_LINE_H
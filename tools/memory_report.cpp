@@ -0,0 +1,36 @@
+/**
+ * Prints a breakdown of the memory used by the schedule and the routing indexes built for a GTFS feed.
+ *
+ * Usage: pt_memory_report <feed directory> [from date] [to date]
+ * Dates are given in the YYYY-MM-DD format.
+ */
+#include <iostream>
+
+#include "command_line.h"
+#include "raptor/raptor.h"
+#include "schedule/gtfs.h"
+#include "transfers/kd_tree.h"
+#include "transfers/linear_walk_calculator.h"
+
+int main(int argc, char* argv[]) {
+    if (argc < 2 || argc > 4) {
+        std::cerr << "Usage: " << argv[0] << " <feed directory> [from date] [to date]\n";
+        return 1;
+    }
+    try {
+        auto from_date = argc > 2 ? std::optional{parse_date(argv[2])} : std::nullopt;
+        auto to_date = argc > 3 ? std::optional{parse_date(argv[3])} : std::nullopt;
+
+        const auto schedule = raptor::gtfs::from_gtfs(std::vector<raptor::gtfs::FeedSource>{{argv[1], ""}},
+                                                      from_date, to_date);
+        auto transfer_manager = raptor::TransferManager(schedule, raptor::StopKDTree::create_factory(),
+                                                        std::make_unique<raptor::LinearWalkTimeCalculator>(5.0));
+        const auto raptor = raptor::Raptor(schedule, std::move(transfer_manager));
+
+        std::cout << schedule.memory_usage() << raptor.memory_usage();
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+    return 0;
+}
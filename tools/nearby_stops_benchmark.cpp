@@ -0,0 +1,67 @@
+/**
+ * Compares the time taken by the nearby stops finders to find the stops around every stop of a GTFS feed.
+ *
+ * Usage: pt_nearby_stops_benchmark <feed directory> [radius km]
+ */
+#include <chrono>
+#include <iostream>
+
+#include "schedule/gtfs.h"
+#include "transfers/kd_tree.h"
+#include "transfers/stop_grid.h"
+
+/**
+ * Runs the given function and returns the time it took in milliseconds.
+ */
+template <typename F>
+double time_ms(F&& function) {
+    const auto start = std::chrono::steady_clock::now();
+    function();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * Times building the finder, a bulk search for all stop pairs and a search around each stop.
+ */
+void benchmark(const std::string& name, const raptor::NearbyStopsFinder::Factory& factory,
+               const std::deque<raptor::Stop>& stops, const double radius_km) {
+    auto finder = std::unique_ptr<raptor::NearbyStopsFinder>{};
+    const auto build_ms = time_ms([&] {
+        finder = factory(stops);
+    });
+    auto n_pairs = std::size_t{0};
+    const auto pairs_ms = time_ms([&] {
+        n_pairs = finder->stop_pairs_in_radius(radius_km).value_or(std::vector<raptor::StopPairWithDistance>{})
+                .size();
+    });
+    auto n_results = std::size_t{0};
+    const auto queries_ms = time_ms([&] {
+        for (const auto& stop : stops) {
+            const auto [latitude, longitude] = stop.get_coordinates();
+            n_results += finder->stops_in_radius(latitude, longitude, radius_km).size();
+        }
+    });
+    std::cout << name << ": build " << build_ms << " ms, all pairs " << pairs_ms << " ms (" << n_pairs
+            << " pairs), single searches " << queries_ms << " ms (" << n_results << " results), "
+            << finder->memory_usage().total_bytes() << " bytes\n";
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2 || argc > 3) {
+        std::cerr << "Usage: " << argv[0] << " <feed directory> [radius km]\n";
+        return 1;
+    }
+    try {
+        const auto radius_km = argc > 2 ? std::stod(argv[2]) : 1.0;
+        const auto schedule = raptor::gtfs::from_gtfs(std::vector<raptor::gtfs::FeedSource>{{argv[1], ""}});
+        const auto& stops = schedule.get_stops();
+        std::cout << stops.size() << " stops, radius " << radius_km << " km\n";
+
+        benchmark("KD tree", raptor::StopKDTree::create_factory(), stops, radius_km);
+        benchmark("Grid", raptor::StopGrid::create_factory(radius_km), stops, radius_km);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,97 @@
+/**
+ * Records a round-by-round trace of a journey search and converts traces to GeoJSON, to see how a search spread out.
+ *
+ * Usage:
+ *  pt_query_trace record <feed directory> <date> <origin stop ID> <destination stop ID> <HH:MM> <trace file>
+ *  pt_query_trace geojson <feed directory> <date> <trace file>
+ * The date is given in the YYYY-MM-DD format, and the departure time is in the time zone of the first agency. The
+ * feed is loaded for the date and the day after, and must be the same when converting a trace. The GeoJSON is written
+ * to the standard output. Recording requires the library to be built with the PT_ROUTING_QUERY_STATS option.
+ */
+#include <iomanip>
+#include <iostream>
+
+#include "command_line.h"
+#include "raptor/raptor.h"
+#include "schedule/gtfs.h"
+#include "transfers/kd_tree.h"
+#include "transfers/linear_walk_calculator.h"
+
+using namespace raptor;
+
+/**
+ * @throw std::invalid_argument If there is no stop with the given GTFS ID.
+ */
+const Stop& find_stop(const Schedule& schedule, const std::string& gtfs_id) {
+    const auto& stops = schedule.get_stops();
+    const auto stop = std::ranges::find(stops, std::string_view{gtfs_id}, [](const Stop& stop) {
+        return stop.get_gtfs_id().view();
+    });
+    if (stop == stops.end()) {
+        throw std::invalid_argument("Unknown stop " + gtfs_id);
+    }
+    return *stop;
+}
+
+/**
+ * Parses a time of day in the HH:MM format.
+ * @throw std::invalid_argument If the time is not valid.
+ */
+std::chrono::minutes parse_time_of_day(const std::string& time) {
+    auto hours = 0;
+    auto minutes = 0;
+    if (std::sscanf(time.c_str(), "%d:%d", &hours, &minutes) != 2 || hours < 0 || minutes < 0 || minutes >= 60) {
+        throw std::invalid_argument("Invalid time " + time);
+    }
+    return std::chrono::hours{hours} + std::chrono::minutes{minutes};
+}
+
+void record(const Schedule& schedule, const std::chrono::year_month_day date, const std::string& origin_id,
+            const std::string& destination_id, const std::string& time, const std::string& path) {
+    if (!QueryStats::enabled) {
+        throw std::runtime_error("Recording traces requires building with the PT_ROUTING_QUERY_STATS option");
+    }
+    const auto& origin = find_stop(schedule, origin_id);
+    const auto& destination = find_stop(schedule, destination_id);
+    const auto departure_time = Time{schedule.get_agencies().front().get_time_zone(),
+                                     std::chrono::local_days{date} + parse_time_of_day(time)};
+    auto router = Raptor(schedule, TransferManager(schedule, StopKDTree::create_factory(),
+                                                   std::make_unique<LinearWalkTimeCalculator>(5.0)));
+    auto trace = QueryTrace{};
+    const auto journey = router.route(origin, destination, departure_time, nullptr, &trace);
+    trace.write(path, schedule);
+
+    std::cout << (journey.empty() ? "No journey found" : std::to_string(journey.size()) + " movements") << '\n'
+            << std::setw(6) << "round" << std::setw(14) << "marked stops" << std::setw(10) << "routes"
+            << std::setw(10) << "labels" << '\n';
+    for (std::size_t round = 0; round < trace.rounds.size(); ++round) {
+        const auto& traced_round = trace.rounds[round];
+        std::cout << std::setw(6) << round << std::setw(14) << traced_round.marked_stops.size() << std::setw(10)
+                << traced_round.routes.size() << std::setw(10) << traced_round.labels.size() << '\n';
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const auto mode = argc > 1 ? std::string{argv[1]} : std::string{};
+    if (!(mode == "record" && argc == 8) && !(mode == "geojson" && argc == 5)) {
+        std::cerr << "Usage: " << argv[0]
+                << " record <feed directory> <date> <origin stop ID> <destination stop ID> <HH:MM> <trace file>\n"
+                << "       " << argv[0] << " geojson <feed directory> <date> <trace file>\n";
+        return 1;
+    }
+    try {
+        const auto date = parse_date(argv[3]);
+        const auto last_date = std::chrono::year_month_day{std::chrono::sys_days{date} + std::chrono::days{1}};
+        const auto schedule = raptor::gtfs::from_gtfs(std::vector<raptor::gtfs::FeedSource>{{argv[2], ""}}, date,
+                                                      last_date);
+        if (mode == "record") {
+            record(schedule, date, argv[4], argv[5], argv[6], argv[7]);
+        } else {
+            QueryTrace::read(argv[4], schedule).write_geojson(std::cout, schedule);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+    return 0;
+}
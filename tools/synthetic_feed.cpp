@@ -0,0 +1,75 @@
+/**
+ * Writes a synthetic GTFS feed, generated with the given parameters.
+ *
+ * Usage: pt_synthetic_feed <output directory> [parameter=value ...]
+ * Parameters: topology (grid or radial), routes, stops_per_route, spacing_km, grid_size, stops_per_station,
+ * headway_min, first_departure_min, last_departure_min, speed_km_h, start_date (YYYY-MM-DD), service_days, seed.
+ */
+#include <iostream>
+
+#include "command_line.h"
+#include "schedule/synthetic.h"
+
+/**
+ * Sets the parameter in an argument of the form parameter=value.
+ * @throw std::invalid_argument If the argument is not a known parameter or has an invalid value.
+ */
+void set_parameter(raptor::synthetic::NetworkParameters& parameters, const std::string& argument) {
+    const auto separator = argument.find('=');
+    if (separator == std::string::npos) {
+        throw std::invalid_argument("Expected parameter=value, got " + argument);
+    }
+    const auto name = argument.substr(0, separator);
+    const auto value = argument.substr(separator + 1);
+    if (name == "topology") {
+        if (value != "grid" && value != "radial") {
+            throw std::invalid_argument("Unknown topology " + value);
+        }
+        parameters.topology = value == "grid" ? raptor::synthetic::Topology::Grid
+                                              : raptor::synthetic::Topology::Radial;
+    } else if (name == "routes") {
+        parameters.n_routes = std::stoul(value);
+    } else if (name == "stops_per_route") {
+        parameters.stops_per_route = std::stoul(value);
+    } else if (name == "spacing_km") {
+        parameters.stop_spacing_km = std::stod(value);
+    } else if (name == "grid_size") {
+        parameters.grid_size = std::stoul(value);
+    } else if (name == "stops_per_station") {
+        parameters.stops_per_station = std::stoul(value);
+    } else if (name == "headway_min") {
+        parameters.headway = std::chrono::minutes{std::stol(value)};
+    } else if (name == "first_departure_min") {
+        parameters.first_departure = std::chrono::minutes{std::stol(value)};
+    } else if (name == "last_departure_min") {
+        parameters.last_departure = std::chrono::minutes{std::stol(value)};
+    } else if (name == "speed_km_h") {
+        parameters.speed_km_h = std::stod(value);
+    } else if (name == "start_date") {
+        parameters.start_date = parse_date(value);
+    } else if (name == "service_days") {
+        parameters.service_days = std::stoul(value);
+    } else if (name == "seed") {
+        parameters.seed = std::stoull(value);
+    } else {
+        throw std::invalid_argument("Unknown parameter " + name);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <output directory> [parameter=value ...]\n";
+        return 1;
+    }
+    try {
+        auto parameters = raptor::synthetic::NetworkParameters{};
+        for (auto i = 2; i < argc; ++i) {
+            set_parameter(parameters, argv[i]);
+        }
+        raptor::synthetic::write_feed(parameters, argv[1]);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+    return 0;
+}